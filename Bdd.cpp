@@ -0,0 +1,194 @@
+#include "Bdd.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+BddManager::BddManager(int variables): variableCount{variables}
+{
+    assert(variables >= 0 && variables <= 63);
+    nodes.push_back({variableCount, FALSE, FALSE});
+    nodes.push_back({variableCount, TRUE, TRUE});
+}
+
+
+BddManager::Ref BddManager::MakeNode(int var, Ref low, Ref high)
+{
+    if (low == high) return low; // redundant test
+    auto [iter, isNew] = unique.try_emplace(UniqueKey(var, low, high), Ref(nodes.size()));
+    if (isNew) nodes.push_back({var, low, high});
+    return iter->second;
+}
+
+
+BddManager::Ref BddManager::Apply(LogicGate::OpType T, Ref A, Ref B)
+{
+    if (LogicGate::IsUnary(T)) B = A;
+    if (A <= TRUE && B <= TRUE) { return (LogicGate::Eval(T, (A == TRUE), (B == TRUE))? TRUE : FALSE); }
+
+    // terminal shortcuts; everything else recurses on the top variable
+    switch(T) {
+        case LogicGate::EQ: return A;
+        case LogicGate::AND:
+            if (A == FALSE || B == FALSE) return FALSE;
+            if (A == TRUE || A == B) return B;
+            if (B == TRUE) return A;
+        break;
+        case LogicGate::OR:
+            if (A == TRUE || B == TRUE) return TRUE;
+            if (A == FALSE || A == B) return B;
+            if (B == FALSE) return A;
+        break;
+        case LogicGate::XOR:
+            if (A == B) return FALSE;
+            if (A == FALSE) return B;
+            if (B == FALSE) return A;
+        break;
+        default: break;
+    }
+    if (!LogicGate::IsUnary(T) && A > B) std::swap(A, B); // every binary op is commutative
+
+    const std::uint64_t key {ComputedKey(T, A, B)};
+    if (auto found = computed.find(key); found != computed.end()) return found->second;
+
+    // copying, since 'nodes' may reallocate while recursing
+    const Node nodeA {nodes[A]}, nodeB {nodes[B]};
+    const int var {std::min(nodeA.var, nodeB.var)};
+    const Ref A0 {(nodeA.var == var)? nodeA.low  : A}, B0 {(nodeB.var == var)? nodeB.low  : B};
+    const Ref A1 {(nodeA.var == var)? nodeA.high : A}, B1 {(nodeB.var == var)? nodeB.high : B};
+
+    const Ref low  {Apply(T, A0, B0)};
+    const Ref high {Apply(T, A1, B1)};
+    const Ref result {MakeNode(var, low, high)};
+    computed[key] = result;
+    return result;
+}
+
+
+std::vector<bool> BddManager::AnySatisfying(Ref F) const
+{
+    if (F == FALSE) return {};
+    std::vector<bool> assignment(variableCount, false);
+    while (F > TRUE) {
+        const Node& node {nodes[F]};
+        const bool takeHigh {node.low == FALSE};
+        assignment[node.var] = takeHigh;
+        F = (takeHigh? node.high : node.low);
+    }
+    return assignment;
+}
+
+
+std::uint64_t BddManager::SatisfyingCount(Ref F) const
+{
+    // counts over the variables at-and-below each node's own level
+    std::unordered_map<Ref, std::uint64_t> memo{};
+    auto count = [&](auto&& self, Ref R) -> std::uint64_t {
+        if (R == FALSE) return 0;
+        if (R == TRUE) return 1;
+        if (auto found = memo.find(R); found != memo.end()) return found->second;
+        const Node& node {nodes[R]};
+        const std::uint64_t low  {self(self, node.low)  << (nodes[node.low ].var - node.var - 1)};
+        const std::uint64_t high {self(self, node.high) << (nodes[node.high].var - node.var - 1)};
+        return memo[R] = low + high;
+    };
+    return count(count, F) << nodes[F].var;
+}
+
+
+std::vector<std::string> BddManager::Cubes(Ref F, std::size_t limit) const
+{
+    std::vector<std::string> cubes{};
+    std::string path(variableCount, '-'); // indexed by variable
+    auto walk = [&](auto&& self, Ref R) -> void {
+        if (R == FALSE || cubes.size() >= limit) return;
+        if (R == TRUE) { cubes.emplace_back(path.rbegin(), path.rend()); return; }
+        const Node& node {nodes[R]};
+        path[node.var] = '0'; self(self, node.low);
+        path[node.var] = '1'; self(self, node.high);
+        path[node.var] = '-';
+    };
+    walk(walk, F);
+    return cubes;
+}
+
+
+void BddManager::Collect(std::vector<Ref>& roots)
+{
+    std::vector<bool> isLive(nodes.size(), false);
+    isLive[FALSE] = isLive[TRUE] = true;
+    std::vector<Ref> stack{roots.begin(), roots.end()};
+    while (!stack.empty()) {
+        const Ref R {stack.back()}; stack.pop_back();
+        if (isLive[R]) continue;
+        isLive[R] = true;
+        stack.push_back(nodes[R].low); stack.push_back(nodes[R].high);
+    }
+
+    // children are always created before their parents, so one ascending pass can renumber everything
+    std::vector<Ref> remap(nodes.size(), FALSE);
+    std::vector<Node> kept{}; kept.reserve(nodes.size());
+    unique.clear(); computed.clear();
+    for (Ref R{0}; R < nodes.size(); ++R) {
+        if (!isLive[R]) continue;
+        Node node {nodes[R]};
+        if (R > TRUE) { node.low = remap[node.low]; node.high = remap[node.high]; }
+        remap[R] = Ref(kept.size());
+        kept.push_back(node);
+        if (R > TRUE) unique[UniqueKey(node.var, node.low, node.high)] = remap[R];
+    }
+    nodes.swap(kept);
+    for (Ref& R: roots) { R = remap[R]; }
+    return;
+}
+
+
+std::vector<BddManager::Ref> BuildOutputBdds(const Netlist& source, BddManager& manager, std::size_t collectThreshold)
+{
+    using Ref = BddManager::Ref;
+    if (int(source.inputs.size()) > manager.VariableCount()) return {};
+    Netlist netlist{source};
+    if (!netlist.IsLevelized()) netlist.Levelize();
+    if (netlist.HasLoops()) return {};
+
+    // remaining uses of each net; a net's BDD is released when this reaches zero
+    std::vector<int> uses(netlist.NetCount(), 0);
+    for (const Netlist::Gate& gate: netlist.gates) {
+        ++uses[gate.A];
+        if (!LogicGate::IsUnary(gate.type)) ++uses[gate.B];
+    }
+    for (Netlist::NetID N: netlist.outputs) { ++uses[N]; }
+
+    std::vector<Ref> function(netlist.NetCount(), BddManager::FALSE);
+    std::vector<bool> isHeld(netlist.NetCount(), false);
+    for (std::size_t I{0}; I < netlist.inputs.size(); ++I) {
+        function[netlist.inputs[I]] = manager.Var(int(I));
+        isHeld[netlist.inputs[I]] = true;
+    }
+
+    auto release = [&](Netlist::NetID N) { if (--uses[N] == 0) { isHeld[N] = false; function[N] = BddManager::FALSE; } };
+    for (const Netlist::Gate& gate: netlist.gates)
+    {
+        function[gate.out] = manager.Apply(gate.type, function[gate.A], function[gate.B]);
+        isHeld[gate.out] = true;
+        release(gate.A);
+        if (!LogicGate::IsUnary(gate.type)) release(gate.B);
+
+        if (manager.NodeCount() > collectThreshold)
+        {
+            std::vector<Netlist::NetID> held{};
+            std::vector<Ref> roots{};
+            for (Netlist::NetID N{0}; N < netlist.NetCount(); ++N) {
+                if (isHeld[N]) { held.push_back(N); roots.push_back(function[N]); }
+            }
+            manager.Collect(roots);
+            for (std::size_t I{0}; I < held.size(); ++I) { function[held[I]] = roots[I]; }
+            // collecting again right away would be wasted effort
+            collectThreshold = std::max(collectThreshold, manager.NodeCount()*2);
+        }
+    }
+
+    std::vector<Ref> outputs{};
+    for (Netlist::NetID N: netlist.outputs) { outputs.push_back(function[N]); }
+    return outputs;
+}
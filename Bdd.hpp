@@ -0,0 +1,60 @@
+#ifndef CIRCUITSIM_BDD_HPP
+#define CIRCUITSIM_BDD_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+#include "LogicGate.hpp"
+#include "Netlist.hpp"
+
+
+// reduced ordered binary decision diagrams over up to 63 variables (variable 0 is tested first).
+// Nodes are hash-consed through a unique-table, so equal functions always share one 'Ref';
+// 'Apply' memoizes in a computed-table, and 'Collect' garbage-collects everything unreachable from given roots.
+class BddManager
+{
+    public:
+    using Ref = std::uint32_t;
+    static constexpr Ref FALSE{0}, TRUE{1};
+
+    Ref Var(int I) { return MakeNode(I, FALSE, TRUE); }
+    Ref Not(Ref F) { return Apply(LogicGate::NOT, F, F); }
+    Ref Apply(LogicGate::OpType T, Ref A, Ref B); // same semantics as 'LogicGate::Eval'
+
+    bool IsSatisfiable(Ref F) const { return (F != FALSE); }
+    std::vector<bool> AnySatisfying(Ref F) const; // one assignment making 'F' true (empty if unsatisfiable)
+    std::uint64_t SatisfyingCount(Ref F) const;   // number of input-assignments making 'F' true
+
+    // disjoint cubes (one per path to TRUE); one character per variable, highest variable first:
+    // '1', '0' or '-' (don't care). At most 'limit' cubes are returned
+    std::vector<std::string> Cubes(Ref F, std::size_t limit=64) const;
+
+    // removes all nodes not reachable from 'roots', which are renumbered in-place; clears the computed-table
+    void Collect(std::vector<Ref>& roots);
+    std::size_t NodeCount() const { return nodes.size(); }
+    int VariableCount() const { return variableCount; }
+
+    explicit BddManager(int variables);
+
+    private:
+    struct Node { int var; Ref low, high; }; // terminals have 'var == variableCount'
+    const int variableCount;
+    std::vector<Node> nodes;
+    std::unordered_map<std::uint64_t, Ref> unique;   // (var, low, high) -> node
+    std::unordered_map<std::uint64_t, Ref> computed; // (op, A, B) -> result
+
+    Ref MakeNode(int var, Ref low, Ref high);
+    static std::uint64_t UniqueKey(int var, Ref low, Ref high) { return (std::uint64_t(var) << 58) ^ (std::uint64_t(low) << 29) ^ high; }
+    static std::uint64_t ComputedKey(LogicGate::OpType T, Ref A, Ref B) { return (std::uint64_t(T) << 58) ^ (std::uint64_t(A) << 29) ^ B; }
+};
+
+
+// builds the exact function of every netlist output, in topological order, with input 'I' as variable 'I'.
+// nets are released (and periodically garbage-collected) once all their fanout has been built.
+// returns an empty vector if the netlist has loops or more inputs than the manager has variables
+std::vector<BddManager::Ref> BuildOutputBdds(const Netlist& netlist, BddManager& manager, std::size_t collectThreshold=1<<20);
+
+
+#endif
@@ -0,0 +1,318 @@
+#include "Checkpoint.hpp"
+#include "Interactives.hpp"
+#include "ComponentMap.hpp"
+#include "EditTransaction.hpp"
+#include "TextureStorage.hpp"
+
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+std::size_t Checkpoint::ComponentCount() const
+{
+    std::size_t count{0};
+    for (const auto& page: pages) {
+        if (!page) continue;
+        for (const Record& record: *page) { count += (record.kind != Record::Free); }
+    }
+    return count;
+}
+
+
+bool Checkpoint::Write(const std::string& path) const
+{
+    std::ostringstream text{};
+    text << std::setprecision(std::numeric_limits<float>::max_digits10);
+    text << "circuitsim-checkpoint 2\n" << "io " << inputCount << ' ' << outputCount << ' ' << sequence << '\n';
+    for (const auto& page: pages) {
+        if (!page) continue;
+        for (const Record& record: *page) {
+            if (record.kind == Record::Free) continue;
+            constexpr char kinds[] {"-gio"};
+            text << kinds[record.kind] << ' ' << record.ioIndex << ' ' << record.uuid << ' ' << LogicGate::GetName(record.type)
+                 << ' ' << record.x << ' ' << record.y << ' ' << record.state << ' ' << record.incoming.size();
+            for (const auto& [pin, source, output]: record.incoming) { text << ' ' << pin << ' ' << source << ' ' << output; }
+            text << '\n';
+        }
+    }
+    const std::string data {text.str()};
+
+    const std::string temporary {path + ".tmp"};
+    const int file {::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+    if (file < 0) return false;
+    bool isGood{true};
+    for (std::size_t written{0}; isGood && written < data.size();) {
+        const ssize_t result {::write(file, data.data() + written, data.size() - written)};
+        if (result < 0) isGood = false; else written += std::size_t(result);
+    }
+    isGood = (::fsync(file) == 0) && isGood;
+    isGood = (::close(file) == 0) && isGood;
+    if (!isGood) { std::remove(temporary.c_str()); return false; }
+    return (std::rename(temporary.c_str(), path.c_str()) == 0);
+}
+
+
+std::optional<Checkpoint> Checkpoint::Read(const std::string& path)
+{
+    std::ifstream file{path};
+    std::string magic{}, tag{};
+    int version{0};
+    Checkpoint checkpoint{};
+    if (!(file >> magic >> version) || magic != "circuitsim-checkpoint" || version < 1 || version > 2) return std::nullopt;
+    if (!(file >> tag >> checkpoint.inputCount >> checkpoint.outputCount >> checkpoint.sequence) || tag != "io") return std::nullopt;
+
+    std::shared_ptr<Page> page{};
+    std::size_t used{PAGE_SIZE};
+    char kind{};
+    while (file >> kind)
+    {
+        Record record{};
+        std::string typeName{};
+        std::size_t connections{0};
+        if (!(file >> record.ioIndex >> record.uuid >> typeName >> record.x >> record.y >> record.state >> connections)) return std::nullopt;
+        switch(kind) {
+            case 'g': record.kind = Record::Gate; break;
+            case 'i': record.kind = Record::GlobalInput; break;
+            case 'o': record.kind = Record::GlobalOutput; break;
+            default: return std::nullopt;
+        }
+        int T{0};
+        while (T < LogicGate::LAST_ENUM && LogicGate::GetName(LogicGate::OpType(T)) != typeName) { ++T; }
+        if (T == LogicGate::LAST_ENUM) return std::nullopt;
+        record.type = LogicGate::OpType(T);
+        for (std::size_t K{0}; K < connections; ++K) {
+            auto& [pin, source, output] {record.incoming.emplace_back()};
+            if (!(file >> pin >> source)) return std::nullopt;
+            if (version >= 2 && !(file >> output)) return std::nullopt; // version 1 only had single-output gates
+        }
+
+        // packed densely; slots only matter to the 'Checkpointer' that took a checkpoint
+        if (used == PAGE_SIZE) { page = std::make_shared<Page>(); checkpoint.pages.push_back(page); used = 0; }
+        (*page)[used++] = std::move(record);
+    }
+    return checkpoint;
+}
+
+
+
+Checkpointer::~Checkpointer()
+{
+    { std::lock_guard lock{mutex}; shouldStop = true; }
+    wake.notify_all();
+    if (writer.joinable()) writer.join(); // the last queued checkpoint is still written
+}
+
+
+void Checkpointer::MarkDirty(std::size_t slot)
+{
+    const std::size_t P {slot/Checkpoint::PAGE_SIZE};
+    if (P >= isPageDirty.size()) isPageDirty.resize(P+1, false);
+    if (isPageDirty[P]) return;
+    isPageDirty[P] = true;
+    dirtyPages.push_back(P);
+}
+
+
+std::size_t Checkpointer::SlotFor(const Component* component)
+{
+    auto [iter, isNew] = slotOf.try_emplace(component, 0);
+    if (isNew) {
+        if (!freeSlots.empty()) { iter->second = freeSlots.back(); freeSlots.pop_back(); componentAt[iter->second] = component; }
+        else { iter->second = componentAt.size(); componentAt.push_back(component); }
+    }
+    return iter->second;
+}
+
+
+void Checkpointer::ResetSlots()
+{
+    slotOf.clear(); componentAt.clear(); freeSlots.clear();
+    dirtyPages.clear(); isPageDirty.clear();
+    latest.pages.clear();
+}
+
+
+void Checkpointer::Touch(const Component* component)
+{
+    if (isAllDirty) return; // every slot is reassigned on the next 'Take' anyway
+    MarkDirty(SlotFor(component));
+}
+
+
+void Checkpointer::TouchAll() { isAllDirty = true; }
+
+
+void Checkpointer::Forget(const Component* component)
+{
+    auto found = slotOf.find(component);
+    if (found == slotOf.end()) return;
+    const std::size_t slot {found->second};
+    slotOf.erase(found);
+    componentAt[slot] = nullptr;
+    freeSlots.push_back(slot);
+    if (!isAllDirty) MarkDirty(slot);
+}
+
+
+Checkpoint::Record Checkpointer::Capture(const Component& component, const std::vector<Component>& globalInputs, const std::vector<Component>& globalOutput)
+{
+    Checkpoint::Record record{};
+    if (component.isGlobalIn) { record.kind = Checkpoint::Record::GlobalInput; record.ioIndex = int(&component - globalInputs.data()); }
+    else if (component.isGlobalOut) { record.kind = Checkpoint::Record::GlobalOutput; record.ioIndex = int(&component - globalOutput.data()); }
+    else record.kind = Checkpoint::Record::Gate;
+
+    record.uuid = component.UUID();
+    record.type = component.gate.mType;
+    const auto [X, Y] = component.sprite.getPosition();
+    record.x = X; record.y = Y;
+    record.state = component.ReadOutputs();
+    for (int K{0}; K < int(component.inputs.size()); ++K) {
+        const std::string& pinUUID {component.inputs[K].UUID};
+        auto search = component.incoming.find(pinUUID);
+        if (search != component.incoming.end()) record.incoming.push_back({K, search->second->UUID(), search->second->OutputDriving(pinUUID)});
+    }
+    return record;
+}
+
+
+Checkpoint Checkpointer::Take(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput)
+{
+    const auto startTime {std::chrono::steady_clock::now()};
+    if (isAllDirty) {
+        ResetSlots();
+        isAllDirty = false;
+        for (const Component& component: globalInputs) { Touch(&component); }
+        components.ForEach([this](const Component& component) { Touch(&component); });
+        for (const Component& component: globalOutput) { Touch(&component); }
+    }
+
+    // unchanged pages are shared with the previous checkpoint; only the dirty ones are captured again
+    Checkpoint checkpoint {latest};
+    checkpoint.pages.resize((componentAt.size() + Checkpoint::PAGE_SIZE - 1)/Checkpoint::PAGE_SIZE);
+    for (std::size_t P: dirtyPages) {
+        auto page {std::make_shared<Checkpoint::Page>()};
+        for (std::size_t K{0}; K < Checkpoint::PAGE_SIZE; ++K) {
+            const std::size_t slot {P*Checkpoint::PAGE_SIZE + K};
+            if (slot < componentAt.size() && componentAt[slot]) (*page)[K] = Capture(*componentAt[slot], globalInputs, globalOutput);
+        }
+        checkpoint.pages[P] = std::move(page);
+        isPageDirty[P] = false;
+    }
+    lastPagesCopied = dirtyPages.size();
+    dirtyPages.clear();
+
+    checkpoint.inputCount = globalInputs.size();
+    checkpoint.outputCount = globalOutput.size();
+    checkpoint.sequence = latest.sequence + 1;
+    latest = checkpoint;
+    lastTakeMicroseconds = std::chrono::duration<double, std::micro>{std::chrono::steady_clock::now() - startTime}.count();
+    return checkpoint;
+}
+
+
+void Checkpointer::SaveAsync(Checkpoint checkpoint, std::string path)
+{
+    std::lock_guard lock{mutex};
+    if (!writer.joinable()) writer = std::thread{&Checkpointer::RunWriter, this};
+    pending.emplace(std::move(checkpoint), std::move(path));
+    wake.notify_one();
+}
+
+
+void Checkpointer::Flush()
+{
+    std::unique_lock lock{mutex};
+    idle.wait(lock, [this] { return !pending && !isWriting; });
+}
+
+
+void Checkpointer::RunWriter()
+{
+    std::unique_lock lock{mutex};
+    while (true)
+    {
+        wake.wait(lock, [this] { return pending || shouldStop; });
+        if (!pending) return;
+        auto [checkpoint, path] {std::move(*pending)};
+        pending.reset();
+        isWriting = true;
+        lock.unlock();
+
+        const auto startTime {std::chrono::steady_clock::now()};
+        const bool isGood {checkpoint.Write(path)};
+        lastSaveMilliseconds = std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - startTime}.count();
+        lastSaveFailed = !isGood;
+        if (isGood) ++savesCompleted;
+
+        lock.lock();
+        isWriting = false;
+        idle.notify_all();
+    }
+}
+
+
+bool Checkpointer::Restore(const Checkpoint& checkpoint, std::vector<Component>& globalInputs, ComponentMap& components,
+                           std::vector<Component>& globalOutput, const EditObservers& observers)
+{
+    if (checkpoint.inputCount != globalInputs.size() || checkpoint.outputCount != globalOutput.size()) return false;
+
+    {
+        EditTransaction clearing{globalInputs, components, globalOutput, observers};
+        components.ForEach([&clearing](Component& component) { clearing.Delete(component); });
+        for (Component& component: globalInputs) { clearing.Disconnect(component); }
+        for (Component& component: globalOutput) { clearing.Disconnect(component); }
+    }
+
+    // components get new UUIDs; connections are resolved through the recorded ones
+    std::unordered_map<std::string, Component*> byUUID{};
+    std::vector<std::pair<const Checkpoint::Record*, Component*>> placed{};
+    EditTransaction edit{globalInputs, components, globalOutput, observers};
+    for (const auto& page: checkpoint.pages) {
+        if (!page) continue;
+        for (const Checkpoint::Record& record: *page) {
+            Component* component{nullptr};
+            const bool isInRange {record.ioIndex >= 0};
+            switch(record.kind) {
+                case Checkpoint::Record::Gate:
+                    component = &edit.Insert(record.type, TextureStorage::GetSprite(record.type));
+                    component->SetPosition(record.x, record.y);
+                break;
+                case Checkpoint::Record::GlobalInput:
+                    if (!isInRange || std::size_t(record.ioIndex) >= globalInputs.size()) continue;
+                    component = &globalInputs[record.ioIndex];
+                    component->inputs[0].state = (record.state & 1);
+                break;
+                case Checkpoint::Record::GlobalOutput:
+                    if (!isInRange || std::size_t(record.ioIndex) >= globalOutput.size()) continue;
+                    component = &globalOutput[record.ioIndex];
+                break;
+                default: continue;
+            }
+            if (component->isGlobalIn) component->PropagateLogic();
+            byUUID[record.uuid] = component;
+            placed.emplace_back(&record, component);
+        }
+    }
+    for (auto [record, target]: placed) {
+        for (const auto& [pin, sourceUUID, output]: record->incoming) {
+            auto found = byUUID.find(sourceUUID);
+            if (found == byUUID.end() || pin < 0 || std::size_t(pin) >= target->inputs.size()) continue;
+            edit.Connect(*found->second, *target, &target->inputs[pin], output);
+        }
+    }
+    edit.Commit();
+    // the same as repropagating for combinational logic; on loops, puts back the state that was actually recorded
+    for (auto [record, component]: placed) {
+        for (int K{0}; K < int(component->GetOutputCount()); ++K) { component->ShowState((record->state >> K) & 1, K); }
+    }
+
+    TouchAll();
+    return true;
+}
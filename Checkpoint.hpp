@@ -0,0 +1,117 @@
+#ifndef CIRCUITSIM_CHECKPOINT_HPP
+#define CIRCUITSIM_CHECKPOINT_HPP
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "LogicGate.hpp"
+
+class Component;
+class ComponentMap;
+struct EditObservers;
+
+
+// the whole canvas (components, connections and states) at one moment. Records are grouped into immutable pages,
+// shared between consecutive checkpoints wherever nothing on them changed, so a checkpoint can be handed
+// to another thread (or kept around) while the canvas goes on changing
+struct Checkpoint
+{
+    static constexpr std::size_t PAGE_SIZE{64};
+
+    struct Record
+    {
+        enum Kind: std::uint8_t { Free, Gate, GlobalInput, GlobalOutput, } kind{Free};
+        int ioIndex{-1}; // into 'globalInputs'/'globalOutput'
+        std::string uuid{};
+        LogicGate::OpType type{LogicGate::EQ};
+        float x{0}, y{0};
+        unsigned state{0}; // bit 'K' is output 'K' ('Component::ReadOutputs')
+        struct Connection { int pin{0}; std::string source{}; int output{0}; }; // input-pin index, source's UUID and output-pin index
+        std::vector<Connection> incoming{};
+    };
+    using Page = std::array<Record, PAGE_SIZE>;
+
+    std::vector<std::shared_ptr<const Page>> pages{};
+    std::size_t inputCount{0}, outputCount{0};
+    std::uint64_t sequence{0}; // increases with every checkpoint taken
+
+    std::size_t ComponentCount() const;
+
+    // text (version 2; version 1, from before cells, is still read); written to a temporary file that's fsync'd and then renamed over 'path', so a crash never leaves half a file
+    bool Write(const std::string& path) const;
+    static std::optional<Checkpoint> Read(const std::string& path);
+};
+
+
+// takes checkpoints of the canvas in O(changed pages) on the UI-thread, and writes them out on a background thread.
+// Every component owns a slot on some page; the UI reports which components changed ('Touch', or through
+// the 'EditTransaction' observer), and only those pages are copied on the next 'Take'
+class Checkpointer
+{
+    public:
+    void Touch(const Component* component);
+    void TouchAll(); // e.g. after every state was recomputed; the next 'Take' rereads the whole canvas
+    void Forget(const Component* component); // before it's deleted
+    bool HasChanges() const { return (isAllDirty || !dirtyPages.empty()); }
+
+    Checkpoint Take(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput);
+
+    // queues the checkpoint for the writer-thread and returns immediately; a checkpoint still waiting is replaced
+    void SaveAsync(Checkpoint checkpoint, std::string path);
+    void Flush(); // waits until nothing is queued or being written
+
+    // rebuilds the canvas from the checkpoint (as one transaction, so 'observers' stay current), then
+    // repropagates. Returns false if its global inputs/outputs don't match this canvas
+    bool Restore(const Checkpoint& checkpoint, std::vector<Component>& globalInputs, ComponentMap& components,
+                 std::vector<Component>& globalOutput, const EditObservers& observers);
+
+    std::size_t LastPagesCopied() const { return lastPagesCopied; }
+    double LastTakeMicroseconds() const { return lastTakeMicroseconds; }
+    std::uint64_t SavesCompleted() const { return savesCompleted.load(); }
+    double LastSaveMilliseconds() const { return lastSaveMilliseconds.load(); }
+    bool LastSaveFailed() const { return lastSaveFailed.load(); }
+
+    Checkpointer() = default;
+    ~Checkpointer();
+
+    private:
+    // slots (UI-thread only)
+    std::unordered_map<const Component*, std::size_t> slotOf{};
+    std::vector<const Component*> componentAt{}; // by slot; nullptr for free slots
+    std::vector<std::size_t> freeSlots{};
+    std::vector<std::size_t> dirtyPages{};
+    std::vector<bool> isPageDirty{};
+    bool isAllDirty{true};
+    Checkpoint latest{};
+    std::size_t lastPagesCopied{0};
+    double lastTakeMicroseconds{0};
+
+    void MarkDirty(std::size_t slot);
+    std::size_t SlotFor(const Component* component);
+    void ResetSlots();
+    static Checkpoint::Record Capture(const Component& component, const std::vector<Component>& globalInputs, const std::vector<Component>& globalOutput);
+
+    // writer-thread
+    std::thread writer{};
+    std::mutex mutex{};
+    std::condition_variable wake{}, idle{};
+    std::optional<std::pair<Checkpoint, std::string>> pending{};
+    bool isWriting{false}, shouldStop{false};
+    std::atomic<std::uint64_t> savesCompleted{0};
+    std::atomic<double> lastSaveMilliseconds{0};
+    std::atomic<bool> lastSaveFailed{false};
+
+    void RunWriter();
+};
+
+
+#endif
@@ -4,17 +4,20 @@
 #include <unordered_map>
 
 #include "Interactives.hpp"
+#include "Datapath.hpp"
 
 
 class ComponentMap: std::unordered_map<std::string, Component>
 {
     static bool shouldBreak;
+    static Component& Queued(Component& component) { component.MarkChanged(); return component; }
     
     public:
     static void Break() { shouldBreak = true; }
     
-    auto& Push(LogicGate::OpType T) { return insert({LogicGate::GetNextUUID(T), Component(T)}).first->second; }
-    auto& Push(LogicGate::OpType T, sf::Sprite S) { return insert({LogicGate::GetNextUUID(T), Component(T, S)}).first->second; }
+    // new components are queued for the render-cache here; the temporaries they're copied from aren't
+    auto& Push(LogicGate::OpType T) { return Queued(insert({LogicGate::GetNextUUID(T), Component(T)}).first->second); }
+    auto& Push(LogicGate::OpType T, sf::Sprite S) { return Queued(insert({LogicGate::GetNextUUID(T), Component(T, S)}).first->second); }
     
     void ForEach(auto&& lambda) {
         shouldBreak = false;
@@ -42,6 +45,11 @@ class ComponentMap: std::unordered_map<std::string, Component>
     }
     
     void Remove(Component& component) { erase(component.UUID()); }
+    Component* Find(const std::string& UUID) { auto search = find(UUID); return ((search == end())? nullptr : &search->second); }
+    
+    // word-level blocks between buses of global inputs; their boundary-bits are indices into the global inputs
+    // (see 'UpdateDatapath' and 'Netlist::Extract')
+    Datapath datapath{};
 };
 
 
@@ -0,0 +1,117 @@
+#include "Cones.hpp"
+#include "Interactives.hpp"
+#include "ComponentMap.hpp"
+
+#include <chrono>
+#include <algorithm>
+#include <functional>
+
+
+ConeIndex::NodeID ConeIndex::Ensure(Component* component)
+{
+    auto [iter, isNew] = ids.try_emplace(component, 0);
+    if (!isNew) return iter->second;
+    if (!freeIDs.empty()) { iter->second = freeIDs.back(); freeIDs.pop_back(); }
+    else {
+        iter->second = NodeID(componentOf.size());
+        componentOf.push_back(nullptr); fanin.emplace_back(); fanout.emplace_back();
+    }
+    componentOf[iter->second] = component;
+    return iter->second;
+}
+
+
+void ConeIndex::Rewire(NodeID N)
+{
+    for (NodeID source: fanin[N]) { std::erase(fanout[source], N); }
+    fanin[N].clear();
+    for (auto [pinUUID, source]: componentOf[N]->incoming) {
+        const NodeID S {Ensure(source)};
+        fanin[N].push_back(S);
+        fanout[S].push_back(N);
+    }
+}
+
+
+void ConeIndex::Forget(NodeID N)
+{
+    for (NodeID source: fanin[N]) { std::erase(fanout[source], N); }
+    for (NodeID target: fanout[N]) { std::erase(fanin[target], N); }
+    fanin[N].clear(); fanout[N].clear();
+    ids.erase(componentOf[N]);
+    componentOf[N] = nullptr;
+    freeIDs.push_back(N);
+}
+
+
+void ConeIndex::Build(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput)
+{
+    *this = ConeIndex{};
+    for (Component& component: globalInputs) { Ensure(&component); }
+    components.ForEach([this](Component& component) { Ensure(&component); });
+    for (Component& component: globalOutput) { Ensure(&component); }
+    for (NodeID N{0}; N < NodeID(componentOf.size()); ++N) { Rewire(N); }
+}
+
+
+void ConeIndex::Update(const std::vector<Component*>& changed, const std::vector<Component*>& removed)
+{
+    std::vector<NodeID> touched{};
+    for (Component* component: removed) {
+        auto found = ids.find(component);
+        if (found == ids.end()) continue;
+        touched.push_back(found->second);
+        Forget(found->second);
+    }
+    for (Component* component: changed) {
+        const NodeID N {Ensure(component)};
+        Rewire(N);
+        touched.push_back(N);
+    }
+    if (touched.empty()) return;
+
+    // removed components count as touched, so no cached cone outlives the ID of one of its members
+    std::erase_if(cache, [&touched](const auto& entry) {
+        const Cone& cone {entry.second};
+        return std::any_of(touched.begin(), touched.end(), [&cone](NodeID N) { return cone.Has(N); });
+    });
+}
+
+
+const ConeIndex::Cone& ConeIndex::Query(Component* root, Direction direction)
+{
+    const auto startTime {std::chrono::steady_clock::now()};
+    const bool isNew {!ids.contains(root)};
+    const NodeID R {Ensure(root)};
+    if (isNew) Rewire(R);
+    const std::uint64_t key {(std::uint64_t(R) << 1) | std::uint64_t(direction == Direction::Fanout)};
+
+    lastQueryWasCached = cache.contains(key);
+    if (!lastQueryWasCached) {
+        if (cache.size() >= CACHE_CAPACITY) cache.erase(cache.begin());
+        Cone cone{direction};
+        cone.bits.assign((componentOf.size() + 63)/64, 0);
+        const std::vector<std::vector<NodeID>>& next {(direction == Direction::Fanin)? fanin : fanout};
+
+        std::vector<NodeID> queue{R};
+        cone.bits[R/64] |= std::uint64_t{1} << (R%64);
+        for (std::size_t I{0}; I < queue.size(); ++I) {
+            for (NodeID N: next[queue[I]]) {
+                std::uint64_t& word {cone.bits[N/64]};
+                const std::uint64_t bit {std::uint64_t{1} << (N%64)};
+                if (!(word & bit)) { word |= bit; queue.push_back(N); }
+            }
+        }
+
+        cone.members.reserve(queue.size());
+        for (NodeID N: queue) {
+            Component* component {componentOf[N]};
+            cone.members.push_back(component);
+            if ((direction == Direction::Fanin)? component->isGlobalIn : component->isGlobalOut) cone.boundary.push_back(component);
+        }
+        std::sort(cone.boundary.begin(), cone.boundary.end(), std::less<Component*>{}); // both are laid out in vectors
+        cache.emplace(key, std::move(cone));
+    }
+    lastQueryMicroseconds = std::chrono::duration<double, std::micro>{std::chrono::steady_clock::now() - startTime}.count();
+    return cache.at(key);
+}
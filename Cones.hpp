@@ -0,0 +1,62 @@
+#ifndef CIRCUITSIM_CONES_HPP
+#define CIRCUITSIM_CONES_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+class Component;
+class ComponentMap;
+
+
+// transitive fanin/fanout cones of the canvas' components, over integer adjacency lists (no pin-UUID lookups).
+// Each cone is a bitset over node IDs, cached until an edit touches a component inside it: a changed connection
+// always touches both of its ends, so a cone can only have changed if one of them was in it
+class ConeIndex
+{
+    public:
+    using NodeID = int;
+    enum class Direction: std::uint8_t { Fanin, Fanout, };
+
+    struct Cone
+    {
+        Direction direction;
+        std::vector<std::uint64_t> bits{};  // by node ID
+        std::vector<Component*> members{};  // including the root, in breadth-first order from it
+        std::vector<Component*> boundary{}; // global inputs of a fanin-cone, global outputs of a fanout-cone; in canvas order
+
+        bool Has(NodeID N) const { return (std::size_t(N)/64 < bits.size()) && ((bits[N/64] >> (N%64)) & 1); }
+    };
+
+    void Build(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput);
+
+    // the same contract as 'TimingGraph::Update': 'changed' have their fanin re-read, 'removed' are about to be deleted
+    void Update(const std::vector<Component*>& changed, const std::vector<Component*>& removed);
+
+    bool Contains(const Component* component) const { return ids.contains(component); }
+    const Cone& Query(Component* root, Direction direction);
+
+    std::size_t NodeCount() const { return ids.size(); }
+    std::size_t CachedCones() const { return cache.size(); }
+    bool LastQueryWasCached() const { return lastQueryWasCached; }
+    double LastQueryMicroseconds() const { return lastQueryMicroseconds; }
+
+    private:
+    static constexpr std::size_t CACHE_CAPACITY{64};
+
+    std::unordered_map<const Component*, NodeID> ids{};
+    std::vector<Component*> componentOf{}; // by ID; nullptr for free IDs
+    std::vector<std::vector<NodeID>> fanin{}, fanout{}; // one entry per connected pin
+    std::vector<NodeID> freeIDs{};
+    std::unordered_map<std::uint64_t, Cone> cache{}; // keyed by (root << 1 | direction)
+    bool lastQueryWasCached{false};
+    double lastQueryMicroseconds{0};
+
+    NodeID Ensure(Component* component); // without reading its connections
+    void Rewire(NodeID N);               // re-reads its fanin from 'incoming'
+    void Forget(NodeID N);
+};
+
+
+#endif
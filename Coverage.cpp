@@ -0,0 +1,144 @@
+#include "Coverage.hpp"
+#include "Interactives.hpp"
+
+#include <bit>
+#include <format>
+#include <numeric>
+#include <algorithm>
+
+
+void ToggleCoverage::Reset(std::size_t netCount)
+{
+    rises.assign(netCount, 0);
+    falls.assign(netCount, 0);
+    last.assign(netCount, 0);
+    vectors = 0;
+}
+
+
+namespace {
+
+using Word = ToggleCoverage::Word;
+
+// carry-save adder: adds 'A' and 'B' into the bit-sliced pair ('high', 'low')
+void CarrySave(Word& high, Word& low, Word A, Word B)
+{
+    const Word U {low ^ A};
+    high = (low & A) | (U & B);
+    low = U ^ B;
+}
+
+
+// toggles between consecutive lanes of words [1, words-1), each of which also compares its lane 0 against the
+// previous word's lane 63. Summed Harley-Seal style, so only one word in eight is popcounted
+std::uint64_t CountInnerToggles(const Word* lanes, std::size_t words)
+{
+    auto toggles = [lanes](std::size_t W) { return lanes[W] ^ ((lanes[W] << 1) | (lanes[W-1] >> 63)); };
+    std::uint64_t eightsCount{0};
+    Word ones{0}, twos{0}, fours{0};
+    std::size_t W{1};
+    for (; W + 8 < words; W += 8) {
+        Word twosA, twosB, foursA, foursB, eights;
+        CarrySave(twosA, ones, toggles(W),   toggles(W+1));
+        CarrySave(twosB, ones, toggles(W+2), toggles(W+3));
+        CarrySave(foursA, twos, twosA, twosB);
+        CarrySave(twosA, ones, toggles(W+4), toggles(W+5));
+        CarrySave(twosB, ones, toggles(W+6), toggles(W+7));
+        CarrySave(foursB, twos, twosA, twosB);
+        CarrySave(eights, fours, foursA, foursB);
+        eightsCount += std::popcount(eights);
+    }
+    std::uint64_t count {8*eightsCount + 4*std::uint64_t(std::popcount(fours)) + 2*std::uint64_t(std::popcount(twos)) + std::popcount(ones)};
+    for (; W + 1 < words; ++W) { count += std::popcount(toggles(W)); }
+    return count;
+}
+
+} // namespace
+
+
+void ToggleCoverage::Accumulate(const Word* state, std::size_t stride, std::size_t count)
+{
+    if (count == 0) return;
+    const std::size_t words {(count+63)/64};
+    const Word tailMask {((count%64) == 0)? ~Word{0} : ((Word{1} << (count%64)) - 1)};
+    const Word headMask {(vectors == 0)? ~Word{1} : ~Word{0}}; // the very first vector has nothing to toggle from
+
+    // only toggles are counted; rises and falls alternate, so they follow from where the net started and ended
+    for (std::size_t N{0}; N < rises.size(); ++N)
+    {
+        const Word* lanes {state + N*stride};
+        const Word start {(vectors == 0)? (lanes[0] & 1) : last[N]};
+        const Word end {(lanes[words-1] >> ((count-1)%64)) & 1};
+
+        const Word first {(lanes[0] ^ ((lanes[0] << 1) | last[N])) & headMask};
+        std::uint64_t toggles {std::uint64_t(std::popcount(first & ((words == 1)? tailMask : ~Word{0})))};
+        if (words > 1) {
+            toggles += CountInnerToggles(lanes, words);
+            const Word final {(lanes[words-1] ^ ((lanes[words-1] << 1) | (lanes[words-2] >> 63))) & tailMask};
+            toggles += std::popcount(final);
+        }
+
+        const std::uint64_t rose {(toggles + end - start)/2};
+        rises[N] += rose; falls[N] += toggles - rose;
+        last[N] = end;
+    }
+    vectors += count;
+}
+
+
+std::vector<std::size_t> ToggleCoverage::Untoggled() const
+{
+    std::vector<std::size_t> nets{};
+    for (std::size_t N{1}; N < rises.size(); ++N) { if (Toggles(N) == 0) nets.push_back(N); }
+    return nets;
+}
+
+
+std::size_t ToggleCoverage::FullyCovered() const
+{
+    std::size_t covered{0};
+    for (std::size_t N{1}; N < rises.size(); ++N) { covered += (rises[N] && falls[N]); }
+    return covered;
+}
+
+
+std::string ToggleCoverage::Report(const std::vector<Component*>& origin, const Netlist::CellOutputs& cellOutputs, std::size_t listLimit) const
+{
+    auto name = [&](std::size_t N) {
+        if (N >= origin.size() || !origin[N]) return std::format("net{}", N);
+        auto cell = cellOutputs.find(origin[N]);
+        if (cell == cellOutputs.end()) return origin[N]->UUID();
+        const auto output = std::find(cell->second.begin(), cell->second.end(), Netlist::NetID(N));
+        if (output == cell->second.end()) return std::format("{}.internal{}", origin[N]->UUID(), N);
+        return std::format("{}.out{}", origin[N]->UUID(), output - cell->second.begin());
+    };
+
+    const std::size_t nets {std::max<std::size_t>(rises.size(), 1) - 1}; // without 'CONST0'
+    const std::vector<std::size_t> untoggled {Untoggled()};
+    const std::uint64_t totalRises {std::accumulate(rises.begin(), rises.end(), std::uint64_t{0})};
+    const std::uint64_t totalFalls {std::accumulate(falls.begin(), falls.end(), std::uint64_t{0})};
+    const double meanActivity {(nets && vectors > 1)? double(totalRises + totalFalls)/double(nets*(vectors - 1)) : 0.0};
+
+    std::string text {std::format("toggle coverage: {} vectors | {}/{} nets toggled both ways ({:.1f}%), {} never toggled\n",
+        vectors, FullyCovered(), nets, (nets? FullyCovered()*100.0/nets : 0.0), untoggled.size())};
+    text += std::format("\t{} rises (0->1), {} falls (1->0); mean activity {:.3f} toggles per net per vector\n", totalRises, totalFalls, meanActivity);
+
+    if (!untoggled.empty()) {
+        text += "\tnever toggled:";
+        for (std::size_t K{0}; K < untoggled.size() && K < listLimit; ++K) { text += ' ' + name(untoggled[K]); }
+        if (untoggled.size() > listLimit) text += " ...";
+        text += '\n';
+    }
+
+    std::vector<std::size_t> active(nets);
+    std::iota(active.begin(), active.end(), std::size_t{1});
+    const std::size_t shown {std::min(listLimit, active.size())};
+    std::partial_sort(active.begin(), active.begin() + shown, active.end(),
+        [this](std::size_t A, std::size_t B) { return Toggles(A) > Toggles(B); });
+    text += "\tmost active:";
+    for (std::size_t K{0}; K < shown && Toggles(active[K]); ++K) {
+        text += std::format(" {}({}/{})", name(active[K]), rises[active[K]], falls[active[K]]);
+    }
+    text += '\n';
+    return text;
+}
@@ -0,0 +1,51 @@
+#ifndef CIRCUITSIM_COVERAGE_HPP
+#define CIRCUITSIM_COVERAGE_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "Netlist.hpp"
+
+class Component;
+
+
+// per-net toggle counts over a sequence of vectors, accumulated straight from bit-parallel states:
+// each word is compared against itself shifted by one lane (so lane 'V' meets lane 'V-1', the previous vector)
+// and the rising (0->1) and falling (1->0) transitions are popcounted. The last lane of each call carries over
+// into the next one, so a stream of batches counts as one long sequence
+class ToggleCoverage
+{
+    public:
+    using Word = Netlist::Word;
+
+    void Reset(std::size_t netCount);
+
+    // 'vectors' lanes of every net, net-major like 'Netlist::Evaluate' ('state' holds 'NetCount()' nets)
+    void Accumulate(const Word* state, std::size_t stride, std::size_t vectors);
+
+    std::size_t NetCount() const { return rises.size(); }
+    std::uint64_t Vectors() const { return vectors; }
+    std::uint64_t Rises(std::size_t N) const { return rises[N]; }
+    std::uint64_t Falls(std::size_t N) const { return falls[N]; }
+    std::uint64_t Toggles(std::size_t N) const { return rises[N] + falls[N]; }
+    double Activity(std::size_t N) const { return ((vectors > 1)? double(Toggles(N))/double(vectors - 1) : 0.0); } // per transition, 0..1
+
+    // nets that never toggled, leaving out 'CONST0'. A net toggled both ways (rose and fell) is fully covered
+    std::vector<std::size_t> Untoggled() const;
+    std::size_t FullyCovered() const;
+
+    // 'origin' names nets after the components they were extracted from (see 'Netlist::origin'); a cell's nets are
+    // named after its output, or marked internal, when 'cellOutputs' knows the cell (see 'Netlist::cellOutputs').
+    // At most 'listLimit' untoggled/most-active nets are listed
+    std::string Report(const std::vector<Component*>& origin, const Netlist::CellOutputs& cellOutputs={}, std::size_t listLimit=16) const;
+
+    private:
+    std::vector<std::uint64_t> rises{}, falls{};
+    std::vector<Word> last{}; // the previous call's last lane of each net, in bit 0
+    std::uint64_t vectors{0};
+};
+
+
+#endif
@@ -0,0 +1,101 @@
+#include "Datapath.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+int Datapath::AddBlock(WordBlock::OpType T, int A, int B, int S)
+{
+    assert(A >= 0 && A < int(buses.size()));
+    int width {buses[A].width};
+    if (B >= 0 && T != WordBlock::SHL && T != WordBlock::SHR) { width = std::max(width, buses[B].width); }
+    if (T == WordBlock::LESS || T == WordBlock::EQUAL) { width = 1; }
+
+    const int out {AddBus(WordBlock::GetName(T) + '_' + std::to_string(blocks.size()), width)};
+    blocks.push_back({T, A, B, S, out});
+    return out;
+}
+
+
+bool Datapath::Levelize()
+{
+    std::vector<int> driver(buses.size(), -1);
+    for (std::size_t I{0}; I < blocks.size(); ++I) { driver[blocks[I].out] = int(I); }
+
+    // depth-first post-order; 'mark' is 0 = unvisited, 1 = on stack, 2 = done
+    std::vector<int> mark(blocks.size(), 0);
+    std::vector<WordBlock> sorted; sorted.reserve(blocks.size());
+    bool isAcyclic{true};
+
+    auto visit = [&](auto&& self, int I) -> void {
+        if (mark[I] == 2) return;
+        if (mark[I] == 1) { isAcyclic = false; return; }
+        mark[I] = 1;
+        for (int bus: {blocks[I].A, blocks[I].B, blocks[I].S}) {
+            if (bus >= 0 && driver[bus] >= 0) self(self, driver[bus]);
+        }
+        mark[I] = 2;
+        sorted.push_back(blocks[I]);
+    };
+    for (std::size_t I{0}; I < blocks.size(); ++I) { visit(visit, int(I)); }
+
+    blocks.swap(sorted);
+    return isAcyclic;
+}
+
+
+void Datapath::Evaluate(Word* values, std::size_t count) const
+{
+    static const std::vector<Word> zeroes(1);
+    for (const WordBlock& block: blocks)
+    {
+        Word* out {values + block.out*count};
+        const Word* A {values + block.A*count};
+        // unused operands read from a zeroed row, stepping by 0
+        const Word* B {(block.B >= 0)? (values + block.B*count) : zeroes.data()};
+        const Word* S {(block.S >= 0)? (values + block.S*count) : zeroes.data()};
+        const std::size_t stepB {(block.B >= 0)? 1u : 0u}, stepS {(block.S >= 0)? 1u : 0u};
+        const Word mask {buses[block.out].Mask()};
+
+        for (std::size_t V{0}; V < count; ++V) {
+            out[V] = WordBlock::Eval(block.mType, A[V], B[V*stepB], S[V*stepS]) & mask;
+        }
+    }
+    return;
+}
+
+
+void Datapath::Gather(const Netlist::Word* netState, std::size_t stride, Word* values, std::size_t count) const
+{
+    Word rows[64];
+    for (const Boundary& boundary: fromBits)
+    {
+        const std::size_t width {std::min<std::size_t>(boundary.bits.size(), 64)};
+        for (std::size_t W{0}; W*64 < count; ++W)
+        {
+            for (std::size_t B{0}; B < 64; ++B) { rows[B] = ((B < width)? netState[boundary.bits[B]*stride + W] : 0); }
+            Netlist::Transpose64(rows);
+            const std::size_t lanes {std::min<std::size_t>(64, count - W*64)};
+            for (std::size_t L{0}; L < lanes; ++L) { values[boundary.bus*count + W*64 + L] = rows[L] & buses[boundary.bus].Mask(); }
+        }
+    }
+    return;
+}
+
+
+void Datapath::Scatter(const Word* values, std::size_t count, Netlist::Word* netState, std::size_t stride) const
+{
+    Word rows[64];
+    for (const Boundary& boundary: toBits)
+    {
+        const std::size_t width {std::min<std::size_t>(boundary.bits.size(), 64)};
+        for (std::size_t W{0}; W*64 < count; ++W)
+        {
+            const std::size_t lanes {std::min<std::size_t>(64, count - W*64)};
+            for (std::size_t L{0}; L < 64; ++L) { rows[L] = ((L < lanes)? values[boundary.bus*count + W*64 + L] : 0); }
+            Netlist::Transpose64(rows);
+            for (std::size_t B{0}; B < width; ++B) { netState[boundary.bits[B]*stride + W] = rows[B]; }
+        }
+    }
+    return;
+}
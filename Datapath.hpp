@@ -0,0 +1,101 @@
+#ifndef CIRCUITSIM_DATAPATH_HPP
+#define CIRCUITSIM_DATAPATH_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Netlist.hpp"
+
+
+// word-level operation over up to 64-bit buses; evaluated with one native integer instruction
+// instead of a tree of bit-level gates
+struct WordBlock
+{
+    using Word = std::uint64_t;
+
+    enum OpType
+    {
+        ADD,  SUB,
+        AND,  OR,  XOR, NOT,
+        SHL,  SHR,   // shift amount is read from 'B'
+        LESS, EQUAL, // unsigned comparisons; 1-bit result
+        MUX,         // (S? B : A)
+        LAST_ENUM,
+    } mType;
+
+    int A{-1}, B{-1}, S{-1}; // bus indices (-1 when unused)
+    int out;
+
+    static Word Eval(OpType T, Word A, Word B, Word S) {
+        switch(T) {
+            case  ADD: return (A + B);  case   SUB: return (A - B);
+            case  AND: return (A & B);  case    OR: return (A | B);
+            case  XOR: return (A ^ B);  case   NOT: return ~A;
+            case  SHL: return ((B < 64)? (A << B) : 0);
+            case  SHR: return ((B < 64)? (A >> B) : 0);
+            case LESS: return (A < B);  case EQUAL: return (A == B);
+            case  MUX: { const Word mask{Word{0} - (S & 1)}; return ((A & ~mask) | (B & mask)); } // branchless select
+            default: return 0;
+        }
+    }
+
+    static std::string GetName(OpType T) {
+        switch(T) {
+            case  ADD: return  "ADD"; case   SUB: return   "SUB";
+            case  AND: return "WAND"; case    OR: return   "WOR";
+            case  XOR: return "WXOR"; case   NOT: return  "WNOT";
+            case  SHL: return  "SHL"; case   SHR: return   "SHR";
+            case LESS: return "LESS"; case EQUAL: return "EQUAL";
+            case  MUX: return  "MUX";
+            default: return "INVALID";
+        }
+    }
+};
+
+
+// N-bit bus nets and the word-level blocks between them. Buses connect to the bit-level netlist
+// only at their boundary: 'fromBits' are packed out of netlist nets, 'toBits' are unpacked into them.
+// Values are bus-major: 'values[bus*count + V]' is the value of 'bus' for vector 'V'.
+class Datapath
+{
+    public:
+    using Word = std::uint64_t;
+
+    struct Bus
+    {
+        std::string name;
+        int width;
+        Word Mask() const { return ((width >= 64)? ~Word{0} : ((Word{1} << width) - 1)); }
+    };
+
+    struct Boundary
+    {
+        int bus;
+        std::vector<Netlist::NetID> bits; // LSB first
+    };
+
+    std::vector<Bus> buses;
+    std::vector<WordBlock> blocks; // in evaluation-order after 'Levelize'
+    std::vector<Boundary> fromBits;
+    std::vector<Boundary> toBits;
+
+    int AddBus(std::string name, int width) { buses.push_back({name, width}); return int(buses.size())-1; }
+    // creates the block's output bus and returns it; comparisons are always 1 bit wide
+    int AddBlock(WordBlock::OpType T, int A, int B=-1, int S=-1);
+    void PackFrom(int bus, std::vector<Netlist::NetID> bits) { fromBits.push_back({bus, bits}); }
+    void UnpackTo(int bus, std::vector<Netlist::NetID> bits) { toBits.push_back({bus, bits}); }
+
+    bool Levelize(); // returns false on a loop between blocks
+    void Evaluate(Word* values, std::size_t count) const;
+    void Evaluate(std::vector<Word>& values) const { Evaluate(values.data(), 1); }
+    std::vector<Word> MakeValues(std::size_t count=1) const { return std::vector<Word>(buses.size()*count, 0); }
+
+    // boundary conversion against a bit-sliced netlist state (see 'Netlist::Evaluate');
+    // 'count' vectors are converted, 64 at a time through a bit-matrix transpose
+    void Gather(const Netlist::Word* netState, std::size_t stride, Word* values, std::size_t count) const;
+    void Scatter(const Word* values, std::size_t count, Netlist::Word* netState, std::size_t stride) const;
+};
+
+
+#endif
@@ -0,0 +1,351 @@
+#include "Distributed.hpp"
+#include "Logger.hpp"
+
+#include <array>
+#include <format>
+#include <random>
+#include <cstring>
+#include <algorithm>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+
+namespace {
+
+using NetID = Netlist::NetID;
+using Word  = Netlist::Word;
+
+// every message is a header, followed by 'nets x words' lane-words (net-major)
+struct MessageHeader
+{
+    enum Tag : std::uint32_t { Batch = 0x48435442, End = 0x444E4542, }; // "BTCH", "BEND"
+    std::uint32_t tag{Batch};
+    std::uint32_t nets{0};
+    std::uint64_t words{0};
+};
+
+
+// 'MSG_NOSIGNAL': a worker that died shows up as a failed call, not as SIGPIPE
+bool SendAll(int fd, const void* data, std::size_t size)
+{
+    const char* bytes {static_cast<const char*>(data)};
+    while (size > 0) {
+        const ssize_t sent {send(fd, bytes, size, MSG_NOSIGNAL)};
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent; size -= std::size_t(sent);
+    }
+    return true;
+}
+
+bool ReceiveAll(int fd, void* data, std::size_t size)
+{
+    char* bytes {static_cast<char*>(data)};
+    while (size > 0) {
+        const ssize_t received {recv(fd, bytes, size, 0)};
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false; // EOF or error
+        bytes += received; size -= std::size_t(received);
+    }
+    return true;
+}
+
+
+// one direction of the pipeline; returns false (with 'fds' untouched) on failure
+bool OpenLink(Transport transport, int fds[2]) // [0] writes, [1] reads
+{
+    if (transport == Transport::Unix) return (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == 0);
+
+    // loopback TCP: a throw-away listener on an ephemeral port; connecting completes through the backlog
+    const int listener {socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (listener < 0) return false;
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length {sizeof(address)};
+    int writer{-1}, reader{-1};
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+        && listen(listener, 1) == 0
+        && getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0
+        && (writer = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) >= 0
+        && connect(writer, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        reader = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    }
+    close(listener);
+    if (reader < 0) { if (writer >= 0) close(writer); return false; }
+
+    const int enable {1}; // batches are written in two parts (header, payload); don't let Nagle hold the second back
+    setsockopt(writer, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    fds[0] = writer; fds[1] = reader;
+    return true;
+}
+
+
+// runs in the forked child: receive a batch, evaluate this part, forward its outputs. Never returns.
+// (the child only inherited the calling thread, so it avoids the logger and anything else with shared state)
+[[noreturn]] void WorkerMain(const Netlist& part, int in, int out)
+{
+    std::vector<Word> state{}, payload{};
+    MessageHeader header{};
+    while (ReceiveAll(in, &header, sizeof(header)))
+    {
+        if (header.tag == MessageHeader::End) { SendAll(out, &header, sizeof(header)); _exit(0); }
+        if (header.tag != MessageHeader::Batch || header.nets != part.inputs.size()) break;
+
+        const std::size_t words {header.words};
+        if (state.size() != std::size_t(part.NetCount())*words) state = part.MakeState(words);
+        payload.resize(header.nets*words);
+        if (!ReceiveAll(in, payload.data(), payload.size()*sizeof(Word))) break;
+        for (std::size_t I{0}; I < part.inputs.size(); ++I) { std::copy_n(&payload[I*words], words, &state[part.inputs[I]*words]); }
+
+        part.Evaluate(state.data(), words, words);
+
+        header.nets = std::uint32_t(part.outputs.size());
+        payload.resize(part.outputs.size()*words);
+        for (std::size_t I{0}; I < part.outputs.size(); ++I) { std::copy_n(&state[part.outputs[I]*words], words, &payload[I*words]); }
+        if (!SendAll(out, &header, sizeof(header)) || !SendAll(out, payload.data(), payload.size()*sizeof(Word))) break;
+    }
+    _exit(1);
+}
+
+} // namespace
+
+
+std::string Partition::Report() const
+{
+    std::string text {std::format("partition: {} parts\n", parts.size())};
+    for (std::size_t P{0}; P < parts.size(); ++P) {
+        text += std::format("\tpart {}: {} gates, depth {}, {} nets in, {} nets out\n",
+            P, parts[P].gates.size(), parts[P].Depth(), cut[P].size(), cut[P+1].size());
+    }
+    return text;
+}
+
+
+Partition PartitionNetlist(const Netlist& netlist, int partCount, double tolerance)
+{
+    const NetID netCount {netlist.NetCount()};
+    std::vector<int> driver(netCount, -1);
+    for (std::size_t G{0}; G < netlist.gates.size(); ++G) { driver[netlist.gates[G].out] = int(G); }
+
+    // depth-first post-order from the outputs; gates reaching no output are left out.
+    // the explicit stack holds (gate, next fanin to visit); a fanin still on the stack is a loop
+    std::vector<int> order{};
+    std::vector<std::uint8_t> mark(netlist.gates.size(), 0); // 0: unvisited, 1: on stack, 2: done
+    std::vector<std::pair<int, int>> stack{};
+    for (NetID root: netlist.outputs) {
+        if (driver[root] < 0 || mark[driver[root]]) continue;
+        stack.emplace_back(driver[root], 0); mark[driver[root]] = 1;
+        while (!stack.empty()) {
+            auto& [G, K] {stack.back()};
+            const Netlist::Gate& gate {netlist.gates[G]};
+            if (K < (LogicGate::IsUnary(gate.type)? 1 : 2)) {
+                const int fanin {driver[(K++ == 0)? gate.A : gate.B]};
+                if (fanin < 0 || mark[fanin] == 2) continue;
+                if (mark[fanin] == 1) return {}; // combinational loop
+                mark[fanin] = 1; stack.emplace_back(fanin, 0);
+                continue;
+            }
+            mark[G] = 2; order.push_back(G);
+            stack.pop_back();
+        }
+    }
+
+    // net 'N' is live across boundary 'p' (between positions p-1 and p) if defined before 'p' and used at/after 'p'
+    const int gateCount {int(order.size())};
+    std::vector<int> defined(netCount, -1), lastUse(netCount, -1);
+    for (int P{0}; P < gateCount; ++P) {
+        const Netlist::Gate& gate {netlist.gates[order[P]]};
+        defined[gate.out] = P;
+        lastUse[gate.A] = P;
+        if (!LogicGate::IsUnary(gate.type)) lastUse[gate.B] = P;
+    }
+    for (NetID N: netlist.outputs) { lastUse[N] = gateCount; }
+    auto isLive = [&](NetID N, int P) { return (N != Netlist::CONST0) && (defined[N] < P) && (lastUse[N] >= P); };
+
+    std::vector<int> liveCount(gateCount+1, 0);
+    for (NetID N{1}; N < netCount; ++N) {
+        if (lastUse[N] <= defined[N]) continue;
+        ++liveCount[defined[N]+1];
+        if (lastUse[N]+1 <= gateCount) --liveCount[lastUse[N]+1];
+    }
+    for (int P{1}; P <= gateCount; ++P) { liveCount[P] += liveCount[P-1]; }
+
+    // each boundary goes to the smallest cut within 'tolerance' of its ideal position
+    partCount = std::clamp(partCount, 1, std::max(gateCount, 1));
+    std::vector<int> bound{0};
+    const double ideal {double(gateCount)/partCount};
+    for (int K{1}; K < partCount; ++K) {
+        const int target {int(K*ideal + 0.5)};
+        const int low  {std::max(bound.back()+1, int(target - tolerance*ideal))};
+        const int high {std::max(low, std::min(gateCount - (partCount-K), int(target + tolerance*ideal)))};
+        int best {low};
+        for (int P{low}; P <= high; ++P) {
+            if (liveCount[P] < liveCount[best] || (liveCount[P] == liveCount[best] && std::abs(P - target) < std::abs(best - target))) best = P;
+        }
+        bound.push_back(best);
+    }
+    bound.push_back(gateCount);
+
+    Partition partition{};
+    partition.cut.push_back(netlist.inputs);
+    for (int K{1}; K < partCount; ++K) {
+        std::vector<NetID>& live {partition.cut.emplace_back()};
+        for (NetID N{1}; N < netCount; ++N) { if (isLive(N, bound[K])) live.push_back(N); }
+    }
+    partition.cut.push_back(netlist.outputs);
+
+    std::vector<NetID> local(netCount, Netlist::CONST0);
+    for (int K{0}; K < partCount; ++K) {
+        Netlist& part {partition.parts.emplace_back()};
+        for (NetID N: partition.cut[K]) { local[N] = part.AddInput(); }
+        for (int P{bound[K]}; P < bound[K+1]; ++P) {
+            const Netlist::Gate& gate {netlist.gates[order[P]]};
+            local[gate.out] = part.AddGate(gate.type, local[gate.A], LogicGate::IsUnary(gate.type)? Netlist::CONST0 : local[gate.B]);
+        }
+        for (NetID N: partition.cut[K+1]) { part.MarkOutput(local[N]); }
+        part.Levelize();
+    }
+    return partition;
+}
+
+
+
+bool Cluster::Start(const Netlist& netlist, int workerCount, Transport T)
+{
+    Stop();
+    partition = PartitionNetlist(netlist, workerCount);
+    transport = T;
+    if (partition.parts.empty()) { Log::Error("cluster: can't partition a netlist with combinational loops"); return false; }
+    const std::size_t K {partition.parts.size()};
+
+    // link 'L' feeds worker 'L'; the last one returns to the coordinator
+    std::vector<std::array<int, 2>> links(K+1, {-1, -1});
+    auto closeAll = [&] { for (auto& link: links) { for (int& fd: link) { if (fd >= 0) close(fd); fd = -1; } } };
+    for (auto& link: links) {
+        if (!OpenLink(transport, link.data())) { Log::Error("cluster: failed to open a socket: {}", std::strerror(errno)); closeAll(); return false; }
+    }
+
+    for (std::size_t W{0}; W < K; ++W)
+    {
+        const pid_t pid {fork()};
+        if (pid < 0) { Log::Error("cluster: fork failed: {}", std::strerror(errno)); break; }
+        if (pid == 0) {
+            const int in {links[W][1]}, out {links[W+1][0]};
+            for (auto& link: links) { for (int fd: link) { if (fd != in && fd != out) close(fd); } }
+            WorkerMain(partition.parts[W], in, out);
+        }
+        workers.push_back(pid);
+    }
+
+    toFirst = links.front()[0]; fromLast = links.back()[1];
+    links.front()[0] = links.back()[1] = -1;
+    closeAll(); // the workers hold their own ends now
+    if (workers.size() != K) { Stop(); return false; }
+
+    Log::Info("cluster: {} workers over {} sockets", K, (transport == Transport::Unix)? "Unix-domain" : "TCP loopback");
+    return true;
+}
+
+
+void Cluster::Stop()
+{
+    if (toFirst >= 0) {
+        // the end-marker travels through every worker, so each one has finished its batches once it arrives
+        const MessageHeader end{MessageHeader::End, 0, 0};
+        SendAll(toFirst, &end, sizeof(end));
+        close(toFirst); toFirst = -1;
+    }
+    if (fromLast >= 0) {
+        MessageHeader header{};
+        while (ReceiveAll(fromLast, &header, sizeof(header)) && header.tag == MessageHeader::Batch) {
+            receiveBuffer.resize(header.nets*header.words);
+            if (!ReceiveAll(fromLast, receiveBuffer.data(), receiveBuffer.size()*sizeof(Word))) break;
+        }
+        close(fromLast); fromLast = -1;
+    }
+    for (pid_t pid: workers) {
+        int status{0};
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {;}
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) Log::Warning("cluster: worker {} exited abnormally (status {})", pid, status);
+    }
+    workers.clear();
+}
+
+
+bool Cluster::Submit(const Word* lanes, std::size_t stride, std::size_t words)
+{
+    if (toFirst < 0) return false;
+    const MessageHeader header{MessageHeader::Batch, std::uint32_t(InputCount()), words};
+    sendBuffer.resize(InputCount()*words);
+    for (std::size_t pin{0}; pin < InputCount(); ++pin) { std::copy_n(&lanes[pin*stride], words, &sendBuffer[pin*words]); }
+    if (!SendAll(toFirst, &header, sizeof(header)) || !SendAll(toFirst, sendBuffer.data(), sendBuffer.size()*sizeof(Word))) {
+        Log::Error("cluster: sending a batch failed: {}", std::strerror(errno));
+        return false;
+    }
+    ++batchesSent; wordsSent += sendBuffer.size();
+    return true;
+}
+
+
+bool Cluster::Collect(Word* lanes, std::size_t stride, std::size_t words)
+{
+    if (fromLast < 0) return false;
+    MessageHeader header{};
+    if (!ReceiveAll(fromLast, &header, sizeof(header)) || header.tag != MessageHeader::Batch
+        || header.nets != OutputCount() || header.words != words) {
+        Log::Error("cluster: a worker failed or sent an unexpected message");
+        return false;
+    }
+    receiveBuffer.resize(OutputCount()*words);
+    if (!ReceiveAll(fromLast, receiveBuffer.data(), receiveBuffer.size()*sizeof(Word))) { Log::Error("cluster: a batch was cut short"); return false; }
+    for (std::size_t pin{0}; pin < OutputCount(); ++pin) { std::copy_n(&receiveBuffer[pin*words], words, &lanes[pin*stride]); }
+    ++batchesReceived; wordsReceived += receiveBuffer.size();
+    return true;
+}
+
+
+bool Cluster::Evaluate(const Netlist& netlist, Word* state, std::size_t stride, std::size_t count)
+{
+    std::vector<Word> inputs(InputCount()*count), outputs(OutputCount()*count);
+    for (std::size_t pin{0}; pin < InputCount(); ++pin) { std::copy_n(&state[netlist.inputs[pin]*stride], count, &inputs[pin*count]); }
+    if (!Submit(inputs.data(), count, count) || !Collect(outputs.data(), count, count)) return false;
+    for (std::size_t pin{0}; pin < OutputCount(); ++pin) { std::copy_n(&outputs[pin*count], count, &state[netlist.outputs[pin]*stride]); }
+    return true;
+}
+
+
+std::string Cluster::Report() const
+{
+    std::size_t cutNets{0};
+    for (std::size_t B{1}; B+1 < partition.cut.size(); ++B) { cutNets += partition.cut[B].size(); }
+    const std::uint64_t wordsPerNet {InputCount()? wordsSent/InputCount() : 0}; // summed over batches
+    const std::uint64_t internalWords {wordsPerNet*cutNets};
+    return partition.Report() + std::format(
+        "cluster: {} batches over {} | sent {} KiB, received {} KiB, {} KiB between workers ({} cut nets)\n",
+        batchesReceived, (transport == Transport::Unix)? "Unix-domain sockets" : "TCP loopback",
+        wordsSent*sizeof(Word)/1024, wordsReceived*sizeof(Word)/1024, internalWords*sizeof(Word)/1024, cutNets);
+}
+
+
+bool SimulateEquivalent(const Netlist& netlist, Cluster& cluster, int rounds)
+{
+    if (netlist.inputs.size() != cluster.InputCount() || netlist.outputs.size() != cluster.OutputCount()) return false;
+
+    std::mt19937_64 random{0x5EED};
+    std::vector<Netlist::Word> expected {netlist.MakeState()}, actual {netlist.MakeState()};
+    for (int R{0}; R < rounds; ++R)
+    {
+        for (NetID N: netlist.inputs) { expected[N] = actual[N] = random(); }
+        netlist.Evaluate(expected);
+        if (!cluster.Evaluate(netlist, actual.data(), 1, 1)) return false;
+        for (NetID N: netlist.outputs) { if (expected[N] != actual[N]) return false; }
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef CIRCUITSIM_DISTRIBUTED_HPP
+#define CIRCUITSIM_DISTRIBUTED_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <sys/types.h>
+
+#include "Netlist.hpp"
+
+
+// the netlist's gates split into consecutive ranges of one topological order (depth-first from the outputs,
+// so cones stay together). Signals only flow forwards, so the parts form a pipeline and each boundary
+// carries exactly the nets that are live across it; boundaries are placed where that cut is smallest
+struct Partition
+{
+    std::vector<Netlist> parts; // part 'P' reads the nets of 'cut[P]' as its inputs and outputs those of 'cut[P+1]' (in order)
+    std::vector<std::vector<Netlist::NetID>> cut; // original nets at each boundary; the first/last are the global inputs/outputs
+
+    std::string Report() const;
+};
+
+// empty if the netlist has loops; 'tolerance' is how far (as a fraction of the ideal part-size) a boundary may move to shrink its cut
+Partition PartitionNetlist(const Netlist& netlist, int parts, double tolerance=0.25);
+
+
+enum class Transport { Unix, Tcp, }; // Unix-domain socket-pairs, or TCP over 127.0.0.1
+
+// coordinator for a pipeline of worker processes (forked, one per part), linked by sockets:
+//  coordinator -> worker 0 -> ... -> worker K-1 -> coordinator
+// Messages are batches of bit-sliced lanes (one word per 64 vectors) for every net crossing a link;
+// several batches can be in flight, so all workers are busy at once. Results match 'Netlist::Evaluate' exactly
+class Cluster
+{
+    public:
+    using Word = Netlist::Word;
+
+    bool Start(const Netlist& netlist, int workers, Transport transport); // false (and logs why) if it can't
+    void Stop(); // waits for the workers to exit
+
+    // pin-major lanes: word 'W' of input/output 'pin' is at lanes[pin*stride + W], for W < words.
+    // 'Submit' and 'Collect' may be called from two different threads; batches come back in submission-order
+    bool Submit(const Word* lanes, std::size_t stride, std::size_t words);
+    bool Collect(Word* lanes, std::size_t stride, std::size_t words);
+
+    // synchronous round-trip with the same contract as 'Netlist::Evaluate' (only output nets are written)
+    bool Evaluate(const Netlist& netlist, Word* state, std::size_t stride, std::size_t count);
+
+    std::size_t InputCount() const { return partition.cut.empty()? 0 : partition.cut.front().size(); }
+    std::size_t OutputCount() const { return partition.cut.empty()? 0 : partition.cut.back().size(); }
+    bool IsStarted() const { return !workers.empty(); }
+    std::string Report() const;
+
+    Cluster() = default;
+    Cluster(const Cluster&) = delete;
+    Cluster& operator=(const Cluster&) = delete;
+    ~Cluster() { Stop(); }
+
+    private:
+    Partition partition{};
+    Transport transport{Transport::Unix};
+    std::vector<pid_t> workers{};
+    int toFirst{-1}, fromLast{-1};
+    std::vector<Word> sendBuffer{}, receiveBuffer{};
+    std::uint64_t batchesSent{0}, wordsSent{0};         // 'Submit'-side
+    std::uint64_t batchesReceived{0}, wordsReceived{0}; // 'Collect'-side
+};
+
+// random-simulation check of the whole pipeline against single-process evaluation; 'rounds' x 64 vectors
+bool SimulateEquivalent(const Netlist& netlist, Cluster& cluster, int rounds=16);
+
+
+#endif
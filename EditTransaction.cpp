@@ -0,0 +1,140 @@
+#include "EditTransaction.hpp"
+#include "Timing.hpp"
+#include "TopoOrder.hpp"
+#include "Checkpoint.hpp"
+#include "Cones.hpp"
+
+#include <algorithm>
+
+
+EditTransaction::EditTransaction(std::vector<Component>& GI, ComponentMap& CM, std::vector<Component>& GO, EditObservers O)
+: globalInputs{GI}, components{CM}, globalOutput{GO}, observers{O}
+{
+    for (Component& component: globalInputs) { globalIO[component.UUID()] = &component; }
+    for (Component& component: globalOutput) { globalIO[component.UUID()] = &component; }
+}
+
+
+Component* EditTransaction::Find(const std::string& componentUUID)
+{
+    if (Component* found = components.Find(componentUUID)) return found;
+    auto search = globalIO.find(componentUUID);
+    return ((search == globalIO.end())? nullptr : search->second);
+}
+
+
+void EditTransaction::DetachFanout(Component& component)
+{
+    for (auto& [pinUUID, wire]: component.wires) {
+        Component* target {FindPinOwner(pinUUID)};
+        if (!target) continue;
+        target->incoming.erase(pinUUID); // otherwise 'Netlist::Extract' would still see this connection
+        touched.push_back(target);
+        if (observers.order) observers.order->Disconnect(&component, target);
+    }
+}
+
+
+bool EditTransaction::Connect(Component& source, Component& target, Pin* targetPin, int output, std::vector<Component*>* cycle)
+{
+    if (!targetPin || output < 0 || std::size_t(output) >= source.GetOutputCount()) return true;
+    if (&source == &target) { if (cycle) *cycle = {&source}; return false; } // refused outright, as before
+    if (auto search = target.incoming.find(targetPin->UUID); search != target.incoming.end()) {
+        touched.push_back(search->second); // the replaced source loses a wire
+        if (observers.order) observers.order->Disconnect(search->second, &target);
+    }
+    source.CreateConnection(&target, targetPin, output);
+    touched.push_back(&source);
+    touched.push_back(&target);
+    return (observers.order? observers.order->Connect(&source, &target, cycle) : true);
+}
+
+
+void EditTransaction::Disconnect(Component& component)
+{
+    for (auto [pinUUID, source]: component.incoming) {
+        touched.push_back(source);
+        if (observers.order) observers.order->Disconnect(source, &component);
+    }
+    DetachFanout(component);
+    component.RemoveAllConnections();
+    touched.push_back(&component);
+}
+
+
+void EditTransaction::Delete(Component& component)
+{
+    if (component.isGlobalIn || component.isGlobalOut) return; // fixed for the lifetime of the canvas
+    for (auto [pinUUID, source]: component.incoming) { touched.push_back(source); }
+    DetachFanout(component);
+    component.RemoveAllConnections();
+    if (observers.order) observers.order->Remove(&component); // and its incoming connections with it
+    deleted.insert(&component);
+}
+
+
+Component& EditTransaction::Insert(LogicGate::OpType T, const sf::Sprite& S)
+{
+    Component& component {components.Push(T, S)};
+    touched.push_back(&component);
+    return component;
+}
+
+
+std::size_t EditTransaction::Commit()
+{
+    // fanout-cone of every touched component
+    std::vector<Component*> cone{};
+    std::unordered_map<Component*, int> pending{}; // cone-membership; for Kahn's, fanin from within the cone not yet evaluated
+    for (Component* component: touched) {
+        if (deleted.contains(component) || pending.contains(component)) continue;
+        pending[component] = 0; cone.push_back(component);
+    }
+    const std::size_t touchedCount {cone.size()}; // every component whose 'incoming' changed is among these
+    for (std::size_t I{0}; I < cone.size(); ++I) {
+        for (auto& [pinUUID, wire]: cone[I]->wires) {
+            Component* target {FindPinOwner(pinUUID)};
+            if (target && pending.try_emplace(target, 0).second) cone.push_back(target);
+        }
+    }
+
+    std::vector<Component*> order{}; order.reserve(cone.size());
+    if (observers.order) { order = cone; observers.order->Sort(order); } // kept current connection by connection
+    else {
+        // Kahn's algorithm over the cone; components on a loop are evaluated last, in discovery-order
+        for (Component* component: cone) {
+            for (auto [pinUUID, source]: component->incoming) { if (pending.contains(source)) ++pending[component]; }
+        }
+        for (Component* component: cone) { if (pending[component] == 0) order.push_back(component); }
+        for (std::size_t I{0}; I < order.size(); ++I) {
+            for (auto& [pinUUID, wire]: order[I]->wires) {
+                Component* target {FindPinOwner(pinUUID)};
+                if (target && pending.contains(target) && (--pending[target] == 0)) order.push_back(target);
+            }
+        }
+        if (order.size() < cone.size()) {
+            for (Component* component: cone) { if (pending[component] > 0) order.push_back(component); }
+        }
+    }
+
+    for (Component* component: order) {
+        const unsigned oldState {component->ReadOutputs()};
+        component->PropagateLogic();
+        if (observers.checkpoints && component->ReadOutputs() != oldState) observers.checkpoints->Touch(component);
+        for (auto& [pinUUID, wire]: component->wires) { wire.PropagateState(); } // new wires, even if the state didn't change
+        component->Update(); // inactive components aren't re-textured by 'PropagateLogic'
+    }
+
+    if (touchedCount > 0 || !deleted.empty()) {
+        const std::vector<Component*> changed {cone.begin(), cone.begin() + touchedCount}, removed {deleted.begin(), deleted.end()};
+        if (observers.timing) observers.timing->Update(changed, removed);
+        if (observers.cones) observers.cones->Update(changed, removed);
+    }
+    if (observers.checkpoints) {
+        for (std::size_t I{0}; I < touchedCount; ++I) { observers.checkpoints->Touch(cone[I]); }
+        for (Component* component: deleted) { observers.checkpoints->Forget(component); }
+    }
+    for (Component* component: deleted) { components.Remove(*component); }
+    touched.clear(); deleted.clear();
+    return order.size();
+}
@@ -0,0 +1,69 @@
+#ifndef CIRCUITSIM_EDITTRANSACTION_HPP
+#define CIRCUITSIM_EDITTRANSACTION_HPP
+
+#include <vector>
+#include <string>
+#include <unordered_set>
+#include <unordered_map>
+
+#include <SFML/Graphics/Sprite.hpp>
+
+#include "Interactives.hpp"
+#include "ComponentMap.hpp"
+
+class TimingGraph;
+class ComponentOrder;
+class Checkpointer;
+class ConeIndex;
+
+// optional structures kept up to date by every transaction
+struct EditObservers
+{
+    TimingGraph* timing{nullptr};   // told about every changed connection on 'Commit'
+    ComponentOrder* order{nullptr}; // told about each connection as it's made/removed; orders the repropagation
+    Checkpointer* checkpoints{nullptr}; // told which components were rewired, changed state or were deleted on 'Commit'
+    ConeIndex* cones{nullptr};          // told about every changed connection on 'Commit'
+};
+
+
+// batches graph edits on the canvas; 'Commit' then repropagates and recolors only the union of the
+// fanout-cones of everything touched, once, in topological order (instead of sweeping every component per edit);
+// that order comes from the 'ComponentOrder' observer if there is one, otherwise it's sorted per commit.
+// Deleted components stay allocated until 'Commit', so pointers held during the transaction remain valid.
+// Fanout is found through the target-pin UUIDs that key each 'wires' map ('Pin::parent' can't be trusted
+// after a component has been copied into the 'ComponentMap')
+class EditTransaction
+{
+    std::vector<Component>& globalInputs;
+    ComponentMap& components;
+    std::vector<Component>& globalOutput;
+    std::unordered_map<std::string, Component*> globalIO{}; // UUID lookup for components outside of the map
+    EditObservers observers;
+
+    std::vector<Component*> touched{};
+    std::unordered_set<Component*> deleted{};
+
+    Component* Find(const std::string& componentUUID);
+    Component* FindPinOwner(const std::string& pinUUID) { return Find(pinUUID.substr(0, pinUUID.rfind('#'))); }
+    void DetachFanout(Component& component); // marks the fanout as touched and removes its stale 'incoming' entries
+
+    public:
+    std::size_t EditCount() const { return touched.size() + deleted.size(); }
+
+    // 'source' output-pin ('output', for cells) -> 'targetPin' (of 'target'); replaces any existing connection to that pin.
+    // with an 'order' observer, returns false if the connection closes a combinational loop (it's made anyway)
+    // and 'cycle' receives the loop's components, starting at 'target'. Connecting a component to itself is refused
+    bool Connect(Component& source, Component& target, Pin* targetPin, int output=0, std::vector<Component*>* cycle=nullptr);
+    void Disconnect(Component& component); // every incoming and outgoing connection
+    void Delete(Component& component);     // disconnects now; removed from the 'ComponentMap' on 'Commit'
+    Component& Insert(LogicGate::OpType T, const sf::Sprite& S);
+
+    // returns the number of components that were repropagated
+    std::size_t Commit();
+
+    EditTransaction(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput, EditObservers observers={});
+    ~EditTransaction() { Commit(); } // no-op if already committed
+};
+
+
+#endif
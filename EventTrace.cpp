@@ -0,0 +1,165 @@
+#include "EventTrace.hpp"
+
+#include <format>
+#include <cstring>
+#include <algorithm>
+
+
+namespace {
+
+constexpr char magic[8] {'C','S','T','R','A','C','E','1'};
+
+std::string EventName(int type)
+{
+    switch (type) {
+        case sf::Event::Closed:              return "Closed";
+        case sf::Event::Resized:             return "Resized";
+        case sf::Event::LostFocus:           return "LostFocus";
+        case sf::Event::GainedFocus:         return "GainedFocus";
+        case sf::Event::TextEntered:         return "TextEntered";
+        case sf::Event::KeyPressed:          return "KeyPressed";
+        case sf::Event::KeyReleased:         return "KeyReleased";
+        case sf::Event::MouseWheelScrolled:  return "MouseWheelScrolled";
+        case sf::Event::MouseButtonPressed:  return "MouseButtonPressed";
+        case sf::Event::MouseButtonReleased: return "MouseButtonReleased";
+        case sf::Event::MouseMoved:          return "MouseMoved";
+        case sf::Event::MouseEntered:        return "MouseEntered";
+        case sf::Event::MouseLeft:           return "MouseLeft";
+        default:                             return std::format("event #{}", type);
+    }
+}
+
+// nearest-rank percentile of an already sorted vector
+float Percentile(const std::vector<float>& sorted, float P)
+{
+    const std::size_t rank {std::size_t(P*float(sorted.size()-1) + 0.5f)};
+    return sorted[std::min(rank, sorted.size()-1)];
+}
+
+std::string Histogram(const std::string& label, std::vector<float> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    return std::format("  {:<20} {:>7} | p50 {:>9.1f}us | p99 {:>9.1f}us | max {:>9.1f}us\n",
+        label, samples.size(), Percentile(samples, 0.50f), Percentile(samples, 0.99f), samples.back());
+}
+
+} // namespace
+
+
+bool EventTrace::Open(Mode M, const std::string& path)
+{
+    mode = M;
+    if (mode == Mode::Off) return true;
+
+    const std::uint32_t eventSize {sizeof(sf::Event)};
+    if (mode == Mode::Record) {
+        file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(magic, sizeof(magic));
+        file.write(reinterpret_cast<const char*>(&eventSize), sizeof(eventSize));
+    } else {
+        file.open(path, std::ios::in | std::ios::binary);
+        char header[sizeof(magic)]{}; std::uint32_t size{0};
+        file.read(header, sizeof(header));
+        file.read(reinterpret_cast<char*>(&size), sizeof(size));
+        if (file && (std::memcmp(header, magic, sizeof(magic)) != 0 || size != eventSize)) {
+            file.setstate(std::ios::failbit); // from another build (or not a trace at all)
+        }
+    }
+    if (!file) { mode = Mode::Off; return false; }
+    frameStart = Clock::now();
+    return true;
+}
+
+
+EventTrace::~EventTrace() { if (mode == Mode::Record) file.flush(); }
+
+
+void EventTrace::FinishEvent()
+{
+    if (pendingType < 0) return;
+    const std::chrono::duration<float, std::micro> elapsed {Clock::now() - eventStart};
+    latency[pendingType].push_back(elapsed.count());
+    pendingType = -1;
+}
+
+
+bool EventTrace::Expect(Tag tag)
+{
+    if (isFinished) return false;
+    std::uint8_t next{0};
+    if (!file.read(reinterpret_cast<char*>(&next), 1) || (next != tag)) { isFinished = true; return false; }
+    return true;
+}
+
+
+bool EventTrace::PollEvent(sf::Window& window, sf::Event& event)
+{
+    FinishEvent();
+    bool hasEvent{false};
+    if (mode == Mode::Replay) {
+        sf::Event live;
+        while (window.pollEvent(live)) { ; } // keeping the OS happy; the trace stands in for these
+        if (!isFinished && (file.peek() == EVENT)) { // anything else belongs to the rest of the frame
+            file.get();
+            hasEvent = bool(file.read(reinterpret_cast<char*>(&event), sizeof(event)));
+            if (!hasEvent) isFinished = true;
+        }
+    } else {
+        hasEvent = window.pollEvent(event);
+        if (hasEvent && mode == Mode::Record) {
+            file.put(char(EVENT));
+            file.write(reinterpret_cast<const char*>(&event), sizeof(event));
+        }
+    }
+
+    if (hasEvent) { pendingType = int(event.type); eventStart = Clock::now(); }
+    return hasEvent;
+}
+
+
+void EventTrace::EndFrame()
+{
+    FinishEvent();
+    if (mode == Mode::Record) file.put(char(FRAME));
+    if (mode == Mode::Replay && Expect(FRAME) && (file.peek() == std::char_traits<char>::eof())) isFinished = true;
+    const Clock::time_point now {Clock::now()};
+    if (mode != Mode::Off) frameTimes.push_back(std::chrono::duration<float, std::micro>(now - frameStart).count());
+    frameStart = now;
+}
+
+
+std::int32_t EventTrace::Sample(std::int32_t value)
+{
+    if (mode == Mode::Record) {
+        file.put(char(SAMPLE));
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    } else if (mode == Mode::Replay && Expect(SAMPLE)) {
+        if (!file.read(reinterpret_cast<char*>(&value), sizeof(value))) isFinished = true;
+    }
+    return value;
+}
+
+
+sf::Vector2i EventTrace::MousePosition(const sf::Window& window)
+{
+    const sf::Vector2i live {(mode == Mode::Replay)? sf::Vector2i{} : sf::Mouse::getPosition(window)};
+    const int X {Sample(live.x)};
+    return {X, Sample(live.y)};
+}
+
+
+bool EventTrace::IsButtonPressed(sf::Mouse::Button button)
+{
+    return Sample((mode == Mode::Replay)? 0 : sf::Mouse::isButtonPressed(button));
+}
+
+
+std::string EventTrace::Report() const
+{
+    std::string report {"EVENT TRACE (handling time per event)\n"};
+    for (int T{0}; T < sf::Event::Count; ++T) {
+        if (!latency[T].empty()) report += Histogram(EventName(T), latency[T]);
+    }
+    if (!frameTimes.empty()) report += Histogram("(frames)", frameTimes);
+    return report;
+}
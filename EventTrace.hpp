@@ -0,0 +1,60 @@
+#ifndef CIRCUITSIM_EVENTTRACE_HPP
+#define CIRCUITSIM_EVENTTRACE_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <chrono>
+
+#include <SFML/Window.hpp>
+
+
+// records the main-window's input (events, and every mouse/state sample the main-loop takes) to a file,
+// and feeds it back frame-by-frame for a deterministic replay, timing how long each event took to handle.
+// The main-loop must call 'PollEvent' until it returns false, then 'EndFrame', every frame.
+// Trace-files are tied to this build's 'sf::Event' layout (checked in the header)
+class EventTrace
+{
+    public:
+    enum class Mode { Off, Record, Replay, };
+
+    bool Open(Mode mode, const std::string& path); // returns false on failure
+    Mode GetMode() const { return mode; }
+    bool IsReplaying() const { return (mode == Mode::Replay); }
+    bool IsFinished() const { return isFinished; } // replay reached the end of the trace (or lost sync)
+
+    // replaces 'window.pollEvent'; while replaying, live events are drained and discarded
+    bool PollEvent(sf::Window& window, sf::Event& event);
+    void EndFrame();
+
+    // replace direct queries of live state; recorded as-is, or returned from the trace while replaying
+    sf::Vector2i MousePosition(const sf::Window& window);
+    bool IsButtonPressed(sf::Mouse::Button button);
+    std::int32_t Sample(std::int32_t liveValue);
+
+    // per event-type handling-time percentiles, and frame-times
+    std::string Report() const;
+
+    ~EventTrace();
+
+    private:
+    enum Tag: std::uint8_t { EVENT, SAMPLE, FRAME, };
+    using Clock = std::chrono::steady_clock;
+
+    Mode mode{Mode::Off};
+    bool isFinished{false};
+    std::fstream file{};
+
+    std::array<std::vector<float>, sf::Event::Count> latency{}; // microseconds, per event-type
+    std::vector<float> frameTimes{};
+    int pendingType{-1}; // event being handled since 'eventStart'
+    Clock::time_point eventStart{}, frameStart{Clock::now()};
+    void FinishEvent();
+
+    bool Expect(Tag tag); // replay: consumes 'tag', or marks the trace finished on a mismatch
+};
+
+
+#endif
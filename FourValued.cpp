@@ -0,0 +1,159 @@
+#include "FourValued.hpp"
+#include "Datapath.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+
+char ToChar(Logic4 L)
+{
+    constexpr char names[] {"01XZ"};
+    return names[std::uint8_t(L) & 0b11];
+}
+
+
+bool FromChar(char C, Logic4& L)
+{
+    switch(C) {
+        case '0': L = Logic4::Zero; return true;
+        case '1': L = Logic4::One;  return true;
+        case 'X': case 'x': L = Logic4::X; return true;
+        case 'Z': case 'z': L = Logic4::Z; return true;
+        default: return false;
+    }
+}
+
+
+FourValuedNetlist::FourValuedNetlist(Netlist source): netlist{std::move(source)}
+{
+    if (!netlist.IsLevelized()) netlist.Levelize();
+
+    std::vector<bool> isDriven(netlist.NetCount(), false);
+    isDriven[Netlist::CONST0] = true;
+    for (NetID N: netlist.inputs) { isDriven[N] = true; }
+    for (const Netlist::Gate& gate: netlist.gates) { isDriven[gate.out] = true; }
+    if (netlist.datapath) {
+        for (const Datapath::Boundary& boundary: netlist.datapath->toBits) { for (NetID N: boundary.bits) isDriven[N] = true; }
+    }
+    for (NetID N{0}; N < netlist.NetCount(); ++N) { if (!isDriven[N]) undriven.push_back(N); }
+    for (const Netlist::Gate& gate: netlist.gates) {
+        undrivenReads += !isDriven[gate.A];
+        if (!LogicGate::IsUnary(gate.type)) undrivenReads += !isDriven[gate.B];
+    }
+
+    for (NetID N: netlist.inputs)  { inputs.push_back(ValuePlane(N)); }
+    for (NetID N: netlist.inputs)  { inputs.push_back(UnknownPlane(N)); }
+    for (NetID N: netlist.outputs) { outputs.push_back(ValuePlane(N)); }
+    for (NetID N: netlist.outputs) { outputs.push_back(UnknownPlane(N)); }
+}
+
+
+std::vector<FourValuedNetlist::Word> FourValuedNetlist::MakeState(std::size_t stride) const
+{
+    std::vector<Word> state(2*std::size_t(netlist.NetCount())*stride, 0);
+    for (NetID N{1}; N < netlist.NetCount(); ++N) {
+        std::fill_n(&state[UnknownPlane(N)*stride], stride, ~Word{0});
+    }
+    for (NetID N: undriven) { std::fill_n(&state[ValuePlane(N)*stride], stride, ~Word{0}); }
+    return state;
+}
+
+
+void FourValuedNetlist::EvaluateGate(const Netlist::Gate& gate, Word* state, std::size_t stride, std::size_t count)
+{
+    Word* outValue   {state + ValuePlane(gate.out)*stride};
+    Word* outUnknown {state + UnknownPlane(gate.out)*stride};
+    const Word* AV {state + ValuePlane(gate.A)*stride};
+    const Word* AU {state + UnknownPlane(gate.A)*stride};
+    const Word* BV {state + ValuePlane(gate.B)*stride};
+    const Word* BU {state + UnknownPlane(gate.B)*stride};
+
+    // dispatching once per gate, with the type as a constant so 'EvalPlanes' folds down to the gate's own ops
+    auto kernel = [&](auto type) {
+        for (std::size_t W{0}; W < count; ++W) {
+            const auto [one, zero] = EvalPlanes(type, AV[W] & ~AU[W], ~(AV[W] | AU[W]), BV[W] & ~BU[W], ~(BV[W] | BU[W]));
+            outValue[W] = one;
+            outUnknown[W] = ~(one | zero);
+        }
+    };
+    #define CASE_KERNEL(T) case LogicGate::T: kernel(std::integral_constant<LogicGate::OpType, LogicGate::T>{}); break;
+    switch(gate.type) {
+        CASE_KERNEL(EQ)  CASE_KERNEL(NOT)
+        CASE_KERNEL(OR)  CASE_KERNEL(NOR)
+        CASE_KERNEL(AND) CASE_KERNEL(NAND)
+        CASE_KERNEL(XOR) CASE_KERNEL(XNOR)
+        default: kernel(LogicGate::LAST_ENUM); break;
+    }
+    #undef CASE_KERNEL
+    return;
+}
+
+
+void FourValuedNetlist::Evaluate(Word* state, std::size_t stride, std::size_t count) const
+{
+    // nets known in every lane skip their unknown-plane: a gate reading only known nets is the two-valued gate over
+    // the value-planes, which halves the state it reads. 'Z' (undriven) is never known
+    std::vector<bool> isKnown(netlist.NetCount(), false);
+    isKnown[Netlist::CONST0] = true;
+    auto check = [&](NetID N) {
+        const Word* unknown {state + UnknownPlane(N)*stride};
+        isKnown[N] = std::none_of(unknown, unknown + count, [](Word W) { return W != 0; });
+    };
+    for (NetID N: netlist.inputs) { check(N); }
+    if (netlist.datapath) {
+        EvaluateWords(state, stride, count);
+        for (const Datapath::Boundary& boundary: netlist.datapath->toBits) { for (NetID N: boundary.bits) check(N); }
+    }
+
+    for (const Netlist::Gate& gate: netlist.gates) {
+        if (!isKnown[gate.A] || (!LogicGate::IsUnary(gate.type) && !isKnown[gate.B])) { EvaluateGate(gate, state, stride, count); continue; }
+        Netlist::EvaluateGate({gate.type, ValuePlane(gate.A), ValuePlane(gate.B), ValuePlane(gate.out)}, state, stride, count);
+        std::fill_n(state + UnknownPlane(gate.out)*stride, count, Word{0});
+        isKnown[gate.out] = true;
+    }
+    return;
+}
+
+
+void FourValuedNetlist::EvaluateWords(Word* state, std::size_t stride, std::size_t count) const
+{
+    // the value-planes and the unknown-planes are each laid out like a two-valued state with twice the stride.
+    // A bus is unknown for a vector when any bit it was packed from is (X or Z), and a block's output when any operand is
+    const Datapath& datapath {*netlist.datapath};
+    const std::size_t vectors {count*64};
+    std::vector<Datapath::Word> values {datapath.MakeValues(vectors)}, unknown {datapath.MakeValues(vectors)};
+    datapath.Gather(state, 2*stride, values.data(), vectors);
+    datapath.Gather(state + stride, 2*stride, unknown.data(), vectors);
+    datapath.Evaluate(values.data(), vectors);
+    for (const WordBlock& block: datapath.blocks) {
+        for (std::size_t V{0}; V < vectors; ++V) {
+            const bool isUnknown {(unknown[block.A*vectors + V] != 0)
+                || (block.B >= 0 && unknown[block.B*vectors + V] != 0) || (block.S >= 0 && unknown[block.S*vectors + V] != 0)};
+            unknown[block.out*vectors + V] = (isUnknown? ~Datapath::Word{0} : 0);
+        }
+    }
+    for (std::size_t I{0}; I < values.size(); ++I) { values[I] &= ~unknown[I]; } // unknown bits are written as X
+    datapath.Scatter(values.data(), vectors, state, 2*stride);
+    datapath.Scatter(unknown.data(), vectors, state + stride, 2*stride);
+    return;
+}
+
+
+Logic4 FourValuedNetlist::Read(const Word* state, std::size_t stride, NetID N, std::size_t lane)
+{
+    const std::size_t W {lane/64}, bit {lane%64};
+    const unsigned value   {unsigned(state[ValuePlane(N)*stride + W] >> bit) & 1};
+    const unsigned unknown {unsigned(state[UnknownPlane(N)*stride + W] >> bit) & 1};
+    return Logic4((unknown << 1) | value);
+}
+
+
+void FourValuedNetlist::Write(Word* state, std::size_t stride, NetID N, std::size_t lane, Logic4 L)
+{
+    const std::size_t W {lane/64};
+    const Word mask {Word{1} << (lane%64)};
+    Word& value   {state[ValuePlane(N)*stride + W]};
+    Word& unknown {state[UnknownPlane(N)*stride + W]};
+    value   = ((std::uint8_t(L) & 0b01)? (value | mask) : (value & ~mask));
+    unknown = ((std::uint8_t(L) & 0b10)? (unknown | mask) : (unknown & ~mask));
+}
@@ -0,0 +1,74 @@
+#ifndef CIRCUITSIM_FOURVALUED_HPP
+#define CIRCUITSIM_FOURVALUED_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+#include "Netlist.hpp"
+
+
+// single-lane four-valued logic; the bits are (unknown << 1) | value, matching the bit-planes below
+enum class Logic4: std::uint8_t { Zero = 0b00, One = 0b01, X = 0b10, Z = 0b11 };
+
+char ToChar(Logic4 L);         // '0', '1', 'X' or 'Z'
+bool FromChar(char C, Logic4& L); // also accepts lowercase 'x'/'z'; false for anything else
+
+
+// evaluates a 'Netlist' over 0/1/X/Z. Every net is stored as two bit-planes (value, unknown) instead of one,
+// so gates stay branchless and 64 lanes wide: 0 = (0,0), 1 = (1,0), X = (0,1), Z = (1,1).
+// Gates read Z as X and never drive Z; a controlling input (0 for AND/NAND, 1 for OR/NOR) still decides
+// the output when the other input is unknown, while XOR/XNOR and buffers pass any unknown through.
+// Nets nothing drives (see 'Netlist::Undriven::Floating') are Z, and everything starts out as X.
+class FourValuedNetlist
+{
+    public:
+    using NetID = Netlist::NetID;
+    using Word  = Netlist::Word;
+
+    // state is laid out like a 'Netlist' state over twice as many nets: net 'N' has its value-plane
+    // at plane 2N and its unknown-plane at plane 2N+1, word 'w' of plane 'P' being state[P*stride + w]
+    static constexpr NetID ValuePlane(NetID N)   { return 2*N; }
+    static constexpr NetID UnknownPlane(NetID N) { return 2*N + 1; }
+
+    // plane-indices of every pin's value-plane, followed by every pin's unknown-plane; this is what lets
+    // a four-valued circuit stand in for a two-valued one with twice the pins (see 'RunVectorStream')
+    std::vector<NetID> inputs;
+    std::vector<NetID> outputs;
+
+    const Netlist& Source() const { return netlist; }
+    std::size_t UndrivenReads() const { return undrivenReads; } // gate-inputs reading a net that nothing drives
+
+    std::vector<Word> MakeState(std::size_t stride=1) const; // 'CONST0' is 0, undriven nets are Z, everything else X
+    void Evaluate(Word* state, std::size_t stride, std::size_t count) const;
+    void Evaluate(std::vector<Word>& state) const { Evaluate(state.data(), 1, 1); }
+    static void EvaluateGate(const Netlist::Gate& gate, Word* state, std::size_t stride, std::size_t count);
+
+    // word-parallel gate function over (known-one, known-zero) masks; lanes in neither are unknown
+    static std::pair<Word, Word> EvalPlanes(LogicGate::OpType T, Word A1, Word A0, Word B1, Word B0) {
+        using enum LogicGate::OpType;
+        switch(T) {
+            case  EQ: return {A1, A0};            case  NOT: return {A0, A1}; // 'B' is ignored for unary ops
+            case  OR: return {A1 | B1, A0 & B0};  case  NOR: return {A0 & B0, A1 | B1};
+            case AND: return {A1 & B1, A0 | B0};  case NAND: return {A0 | B0, A1 & B1};
+            case  XOR: return {(A1 & B0) | (A0 & B1), (A1 & B1) | (A0 & B0)};
+            case XNOR: return {(A1 & B1) | (A0 & B0), (A1 & B0) | (A0 & B1)};
+            default: return {0, ~Word{0}};
+        }
+    }
+
+    static Logic4 Read(const Word* state, std::size_t stride, NetID N, std::size_t lane);
+    static void Write(Word* state, std::size_t stride, NetID N, std::size_t lane, Logic4 L);
+
+    explicit FourValuedNetlist(Netlist source);
+
+    private:
+    void EvaluateWords(Word* state, std::size_t stride, std::size_t count) const; // 'Netlist::EvaluateWords', per plane
+    Netlist netlist;
+    std::vector<NetID> undriven{};
+    std::size_t undrivenReads{0};
+};
+
+
+#endif
@@ -1,13 +1,20 @@
 #include "Interactives.hpp"
+#include "Logger.hpp"
+#include "StaticNetlist.hpp" // 'CellBlocks'
 
 #include <iostream>
 #include <cassert>
 #include <format>
+#include <algorithm>
+#include <mutex>
 
 
 // static members
 bool Pin::displayHitboxes{true};
 bool Pin::hideConnectedHitboxes{true};
+std::vector<Component*> Component::changed{};
+std::vector<const Component*> Component::removed{};
+static std::mutex cacheQueueMutex; // guards 'Component::changed' and 'Component::removed'
 
 
 void Wire::LinkTo(Pin* pin)
@@ -19,8 +26,8 @@ void Wire::LinkTo(Pin* pin)
     const sf::Vector2f halfDist {dist/2.f};
     constexpr float halfThick {thickness/2.f};
     const float extraLength {(dist.y > 0.f)? thickness : -thickness}; // adjustment must be relative to y-direction
-    const float hoffset{ (7.f * (1-pin->index)) + (((dist.x > 0.f)!=(dist.y > 0.f))? 2.f : -2.f) };
-    // offset by target pin, and an additional directionally-based offset to avoid overlaps between wires going opposite directions
+    const float hoffset{ (7.f * (1-pin->index)) - (6.f * source.index) + (((dist.x > 0.f)!=(dist.y > 0.f))? 2.f : -2.f) };
+    // offset by target pin (and by source pin, for cells' outputs), and an additional directionally-based offset to avoid overlaps between wires going opposite directions
     
     // if distance is primarily vertical, split the distance into two vertical components and one horizontal
     // also use vertical layout for backwards connections, to prevent the wires from cutting across the gates and linking from the wrong side.
@@ -69,6 +76,24 @@ void Wire::LinkTo(Pin* pin)
 }
 
 
+// smallest rectangle containing both
+static sf::FloatRect Union(const sf::FloatRect& A, const sf::FloatRect& B)
+{
+    const float left {std::min(A.left, B.left)}, top {std::min(A.top, B.top)};
+    const float right {std::max(A.left+A.width, B.left+B.width)}, bottom {std::max(A.top+A.height, B.top+B.height)};
+    return sf::FloatRect(left, top, right-left, bottom-top);
+}
+
+
+sf::FloatRect Wire::GetBounds() const
+{
+    if (lines.empty()) return sf::FloatRect(source.getPosition(), {0.f, 0.f});
+    sf::FloatRect bounds {lines[0].getGlobalBounds()};
+    for (const sf::RectangleShape& line: lines) { bounds = Union(bounds, line.getGlobalBounds()); }
+    return bounds;
+}
+
+
 std::string PrintPin(const Pin& pin)
 {
     std::string info = std::format(
@@ -83,20 +108,17 @@ std::string PrintPin(const Pin& pin)
 
 void Component::PrintConnections()
 {
-    std::cout << UUID();
-    if(isGlobalIn) std::cout  << " (GLOBAL-INPUT)";
-    if(isGlobalOut) std::cout << " (GLOBAL-OUTPUT)";
-    std::cout << '\n';
-    std::cout << "Connected input pins: \n";
+    Log::Debug("{}{}{}", UUID(), (isGlobalIn? " (GLOBAL-INPUT)" : ""), (isGlobalOut? " (GLOBAL-OUTPUT)" : ""));
+    Log::Debug("Connected input pins: ");
     for(const Pin& pin: inputs) { 
         if(!pin.isConnected) continue;
-        std::cout << PrintPin(pin);
+        Log::Debug("{}", PrintPin(pin));
     }
     
-    std::cout << "\nConnected output pins: \n";
+    Log::Debug("Connected output pins: ");
     for(const Pin& pin: outputs) { 
         if(!pin.isConnected) continue;
-        std::cout << PrintPin(pin);
+        Log::Debug("{}", PrintPin(pin));
     }
     
     // TODO: print incoming and wires
@@ -104,8 +126,80 @@ void Component::PrintConnections()
 
 
 
+std::size_t Component::VisualSignature() const
+{
+    std::size_t hash{0};
+    auto combine = [&hash](std::size_t value) { hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2); };
+    
+    const auto [X, Y] = sprite.getPosition();
+    combine(std::hash<float>{}(X)); combine(std::hash<float>{}(Y));
+    combine(gate.state); combine(incoming.empty()); combine(isGlobalIn);
+    for (const Pin& pin: inputs ) { combine(pin.state); combine(pin.isConnected); }
+    for (const Pin& pin: outputs) { combine(pin.state); combine(pin.isConnected); combine(pin.getFillColor().toInteger()); }
+    for (const auto& [key, wire]: wires) { combine(std::hash<const Pin*>{}(wire.drain)); }
+    combine(wires.size());
+    return hash;
+}
+
+
+sf::FloatRect Component::GetDrawBounds() const
+{
+    sf::FloatRect bounds {sprite.getGlobalBounds()};
+    for (const Pin& pin: inputs ) { bounds = Union(bounds, pin.getGlobalBounds()); }
+    for (const Pin& pin: outputs) { bounds = Union(bounds, pin.getGlobalBounds()); }
+    for (const auto& lead: leads) { bounds = Union(bounds, lead.getGlobalBounds()); }
+    for (const auto& [key, wire]: wires) { bounds = Union(bounds, wire.GetBounds()); }
+    return bounds;
+}
+
+
+void Component::CountDrawCalls(DrawStats& stats) const
+{
+    auto countPin = [&stats](const Pin& pin) {
+        if (Pin::displayHitboxes && !(Pin::hideConnectedHitboxes && pin.isConnected)) stats.AddShape(pin);
+    };
+    stats.AddSprite();
+    for (const Pin& pin: inputs ) { countPin(pin); }
+    for (const Pin& pin: outputs) { countPin(pin); }
+    for (const auto& lead: leads) { stats.AddShape(lead); }
+    for (const auto& [key, wire]: wires) { for (const sf::RectangleShape& line: wire.lines) { stats.AddShape(line); } }
+    return;
+}
+
+
+void Component::MarkChanged()
+{
+    if (cacheState.isQueued) return;
+    cacheState.isQueued = true;
+    std::lock_guard lock{cacheQueueMutex};
+    changed.push_back(this);
+}
+
+
+void Component::TakeCacheQueues(std::vector<Component*>& changedOut, std::vector<const Component*>& removedOut)
+{
+    std::lock_guard lock{cacheQueueMutex};
+    changedOut.swap(changed); removedOut.swap(removed);
+    for (Component* component: changedOut) { component->cacheState.isQueued = false; }
+}
+
+
+Component::~Component()
+{
+    if (!cacheState.isQueued && !cacheState.isCached) return;
+    std::lock_guard lock{cacheQueueMutex};
+    if (cacheState.isQueued) {
+        // usually the most recent entry (a temporary that was just copied into a container)
+        auto search = std::find(changed.rbegin(), changed.rend(), this);
+        if (search != changed.rend()) changed.erase(std::next(search).base());
+    }
+    if (cacheState.isCached) removed.push_back(this);
+}
+
+
 void Component::SetPosition(float X, float Y)
 {
+    MarkChanged();
     sprite.setPosition(X, Y);
     const float hOffset = 0.f; // pins aligned to end of wires
     //const float hOffset = 32.f; // pins aligned to sprite's body
@@ -120,26 +214,41 @@ void Component::SetPosition(float X, float Y)
         lead.setPosition(pin.getPosition()); // assuming left-side
     }
     
-    // assuming only one output
-    outputs[0].setPosition(
-        X + sprite.getGlobalBounds().width - hOffset,  // offset from right edge
-        Y + (sprite.getGlobalBounds().height/2.f)
-    );
-    
-    // output lead
-    leads.back().setPosition(outputs[0].getPosition());
-    leads.back().move({-Wire::leadLength, 0});
+    // spread over the right edge like the inputs over the left; a single output is centred
+    const float vOffsetOut = sprite.getGlobalBounds().height / (outputs.size()*2);
+    for (Pin& pin: outputs) {
+        pin.setPosition(
+            X + sprite.getGlobalBounds().width - hOffset,  // offset from right edge
+            Y + vOffsetOut*(1 + pin.index*2)
+        );
+        
+        sf::RectangleShape& lead = OutputLead(pin.index);
+        lead.setPosition(pin.getPosition());
+        lead.move({-Wire::leadLength, 0});
+    }
     
     return;
 }
 
 
+void Component::RerouteWires()
+{
+    MarkChanged();
+    for (auto& [pinUUID, wire]: wires) {
+        wire.lines.clear();
+        wire.LinkTo(wire.drain);
+    }
+    return;
+}
+
+
 // returns false to indicate that the component should be considered inactive
 bool Component::Update()
 {
+    MarkChanged(); // re-textures the sprite
     #ifdef _ISDEBUG
     if ((inputs[0].isConnected || inputs[1].isConnected) == incoming.empty()) {
-        std::cerr << UUID() << " inconsistent state detected. \n";
+        Log::Warning("{} inconsistent state detected.", UUID());
         PrintConnections();
     }
     #endif
@@ -154,9 +263,10 @@ bool Component::Update()
             leads[I].setOutlineColor(sf::Color(0xFFFFFFAA));
         }
        
-        if (!outputs[0].isConnected) {
-            leads.back().setFillColor(sf::Color::Black); //back lead is the output line
-            leads.back().setOutlineColor(sf::Color(0xFFFFFFAA));
+        for (const Pin& pin: outputs) {
+            if (pin.isConnected) continue;
+            OutputLead(pin.index).setFillColor(sf::Color::Black);
+            OutputLead(pin.index).setOutlineColor(sf::Color(0xFFFFFFAA));
         }
         
         return false;
@@ -172,27 +282,58 @@ bool Component::Update()
     return true;
 }
 
+// every path of 'PropagateLogic', 'ShowState' and 'RemoveAllConnections' ends here
 void Component::UpdateLeadColors()
 { 
+    MarkChanged();
     for (int I{0}; I < int(inputs.size()); ++I) {
         leads[I].setOutlineColor(inputs[I].state? sf::Color(0x000000AA) : sf::Color(0xFFFFFFAA));
         leads[I].setFillColor( ( inputs[I].state? sf::Color::Red : sf::Color::Black)); }
-    leads.back().setFillColor( (outputs[0].state? sf::Color::Red : sf::Color::Black)); //back lead is the output line
-    leads.back().setOutlineColor(outputs[0].state?sf::Color(0x000000AA) : sf::Color(0xFFFFFFAA));
-    outputs[0].setFillColor(sf::Color::Transparent);
+    for (Pin& pin: outputs) {
+        OutputLead(pin.index).setFillColor( (pin.state? sf::Color::Red : sf::Color::Black));
+        OutputLead(pin.index).setOutlineColor(pin.state?sf::Color(0x000000AA) : sf::Color(0xFFFFFFAA));
+        pin.setFillColor(sf::Color::Transparent);
+    }
     
     return;
 }
 
 
+void Component::UpdateOutputConnections()
+{
+    if (outputs.size() == 1) { outputs[0].isConnected = !wires.empty(); return; }
+    for (Pin& pin: outputs) { pin.isConnected = false; }
+    for (const auto& [pinUUID, wire]: wires) { outputs[wire.source.index].isConnected = true; }
+    return;
+}
+
+
 void Component::PropagateLogic()
 {
     //if (!Update()) { return; } // never propagate inactive components
-    outputs[0].isConnected = !wires.empty();
+    UpdateOutputConnections();
     if(incoming.empty() && !isGlobalIn) { // always de-activate unconnected components
         gate.state = false;
-        outputs[0].state = gate.state;
+        for (Pin& pin: outputs) { pin.state = false; }
+        UpdateLeadColors();
+        return;
+    }
+    
+    if (IsCell()) { // every output at once, from the cell's fused kernel
+        unsigned inputBits{0};
+        for (const Pin& pin: inputs) { inputBits |= (unsigned(pin.state) << pin.index); }
+        const unsigned outputBits {CellBlocks::Outputs(gate.mType, inputBits)};
+        
+        bool hasChanged{false};
+        for (Pin& pin: outputs) {
+            const bool state ((outputBits >> pin.index) & 1);
+            hasChanged |= (pin.state != state);
+            pin.state = state;
+        }
+        gate.state = outputs[0].state;
+        if (hasChanged) { for(auto& [s,wire]: wires) { wire.PropagateState(); } }
         UpdateLeadColors();
+        Update();
         return;
     }
     
@@ -211,26 +352,44 @@ void Component::PropagateLogic()
 }
 
 
-void Component::CreateConnection(Component* target, Pin* targetPin)
+void Component::ShowState(bool state, int output)
+{
+    if(incoming.empty() && !isGlobalIn) { state = false; } // same rule as 'PropagateLogic'
+    Pin& pin {outputs.at(output)};
+    pin.state = state;
+    gate.state = outputs[0].state;
+    UpdateOutputConnections();
+    for(auto& [s,wire]: wires) { if (&wire.source == &pin) wire.PropagateState(); }
+    UpdateLeadColors();
+    Update();
+    return;
+}
+
+
+void Component::CreateConnection(Component* target, Pin* targetPin, int output)
 {
     if(!target || !targetPin) return;
+    if(output < 0 || output >= int(outputs.size())) return;
     if(target == this) return; // disallow self-connections
     if(!targetPin->BelongsTo(target->UUID())) {
-        std::cerr << std::format("target-pin: {} does not belong to target: {}\n", targetPin->UUID, target->UUID());
+        Log::Warning("target-pin: {} does not belong to target: {}", targetPin->UUID, target->UUID());
     }
     
     // check other connections to target, and disconnect them if they go to targetPin
     if (target->incoming.contains(targetPin->UUID)) {
         Component* oldParent = target->incoming[targetPin->UUID];
         oldParent->wires.erase(targetPin->UUID);
+        oldParent->UpdateOutputConnections();
+        oldParent->MarkChanged();
         target->incoming.erase(targetPin->UUID);
     }
     
-    outputs[0].isConnected = true;
+    outputs[output].isConnected = true;
     //targetPin->isConnected = true; //DON'T DO THIS! 'LinkTo' will think this is a conflict and delete this
     target->incoming[targetPin->UUID] = this;
-    Wire& wire = wires.emplace(targetPin->UUID, Wire{outputs[0], UUID()}).first->second;
+    Wire& wire = wires.emplace(targetPin->UUID, Wire{outputs[output], UUID()}).first->second;
     wire.LinkTo(targetPin);
+    target->MarkChanged(); // its pin's hitbox is hidden once connected
     PropagateLogic();
     return;
 }
@@ -239,18 +398,19 @@ void Component::CreateConnection(Component* target, Pin* targetPin)
 void Component::RemoveAllConnections()
 {
     for (auto[s, compPtr]: incoming) { 
-        #ifdef _ISDEBUG
-        std::cout << std::format("incoming connection from {}: {} -> {}", compPtr->UUID(), compPtr->outputs[0].UUID, s) << '\n';
-        #endif
+        if constexpr (Log::isDebugEnabled) {
+            Log::Debug("incoming connection from {}: {} -> {}", compPtr->UUID(), compPtr->outputs[compPtr->OutputDriving(s)].UUID, s);
+        }
         
         compPtr->wires.erase(s);
-        compPtr->outputs[0].isConnected = !compPtr->wires.empty();
+        compPtr->UpdateOutputConnections();
+        compPtr->MarkChanged();
         
         #ifdef _ISDEBUG
         // assert(compPtr->wires.erase(s) == 1);
         const int eraseCount = compPtr->wires.erase(s);
         if (eraseCount != 1) {
-            std::cerr << "warning: erasing input " << s << " did not find 1 element; #found: " << eraseCount << '\n';
+            Log::Warning("erasing input {} did not find 1 element; #found: {}", s, eraseCount);
         }
         #endif
     }
@@ -259,8 +419,8 @@ void Component::RemoveAllConnections()
         for (Pin& pin: inputs) { pin.state = false; pin.isConnected = false; }
         incoming.clear();
         
-        outputs[0].state = false; // always false for disconnencted components
-        gate.Update(false, false);
+        for (Pin& pin: outputs) { pin.state = false; } // always false for disconnencted components
+        gate.state = false;
     }
     
     for (auto&[s, wire]: wires) {
@@ -268,16 +428,16 @@ void Component::RemoveAllConnections()
             wire.drain->state = false;  // after disconnecting the target's input pin should always be non-active
             wire.drain->isConnected = false;
             
-            #ifdef _ISDEBUG
-            std::cout << std::format("wire belonging to {}: {} -> {}", wire.parentID, wire.source.UUID, wire.drain->UUID) << '\n';
-            #endif
+            if constexpr (Log::isDebugEnabled) {
+                Log::Debug("wire belonging to {}: {} -> {}", wire.parentID, wire.source.UUID, wire.drain->UUID);
+            }
             //assert(wire.drain->BelongsTo(wire.drain->parent->UUID())); //fails
             //wire.drain->parent->incoming.erase(wire.drain->UUID);  // crashes
         }
     }
     
     wires.clear();
-    outputs[0].isConnected = false;
+    for (Pin& pin: outputs) { pin.isConnected = false; }
     UpdateLeadColors();
     Update();
     return;
@@ -289,12 +449,15 @@ void Component::Init(std::string name)
     //const auto size = sprite.getGlobalBounds().getSize();
     //sprite.setOrigin(size.x/2.f, size.y/2.f);
     
-    inputs.reserve(2);
-    leads.reserve(3); // 2 input, 1 output
+    const int numInputs {LogicGate::InputCount(gate.mType)}, numOutputs {LogicGate::OutputCount(gate.mType)};
+    inputs.reserve(numInputs);
+    outputs.reserve(numOutputs);
+    leads.reserve(numInputs + numOutputs);
     if(name.empty()) { name = gate.GetName(); }  //TODO: name is unused
     // label = name;
     
-    int numInputs = ((gate.mType <= 1)? 1 : 2);
+    for (int K{1}; K < numOutputs; ++K) { outputs.emplace_back(Pin::Output, K, this, UUID()); } // the first is made by the constructor
+    
     for (int I{0}; I < numInputs; ++I) { 
         Pin& pin = inputs.emplace_back(Pin::Input, I, this, UUID());
         sf::RectangleShape& lead = leads.emplace_back(sf::Vector2f{Wire::leadLength, Wire::thickness});
@@ -305,14 +468,16 @@ void Component::Init(std::string name)
         lead.setPosition(pin.getPosition()); // assuming left-side
     }
     
-    sf::RectangleShape& leadout = leads.emplace_back(sf::Vector2f{Wire::leadLength, Wire::thickness});
-    leadout.setOrigin({0, Wire::thickness/2.f}); // don't change X-origin; it complicates alignment
-    //leadout.setPosition(outputs[0].getPosition()); leadout.move({-Wire::leadLength, 0}); // aligning to body of gate
-    // 'outputs[0]' hasn't been positioned yet.
-    
-    leadout.setFillColor(sf::Color::Black);
-    leadout.setOutlineColor(sf::Color(0xFFFFFFAA));
-    leadout.setOutlineThickness(-1);
+    for (int K{0}; K < numOutputs; ++K) {
+        sf::RectangleShape& leadout = leads.emplace_back(sf::Vector2f{Wire::leadLength, Wire::thickness});
+        leadout.setOrigin({0, Wire::thickness/2.f}); // don't change X-origin; it complicates alignment
+        //leadout.setPosition(outputs[0].getPosition()); leadout.move({-Wire::leadLength, 0}); // aligning to body of gate
+        // 'outputs' haven't been positioned yet.
+        
+        leadout.setFillColor(sf::Color::Black);
+        leadout.setOutlineColor(sf::Color(0xFFFFFFAA));
+        leadout.setOutlineThickness(-1);
+    }
     
     const auto&[X, Y] = sprite.getPosition();
     SetPosition(X, Y);
@@ -355,3 +520,52 @@ int ReadIO(const std::vector<Component>& pins)
     for (std::size_t I{1}; I < pins.size(); ++I, base*=2) { result += base*pins[I].ReadState(); }
     return result;
 }
+
+
+void MakeGlobalIO(std::vector<Component>& globalInputs, Datapath& datapath, int bus)
+{
+    const Datapath::Bus& driving {datapath.buses.at(bus)};
+    std::vector<Netlist::NetID> bits{};
+    for (int B{0}; B < driving.width && B < 64; ++B)
+    {
+        bits.push_back(Netlist::NetID(globalInputs.size()));
+        Component& component { globalInputs.emplace_back(Component{LogicGate::EQ, driving.name + std::to_string(B)}) };
+        component.isGlobalIn = true;
+        component.PropagateLogic();
+    }
+    datapath.UnpackTo(bus, bits);
+    
+    for (int I{1}; Component& component: globalInputs) { component.SetPosition(-72, I*(1024.f/(globalInputs.size()+1))); ++I; }
+    return;
+}
+
+
+Datapath::Word ReadIO(const std::vector<Component>& globalInputs, const Datapath::Boundary& boundary)
+{
+    Datapath::Word result{0};
+    for (std::size_t B{0}; B < boundary.bits.size() && B < 64; ++B) {
+        result |= Datapath::Word{globalInputs.at(boundary.bits[B]).ReadState()} << B;
+    }
+    return result;
+}
+
+
+void UpdateDatapath(std::vector<Component>& globalInputs, const Datapath& datapath)
+{
+    // one vector, the same conversions as 'Netlist::EvaluateWords': packed from the pins, unpacked into the driven ones
+    std::vector<Datapath::Word> values {datapath.MakeValues()};
+    for (const Datapath::Boundary& boundary: datapath.fromBits) {
+        values[boundary.bus] = ReadIO(globalInputs, boundary) & datapath.buses[boundary.bus].Mask();
+    }
+    datapath.Evaluate(values);
+    for (const Datapath::Boundary& boundary: datapath.toBits) {
+        for (std::size_t B{0}; B < boundary.bits.size() && B < 64; ++B) {
+            Component& component {globalInputs.at(boundary.bits[B])};
+            const bool bit ((values[boundary.bus] >> B) & 1);
+            if (component.inputs[0].state == bit) continue;
+            component.inputs[0].state = bit;
+            component.PropagateLogic();
+        }
+    }
+    return;
+}
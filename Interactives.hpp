@@ -13,16 +13,30 @@
 
 #include "LogicGate.hpp"
 #include "TextureStorage.hpp"
+#include "Datapath.hpp"
 
 
 class Component;
 
+// what one 'draw' submits to SFML: each sprite is one call, each shape one call for its fill plus one for its outline
+struct DrawStats
+{
+    std::size_t drawCalls{0};
+    std::size_t vertices{0};
+    
+    void AddSprite() { drawCalls += 1; vertices += 4; }
+    void AddShape(const sf::Shape& shape) {
+        drawCalls += 1; vertices += shape.getPointCount() + 2; // triangle-fan, centre + closing point
+        if (shape.getOutlineThickness() != 0.f) { drawCalls += 1; vertices += (shape.getPointCount() + 1)*2; }
+    }
+};
+
 struct Pin: sf::RectangleShape
 {
     const enum Type { Output, Input, } mtype;
     const int index; // counting connections for current component. Used to offset wire layouts
     Component* parent; //TODO: revert this
-    const std::string UUID; // component UUID + index (index counts from 1 for inputs)
+    const std::string UUID; // component UUID + '#' + 'Suffix'
     
     bool isConnected{false};
     bool state{false};
@@ -31,8 +45,11 @@ struct Pin: sf::RectangleShape
     static bool displayHitboxes;
     static bool hideConnectedHitboxes; // don't display hitboxes for connected pins
     
+    // inputs count up from 1 and outputs down from 0 ("#0", "#-1", ...), so no two pins of a component share one
+    static std::string Suffix(Type T, int I) { return std::to_string((T == Input)? I+1 : -I); }
+    
     bool BelongsTo(std::string parentUID) const {
-        return (UUID == (parentUID + '#' + std::to_string(index+mtype)));
+        return (UUID == (parentUID + '#' + Suffix(mtype, index)));
     }
     
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override 
@@ -45,7 +62,7 @@ struct Pin: sf::RectangleShape
     
     static constexpr float size = 25.f;
     Pin(Type T, int I, Component* C, std::string S): sf::RectangleShape{{size*2.f, size}}, 
-       mtype{T}, index{I}, parent{C}, UUID{ S + '#' + std::to_string(index+mtype)}
+       mtype{T}, index{I}, parent{C}, UUID{ S + '#' + Suffix(mtype, index)}
     {
         const float xorigin{ (mtype == Input)? size/2.f : size*1.5f }; // align left for inputs, right for outputs
         setOrigin(xorigin, size/2.f);
@@ -92,6 +109,7 @@ class Wire: public sf::Drawable
     }
     
     void LinkTo(Pin* pin);
+    sf::FloatRect GetBounds() const; // union of all segments
     
     Wire() = delete;
     explicit Wire(const Pin& sourcePin, std::string componentID)
@@ -111,13 +129,27 @@ class Component: public sf::Drawable
     LogicGate gate;
     sf::Sprite sprite;
     std::vector<Pin> inputs;
-    std::vector<Pin> outputs;
-    std::vector<sf::RectangleShape> leads; // line segments leading in/out of gates
+    std::vector<Pin> outputs; // more than one for cells; wires hold references, so these never reallocate after 'Init'
+    std::vector<sf::RectangleShape> leads; // line segments leading in/out of gates; inputs' first, then outputs'
     
     // keys are the pin-UUIDs
     std::map<std::string, Component*> incoming; //key is input-pinID, value is parent of connecting wire
     std::map<std::string, Wire> wires; //key is target pinID
     
+    // render-cache bookkeeping (see 'MarkChanged'); a copy is a different component to the cache, so it starts clear
+    struct CacheState
+    {
+        bool isQueued{false}; // in 'changed'
+        bool isCached{false}; // has an entry in a 'RenderCache', so its destruction is reported through 'removed'
+        CacheState() = default;
+        CacheState(const CacheState&) {;}
+        CacheState& operator=(const CacheState&) { return *this; }
+    } cacheState;
+    static std::vector<Component*> changed;
+    static std::vector<const Component*> removed; // only compared, never dereferenced
+    // empties both queues into the given (empty) vectors, so the taken components can be queued again
+    static void TakeCacheQueues(std::vector<Component*>& changedOut, std::vector<const Component*>& removedOut);
+    
     public:
     bool isGlobalIn {false}; //TODO: this is bad
     bool isGlobalOut{false};
@@ -125,9 +157,15 @@ class Component: public sf::Drawable
     inline std::string UUID() const { return gate.GetName() + '_' + std::to_string(gate.UUID); }
     inline std::string Name() const { return gate.GetName(); }
     std::size_t GetPinCount() const { return inputs.size() ; }
+    std::size_t GetOutputCount() const { return outputs.size(); }
+    bool IsCell() const { return LogicGate::IsCell(gate.mType); }
     
-    bool isOutputPinClicked(const sf::Vector2f& coord) const
-    { return outputs[0].getGlobalBounds().contains(coord); }
+    bool isOutputPinClicked(const sf::Vector2f& coord) const { return (getClickedOutput(coord) >= 0); }
+    
+    int getClickedOutput(const sf::Vector2f& coord) const { // index of the output-pin, or -1
+        for(const Pin& pin: outputs) { if(pin.getGlobalBounds().contains(coord)) return pin.index; }
+        return -1;
+    }
     
     bool inputHitboxClicked(const sf::Vector2f& coord) const {
         for(const Pin& pin: inputs) { if(pin.getGlobalBounds().contains(coord)) return true; }
@@ -148,14 +186,27 @@ class Component: public sf::Drawable
     
     bool Update(); // does some state checks, returns false if the component is inactive
     void SetPosition(float X, float Y);
-    void HighlightOutputPin(bool on=true) { outputs[0].setFillColor(on? sf::Color(0xFFFFFF77) : sf::Color::Transparent); }
+    void RerouteWires(); // outgoing; after this component or any of its targets was moved
+    void HighlightOutputPin(bool on=true, int output=0) { outputs.at(output).setFillColor(on? sf::Color(0xFFFFFF77) : sf::Color::Transparent); MarkChanged(); }
     void UpdateLeadColors();
     void PropagateLogic();
-    void CreateConnection(Component* target, Pin* targetPin);
+    void ShowState(bool state, int output=0); // adopts a state computed elsewhere (e.g. 'SimulationThread'), then recolors
+    void CreateConnection(Component* target, Pin* targetPin, int output=0);
     void RemoveAllConnections();
     void PrintConnections();
     void Init(std::string name="");
     
+    // for render-caching: queues this component (once) for the next 'RenderCache::Update'. Every method that changes
+    // what 'draw' shows calls it; safe to call concurrently for distinct components (e.g. from 'Place')
+    void MarkChanged();
+    
+    // for render-caching: the signature changes whenever anything 'draw' depends on changes
+    // (except the global hitbox-display flags), and the bounds cover the sprite, pins, leads and all outgoing wires
+    std::size_t VisualSignature() const;
+    sf::FloatRect GetDrawBounds() const;
+    sf::FloatRect GetSpriteBounds() const { return sprite.getGlobalBounds(); }
+    void CountDrawCalls(DrawStats& stats) const; // mirrors 'draw' (for benchmarking)
+    
     // implementing the SFML 'draw' function for this class
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override 
     {
@@ -166,6 +217,11 @@ class Component: public sf::Drawable
         for(const auto&[s,wire]:wires){ target.draw(wire,states); }
     }
     
+    private:
+    sf::RectangleShape& OutputLead(int K) { return leads[inputs.size() + K]; }
+    void UpdateOutputConnections(); // 'isConnected' of each output-pin, from the sources of 'wires'
+    
+    public:
     explicit Component(LogicGate::OpType T, const sf::Sprite& S, std::string name="")
     : gate{T}, sprite{S}, outputs{{Pin::Output, 0, this, UUID()}}
     { Init(name); }
@@ -173,16 +229,48 @@ class Component: public sf::Drawable
     explicit Component(LogicGate::OpType T, std::string name=""):
              Component(T, TextureStorage::GetSprite(T), name){;}
     
+    Component(const Component&) = default;
+    Component(Component&&) = default;
+    ~Component(); // leaves the render-cache's queue, and reports itself if it was cached
+    
     friend void MakeGlobalIO(std::vector<Component>&, bool, std::vector<bool>);
     friend int ReadIO(const std::vector<Component>&);
+    friend void MakeGlobalIO(std::vector<Component>&, Datapath&, int);
+    friend void UpdateDatapath(std::vector<Component>&, const Datapath&);
     bool ReadState() const { if(incoming.empty() && !isGlobalIn) return false; return gate.state; }
+    bool ReadOutput(int K) const { if(incoming.empty() && !isGlobalIn) return false; return outputs.at(K).state; }
+    unsigned ReadOutputs() const { // bit 'K' is output 'K'; bit 0 is 'ReadState'
+        unsigned bits {ReadState()};
+        for (std::size_t K{1}; K < outputs.size(); ++K) { bits |= unsigned(ReadOutput(int(K))) << K; }
+        return bits;
+    }
+    
+    // the index of the output-pin wired to 'targetPinUUID' (0 if there's no such wire)
+    int OutputDriving(const std::string& targetPinUUID) const {
+        auto search = wires.find(targetPinUUID);
+        return ((search == wires.end())? 0 : search->second.source.index);
+    }
     
     friend class ComponentMap;
+    friend class Netlist;
+    friend class EditTransaction;
+    friend class TimingGraph;
+    friend class ComponentOrder;
+    friend class Checkpointer;
+    friend class ConeIndex;
+    friend class RenderCache;
     friend int main(int argc, char** argv);
 };
 
 void MakeGlobalIO(std::vector<Component>& outvec, bool isInput, std::vector<bool> inputBits);
 int ReadIO(const std::vector<Component>&);
 
+// a global input for each bit of 'bus', set by the word blocks ('UpdateDatapath') instead of by hand; the bus is
+// unpacked into them. They go after the other inputs (so those keep their indices), and every input is spaced out again
+void MakeGlobalIO(std::vector<Component>& globalInputs, Datapath& datapath, int bus);
+Datapath::Word ReadIO(const std::vector<Component>& globalInputs, const Datapath::Boundary& boundary); // LSB first
+// evaluates the word blocks on the current global inputs, then sets (and propagates) the inputs they drive
+void UpdateDatapath(std::vector<Component>& globalInputs, const Datapath& datapath);
+
 
 #endif
@@ -0,0 +1,104 @@
+#include "Logger.hpp"
+
+#include <thread>
+#include <chrono>
+#include <string>
+
+
+namespace {
+
+// bounded multi-producer ring (after D. Vyukov): each slot's sequence says whether it's free to write at
+// position P (sequence == P), or ready to read (sequence == P+1); the single consumer frees it for P+CAPACITY
+class Flusher
+{
+    public:
+    std::array<Log::Record, Log::CAPACITY> records{};
+    alignas(64) std::atomic<std::size_t> head{0};    // next position to claim (producers)
+    alignas(64) std::atomic<std::size_t> written{0}; // positions below this have been written out (consumer)
+    std::atomic<std::FILE*> output{stdout};
+    std::atomic<bool> isRunning{true};
+    std::thread thread{};
+
+    void Run()
+    {
+        std::string batch{}, errors{};
+        std::size_t tail{0};
+        while (true)
+        {
+            batch.clear(); errors.clear();
+            for (Log::Record* record{&records[tail % Log::CAPACITY]};
+                 record->sequence.load(std::memory_order_acquire) == tail+1;
+                 record = &records[tail % Log::CAPACITY])
+            {
+                std::string& out {(record->severity >= Log::Severity::Warning)? errors : batch};
+                switch (record->severity) {
+                    case Log::Severity::Debug:   out += "[debug] "; break;
+                    case Log::Severity::Warning: out += "warning: "; break;
+                    case Log::Severity::Error:   out += "error: "; break;
+                    default: break;
+                }
+                out.append(record->text, record->length);
+                out.push_back('\n');
+                record->sequence.store(tail + Log::CAPACITY, std::memory_order_release);
+                ++tail;
+            }
+
+            if (!batch.empty())  { std::FILE* file {output.load()}; std::fwrite(batch.data(), 1, batch.size(), file); std::fflush(file); }
+            if (!errors.empty()) { std::fwrite(errors.data(), 1, errors.size(), stderr); }
+            written.store(tail, std::memory_order_release);
+
+            if (batch.empty() && errors.empty()) {
+                if (!isRunning.load()) break; // only once drained
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    Flusher() {
+        for (std::size_t I{0}; I < Log::CAPACITY; ++I) { records[I].sequence.store(I, std::memory_order_relaxed); }
+        thread = std::thread{&Flusher::Run, this};
+    }
+    ~Flusher() { isRunning = false; thread.join(); }
+};
+
+Flusher& GetFlusher() { static Flusher flusher{}; return flusher; }
+
+} // namespace
+
+
+Log::Record& Log::Acquire()
+{
+    Flusher& flusher {GetFlusher()};
+    std::size_t position {flusher.head.load(std::memory_order_relaxed)};
+    while (true)
+    {
+        Record& record {flusher.records[position % CAPACITY]};
+        const std::ptrdiff_t difference {std::ptrdiff_t(record.sequence.load(std::memory_order_acquire) - position)};
+        if (difference == 0) {
+            if (flusher.head.compare_exchange_weak(position, position+1, std::memory_order_relaxed)) return record;
+        } else if (difference < 0) { // full; waiting for the flusher to catch up
+            std::this_thread::yield();
+            position = flusher.head.load(std::memory_order_relaxed);
+        } else {
+            position = flusher.head.load(std::memory_order_relaxed); // another producer claimed it first
+        }
+    }
+}
+
+
+void Log::Publish(Record& record)
+{
+    // the slot was claimed at position (sequence), so it becomes readable at position+1
+    record.sequence.store(record.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+
+void Log::SetOutput(std::FILE* file) { Flush(); GetFlusher().output = file; }
+
+
+void Log::Flush()
+{
+    Flusher& flusher {GetFlusher()};
+    const std::size_t target {flusher.head.load(std::memory_order_acquire)};
+    while (flusher.written.load(std::memory_order_acquire) < target) { std::this_thread::yield(); }
+}
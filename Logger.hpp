@@ -0,0 +1,70 @@
+#ifndef CIRCUITSIM_LOGGER_HPP
+#define CIRCUITSIM_LOGGER_HPP
+
+#include <array>
+#include <atomic>
+#include <format>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+
+// severity below which logging calls compile to nothing (the arguments are still evaluated; see 'isDebugEnabled')
+#ifndef LOG_MIN_SEVERITY
+  #ifdef _ISDEBUG
+    #define LOG_MIN_SEVERITY Debug
+  #else
+    #define LOG_MIN_SEVERITY Info
+  #endif
+#endif
+
+
+// asynchronous line-logger: callers format straight into a slot of a lock-free (multi-producer) ring,
+// and a background thread writes the records out in batches. Info/Debug go to the output-file
+// (stdout by default), Warning/Error always go to stderr. A full ring makes callers wait, so nothing is dropped
+class Log
+{
+    public:
+    enum class Severity { Debug, Info, Warning, Error, };
+    static constexpr Severity minSeverity{Severity::LOG_MIN_SEVERITY};
+    static constexpr bool isDebugEnabled{minSeverity <= Severity::Debug}; // for 'if constexpr' around costly arguments
+    static constexpr std::size_t RECORD_SIZE{240}; // longer records are truncated
+    static constexpr std::size_t CAPACITY{4096};   // records; must be a power of 2
+
+    template <Severity S, typename... Args>
+    static void Write(std::format_string<Args...> format, Args&&... args) {
+        if constexpr (S >= minSeverity) {
+            Record& record {Acquire()};
+            record.severity = S;
+            const auto result {std::format_to_n(record.text, RECORD_SIZE, format, std::forward<Args>(args)...)};
+            record.length = std::uint16_t(std::min<std::ptrdiff_t>(result.size, RECORD_SIZE));
+            Publish(record);
+        }
+    }
+
+    template <typename... Args> static void Debug  (std::format_string<Args...> F, Args&&... A) { Write<Severity::Debug>  (F, std::forward<Args>(A)...); }
+    template <typename... Args> static void Info   (std::format_string<Args...> F, Args&&... A) { Write<Severity::Info>   (F, std::forward<Args>(A)...); }
+    template <typename... Args> static void Warning(std::format_string<Args...> F, Args&&... A) { Write<Severity::Warning>(F, std::forward<Args>(A)...); }
+    template <typename... Args> static void Error  (std::format_string<Args...> F, Args&&... A) { Write<Severity::Error>  (F, std::forward<Args>(A)...); }
+
+    static void SetOutput(std::FILE* file); // for Info/Debug; e.g. stderr while stdout carries data
+    static void Flush(); // waits until everything logged so far has been written (use before printing directly)
+
+    // one slot of the ring (internal to 'Log' and its flusher-thread)
+    struct Record
+    {
+        std::atomic<std::size_t> sequence{0}; // ring-position this slot is ready for (see 'Acquire')
+        Severity severity{Severity::Info};
+        std::uint16_t length{0};
+        char text[RECORD_SIZE];
+    };
+
+    private:
+    static Record& Acquire();
+    static void Publish(Record& record);
+};
+
+
+#endif
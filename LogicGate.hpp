@@ -2,6 +2,7 @@
 #define CIRCUITSIM_LOGICGATE_HPP
 
 #include <string>
+#include <cstdint>
 
 
 class LogicGate
@@ -20,10 +21,16 @@ class LogicGate
         OR,  NOR,
         AND, NAND,
         XOR, XNOR,
+        // multi-input/multi-output cells, evaluated by one fused kernel each ('CellBlocks::Outputs');
+        // 'Netlist::Extract' lowers them to the gates above, so only the canvas ever sees them
+        HALF_ADDER, FULL_ADDER,
+        MUX,        DECODER,
         LAST_ENUM,
     } mType;
     
-    static bool Eval(OpType T, bool A, bool B) {
+    static constexpr OpType FIRST_CELL{HALF_ADDER}; // every type before this is a primitive gate
+    
+    static constexpr bool Eval(OpType T, bool A, bool B) {
         switch(T) {
             case  EQ: return (A);      case  NOT: return !(A); // unary ops should not be valid here
             case  OR: return (A || B); case  NOR: return !(A || B);
@@ -33,6 +40,36 @@ class LogicGate
         }
     }
     
+    // word-parallel version of 'Eval'; each bit is an independent lane (64 vectors per call)
+    static constexpr std::uint64_t EvalWord(OpType T, std::uint64_t A, std::uint64_t B) {
+        switch(T) {
+            case  EQ: return  (A);     case  NOT: return ~(A); // 'B' is ignored for unary ops
+            case  OR: return (A | B);  case  NOR: return ~(A | B);
+            case AND: return (A & B);  case NAND: return ~(A & B);
+            case XOR: return (A ^ B);  case XNOR: return ~(A ^ B);
+            default: return 0;
+        }
+    }
+
+    static constexpr bool IsUnary(OpType T) { return (T <= NOT); }
+    static constexpr bool IsCell(OpType T) { return (T >= FIRST_CELL) && (T < LAST_ENUM); }
+    
+    // pin-counts; a mux reads (A, B, select), a decoder's output 'K' is true for the input-value 'K'
+    static constexpr int InputCount(OpType T) {
+        switch(T) {
+            case EQ: case NOT: return 1;
+            case FULL_ADDER: case MUX: return 3;
+            default: return 2;
+        }
+    }
+    static constexpr int OutputCount(OpType T) {
+        switch(T) {
+            case HALF_ADDER: case FULL_ADDER: return 2; // sum, then carry
+            case DECODER: return 4;
+            default: return 1;
+        }
+    }
+
     // updates states from inputs, then returns true if it's state changed
     bool Update(bool A) { bool old{state};  state = ((mType == NOT)? !A : A); return (old==state); } // unary
     bool Update(bool A, bool B) { bool old{state}; state = Eval(mType, A, B); return (old==state); } // binary
@@ -43,6 +80,8 @@ class LogicGate
             case   OR: return  "OR"; case  NOR: return "NOR";
             case  AND: return "AND"; case NAND: return "NAND";
             case  XOR: return "XOR"; case XNOR: return "XNOR";
+            case HALF_ADDER: return "HALFADD"; case FULL_ADDER: return "FULLADD";
+            case        MUX: return     "MUX"; case    DECODER: return "DECODER";
             default: return "INVALID";
         }
     }
@@ -0,0 +1,221 @@
+#include "Lut.hpp"
+
+#include <format>
+#include <random>
+#include <algorithm>
+
+
+LutNetlist::NetID LutNetlist::AddLut(std::uint64_t table, int inputCount, const NetID* in)
+{
+    LutGate lut{table, inputCount, {}, netCount};
+    int level{0};
+    for (int K{0}; K < inputCount; ++K) { lut.in[K] = in[K]; level = std::max(level, levelOf[in[K]]); }
+    luts.push_back(lut);
+    const NetID N {NewNet()};
+    levelOf[N] = level+1;
+    depth = std::max(depth, level+1);
+    return N;
+}
+
+
+void LutNetlist::Evaluate(Word* state, std::size_t stride, std::size_t count) const
+{
+    Word broadcast[1 << LutGate::MAX_INPUTS];
+    for (const LutGate& lut: luts)
+    {
+        LutGate::Broadcast(lut.table, lut.inputCount, broadcast); // once per LUT, not per word
+        Word* out {state + lut.out*stride};
+        for (std::size_t W{0}; W < count; ++W) {
+            Word inputs[LutGate::MAX_INPUTS];
+            for (int K{0}; K < lut.inputCount; ++K) { inputs[K] = state[lut.in[K]*stride + W]; }
+            out[W] = LutGate::EvalWord(broadcast, lut.inputCount, inputs);
+        }
+    }
+    return;
+}
+
+
+void LutNetlist::Evaluate(std::vector<std::uint8_t>& values) const
+{
+    for (const LutGate& lut: luts) {
+        unsigned index{0};
+        for (int K{0}; K < lut.inputCount; ++K) { index |= unsigned(values[lut.in[K]]) << K; }
+        values[lut.out] = LutGate::Eval(lut.table, index);
+    }
+    return;
+}
+
+
+namespace {
+
+using NetID = Netlist::NetID;
+
+struct Cut
+{
+    std::array<NetID, LutGate::MAX_INPUTS> leaves{}; // sorted
+    int size{0};
+    int depth{0};
+
+    bool operator<(const Cut& other) const { return (depth != other.depth)? (depth < other.depth) : (size < other.size); }
+    bool operator==(const Cut& other) const {
+        return (size == other.size) && std::equal(leaves.begin(), leaves.begin()+size, other.leaves.begin());
+    }
+};
+
+// union of two sorted leaf-sets; false if it has more than 'k' leaves
+bool Merge(const Cut& A, const Cut& B, int k, Cut& out)
+{
+    int I{0}, J{0};
+    out.size = 0;
+    while (I < A.size || J < B.size) {
+        NetID next;
+        if (J == B.size || (I < A.size && A.leaves[I] < B.leaves[J])) next = A.leaves[I++];
+        else if (I == A.size || B.leaves[J] < A.leaves[I]) next = B.leaves[J++];
+        else { next = A.leaves[I++]; ++J; }
+        if (out.size == k) return false;
+        out.leaves[out.size++] = next;
+    }
+    return true;
+}
+
+} // namespace
+
+
+std::string LutMapStats::Report() const
+{
+    if (wasSkipped) return std::format("lut-mapper: netlist has combinational loops; {} gates mapped one-to-one\n", gatesBefore);
+    return std::format("lut-mapper: {} gates -> {} LUTs, depth {} -> {}\n", gatesBefore, lutsAfter, depthBefore, depthAfter);
+}
+
+
+LutNetlist MapToLuts(const Netlist& source, int k, LutMapStats* statsOut)
+{
+    constexpr std::size_t maxCuts{8}; // per net, besides the trivial one
+    k = std::clamp(k, 2, LutGate::MAX_INPUTS);
+
+    LutMapStats stats{};
+    Netlist netlist{source};
+    if (!netlist.IsLevelized()) netlist.Levelize();
+    stats.gatesBefore = int(netlist.gates.size());
+    stats.depthBefore = netlist.Depth();
+
+    LutNetlist mapped{};
+    std::vector<NetID> remap(netlist.NetCount(), Netlist::CONST0);
+    for (NetID N: netlist.inputs) { remap[N] = mapped.AddInput(); mapped.origin[remap[N]] = netlist.origin[N]; }
+
+    if (netlist.HasLoops()) { // no cuts through a loop; a loop's fanin can refer forwards, so it's patched afterwards
+        stats.wasSkipped = true;
+        for (const Netlist::Gate& gate: netlist.gates) {
+            const NetID in[2] {Netlist::CONST0, Netlist::CONST0};
+            remap[gate.out] = mapped.AddLut(0, 2, in);
+            mapped.origin[remap[gate.out]] = netlist.origin[gate.out];
+        }
+        for (std::size_t I{0}; I < netlist.gates.size(); ++I) {
+            const Netlist::Gate& gate {netlist.gates[I]};
+            LutGate& lut {mapped.luts[I]};
+            lut.in = {remap[gate.A], remap[gate.B]};
+            lut.table = LogicGate::EvalWord(gate.type, LutGate::VariableTable(0), LutGate::VariableTable(1));
+        }
+        for (NetID N: netlist.outputs) { mapped.MarkOutput(remap[N]); }
+        stats.lutsAfter = int(mapped.luts.size());
+        stats.depthAfter = mapped.Depth();
+        if (statsOut) *statsOut = stats;
+        return mapped;
+    }
+
+    // cut enumeration in topological order; 'CONST0' has the empty cut, so constants never take up a leaf
+    std::vector<int> driver(netlist.NetCount(), -1);
+    for (std::size_t I{0}; I < netlist.gates.size(); ++I) { driver[netlist.gates[I].out] = int(I); }
+    std::vector<std::vector<Cut>> cuts(netlist.NetCount());
+    std::vector<int> depth(netlist.NetCount(), 0);
+    auto trivial = [&](NetID N) {
+        Cut cut{};
+        if (N != Netlist::CONST0) { cut.leaves[0] = N; cut.size = 1; cut.depth = depth[N]; }
+        return cut;
+    };
+    auto withTrivial = [&](NetID N) { std::vector<Cut> all{cuts[N]}; all.push_back(trivial(N)); return all; };
+
+    for (const Netlist::Gate& gate: netlist.gates)
+    {
+        std::vector<Cut> candidates{};
+        const std::vector<Cut> fromA {withTrivial(gate.A)};
+        const std::vector<Cut> fromB {LogicGate::IsUnary(gate.type)? std::vector<Cut>{Cut{}} : withTrivial(gate.B)};
+        for (const Cut& A: fromA) {
+            for (const Cut& B: fromB) {
+                Cut merged{};
+                if (!Merge(A, B, k, merged)) continue;
+                for (int L{0}; L < merged.size; ++L) { merged.depth = std::max(merged.depth, depth[merged.leaves[L]] + 1); }
+                if (std::find(candidates.begin(), candidates.end(), merged) == candidates.end()) candidates.push_back(merged);
+            }
+        }
+        std::stable_sort(candidates.begin(), candidates.end());
+        if (candidates.size() > maxCuts) candidates.resize(maxCuts);
+        depth[gate.out] = candidates.front().depth; // the fanin-pair itself always fits, so there's at least one
+        cuts[gate.out] = std::move(candidates);
+    }
+
+    // covering from the outputs: a needed gate is implemented by its best cut, whose leaves are then needed
+    std::vector<bool> isNeeded(netlist.NetCount(), false);
+    for (NetID N: netlist.outputs) { isNeeded[N] = true; }
+    for (auto iter = netlist.gates.rbegin(); iter != netlist.gates.rend(); ++iter) {
+        if (!isNeeded[iter->out]) continue;
+        const Cut& best {cuts[iter->out].front()};
+        for (int L{0}; L < best.size; ++L) { isNeeded[best.leaves[L]] = true; }
+    }
+
+    // each table is the cone between the root and its leaves, simulated over the 6 variable-tables
+    std::vector<std::uint64_t> value(netlist.NetCount(), 0);
+    std::vector<int> visited(netlist.NetCount(), -1);
+    for (const Netlist::Gate& gate: netlist.gates)
+    {
+        if (!isNeeded[gate.out]) continue;
+        const Cut& best {cuts[gate.out].front()};
+        const int stamp {gate.out};
+        for (int L{0}; L < best.size; ++L) { value[best.leaves[L]] = LutGate::VariableTable(L); visited[best.leaves[L]] = stamp; }
+        value[Netlist::CONST0] = 0; visited[Netlist::CONST0] = stamp;
+
+        std::vector<std::pair<NetID, bool>> stack{{gate.out, false}};
+        while (!stack.empty()) {
+            auto [N, isExpanded] = stack.back(); stack.pop_back();
+            if (visited[N] == stamp) continue;
+            const Netlist::Gate& inner {netlist.gates[driver[N]]}; // never an input; every path from the root ends at a leaf
+            if (!isExpanded) {
+                stack.emplace_back(N, true);
+                stack.emplace_back(inner.A, false);
+                if (!LogicGate::IsUnary(inner.type)) stack.emplace_back(inner.B, false);
+                continue;
+            }
+            value[N] = LogicGate::EvalWord(inner.type, value[inner.A], value[inner.B]);
+            visited[N] = stamp;
+        }
+
+        NetID in[LutGate::MAX_INPUTS]{};
+        for (int L{0}; L < best.size; ++L) { in[L] = remap[best.leaves[L]]; }
+        remap[gate.out] = mapped.AddLut(value[gate.out], best.size, in);
+        mapped.origin[remap[gate.out]] = netlist.origin[gate.out];
+    }
+    for (NetID N: netlist.outputs) { mapped.MarkOutput(remap[N]); }
+
+    stats.lutsAfter = int(mapped.luts.size());
+    stats.depthAfter = mapped.Depth();
+    if (statsOut) *statsOut = stats;
+    return mapped;
+}
+
+
+bool SimulateEquivalent(const Netlist& A, const LutNetlist& B, int rounds)
+{
+    if (A.inputs.size() != B.inputs.size() || A.outputs.size() != B.outputs.size()) return false;
+
+    std::mt19937_64 random{0x5EED};
+    std::vector<Netlist::Word> stateA {A.MakeState()}, stateB {B.MakeState()};
+    for (int R{0}; R < rounds; ++R)
+    {
+        for (std::size_t I{0}; I < A.inputs.size(); ++I) { stateA[A.inputs[I]] = stateB[B.inputs[I]] = random(); }
+        A.Evaluate(stateA); B.Evaluate(stateB);
+        for (std::size_t I{0}; I < A.outputs.size(); ++I) {
+            if (stateA[A.outputs[I]] != stateB[B.outputs[I]]) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,113 @@
+#ifndef CIRCUITSIM_LUT_HPP
+#define CIRCUITSIM_LUT_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "Netlist.hpp"
+
+
+// gate with up to 6 inputs and an arbitrary function; bit 'I' of 'table' is the output
+// for the input-combination 'I' (input 0 is the lowest index-bit). Unused inputs read 'CONST0'
+struct LutGate
+{
+    static constexpr int MAX_INPUTS{6};
+    using NetID = Netlist::NetID;
+    using Word  = Netlist::Word;
+
+    std::uint64_t table{0};
+    int inputCount{0};
+    std::array<NetID, MAX_INPUTS> in{};
+    NetID out{Netlist::CONST0};
+
+    // single-lane: indexes the table with the packed input-bits
+    static bool Eval(std::uint64_t table, unsigned index) { return ((table >> index) & 1); }
+
+    // each table-bit broadcast to a whole word ('1 << inputCount' of them); the same for every word a LUT evaluates
+    static void Broadcast(std::uint64_t table, int inputCount, Word* cofactors) {
+        for (int I{0}; I < (1 << inputCount); ++I) { cofactors[I] = -((table >> I) & 1); }
+    }
+
+    // bit-parallel: Shannon-expands the broadcast table one input at a time, muxing pairs of cofactors
+    // until one remains. The first level reads 'broadcast', so it can be reused across words
+    static Word EvalWord(const Word* broadcast, int inputCount, const Word* inputs) {
+        if (inputCount == 0) return broadcast[0];
+        Word cofactor[32];
+        int width {1 << (inputCount-1)};
+        for (int I{0}; I < width; ++I) { cofactor[I] = broadcast[2*I] ^ (inputs[0] & (broadcast[2*I] ^ broadcast[2*I+1])); }
+        for (int K{1}; K < inputCount; ++K) {
+            width >>= 1;
+            for (int I{0}; I < width; ++I) { cofactor[I] = cofactor[2*I] ^ (inputs[K] & (cofactor[2*I] ^ cofactor[2*I+1])); }
+        }
+        return cofactor[0];
+    }
+
+    // the table that makes input 'K' (of 6) the output; 'EvalWord' over these reproduces any table
+    static constexpr std::uint64_t VariableTable(int K) {
+        constexpr std::uint64_t tables[MAX_INPUTS] {
+            0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+            0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000,
+        };
+        return tables[K];
+    }
+};
+
+
+// same layout and conventions as 'Netlist' (net 0 is constant-false, net-major state), with LUTs instead of gates
+class LutNetlist
+{
+    public:
+    using NetID = Netlist::NetID;
+    using Word  = Netlist::Word;
+
+    std::vector<LutGate> luts; // in evaluation-order
+    std::vector<NetID> inputs;
+    std::vector<NetID> outputs;
+    std::vector<Component*> origin;
+
+    NetID NetCount() const { return netCount; }
+    int Depth() const { return depth; }
+
+    NetID AddInput() { inputs.push_back(netCount); return NewNet(); }
+    NetID AddLut(std::uint64_t table, int inputCount, const NetID* in);
+    void MarkOutput(NetID N) { outputs.push_back(N); }
+
+    // same contract as 'Netlist::Evaluate'
+    void Evaluate(Word* state, std::size_t stride, std::size_t count) const;
+    void Evaluate(std::vector<Word>& state) const { Evaluate(state.data(), 1, 1); }
+    // single-vector, one value (0 or 1) per net
+    void Evaluate(std::vector<std::uint8_t>& values) const;
+    std::vector<Word> MakeState(std::size_t stride=1) const { return std::vector<Word>(std::size_t(netCount)*stride, 0); }
+
+    LutNetlist() { NewNet(); } // reserving 'CONST0'
+
+    private:
+    NetID netCount{0};
+    int depth{0};
+    std::vector<int> levelOf; // per net
+    NetID NewNet() { origin.push_back(nullptr); levelOf.push_back(0); return netCount++; }
+};
+
+
+struct LutMapStats
+{
+    int gatesBefore{0}, lutsAfter{0};
+    int depthBefore{0}, depthAfter{0};
+    bool wasSkipped{false}; // combinational loops are mapped one gate per LUT, in the original order
+
+    std::string Report() const;
+};
+
+// covers the netlist with 'k'-input LUTs (k <= 6), using depth-oriented priority-cuts:
+// each net keeps its best few k-feasible cuts, every gate picks the one of least depth (then fewest leaves),
+// and only the cuts needed by the outputs are emitted. Constant fanin is folded into the tables
+LutNetlist MapToLuts(const Netlist& netlist, int k=LutGate::MAX_INPUTS, LutMapStats* stats=nullptr);
+
+// random-simulation check against the netlist it was mapped from; 'rounds' x 64 vectors
+bool SimulateEquivalent(const Netlist& A, const LutNetlist& B, int rounds=16);
+
+
+#endif
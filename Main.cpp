@@ -1,6 +1,13 @@
 #include <iostream>
+#include <vector>
 #include <format>
 #include <cmath> // for arc-tangent and square-root (in MouseDragLoop)
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <charconv>
+#include <cstring>
+#include <limits>
 
 #include <SFML/Window.hpp> //sf::Event
 
@@ -9,6 +16,27 @@
 #include "SelectorWindow.hpp"
 #include "Interactives.hpp"
 #include "ComponentMap.hpp"
+#include "Netlist.hpp"
+#include "VectorStream.hpp"
+#include "RenderCache.hpp"
+#include "SimulationThread.hpp"
+#include "Optimizer.hpp"
+#include "Bdd.hpp"
+#include "Reorder.hpp"
+#include "Lut.hpp"
+#include "EditTransaction.hpp"
+#include "Logger.hpp"
+#include "EventTrace.hpp"
+#include "Distributed.hpp"
+#include "Timing.hpp"
+#include "TopoOrder.hpp"
+#include "FourValued.hpp"
+#include "StaticNetlist.hpp"
+#include "Coverage.hpp"
+#include "Checkpoint.hpp"
+#include "Placement.hpp"
+#include "Cones.hpp"
+#include "Subcircuit.hpp"
 
 
 //create a component for each gate on startup and validate pincount
@@ -41,8 +69,69 @@ void PrintProgramConfiguration()
 }
 
 
+// startup-phase timing; each phase is measured from the end of the previous one
+sf::Clock startupClock{};
+std::vector<std::pair<std::string, sf::Time>> startupPhases{};
+void MarkStartupPhase(std::string name) { startupPhases.emplace_back(name, startupClock.restart()); }
+
+void PrintStartupPhases()
+{
+    float total{0.f};
+    std::cout << "startup:";
+    for (const auto& [name, time]: startupPhases) {
+        std::cout << std::format(" {} {:.1f}ms |", name, time.asSeconds()*1000.f);
+        total += time.asSeconds();
+    }
+    std::cout << std::format(" total {:.1f}ms\n\n", total*1000.f);
+    return;
+}
+
+
+// exact function of each global output (through BDDs) instead of enumerating every input-vector
+void PrintOutputFunctions(const Netlist& netlist)
+{
+    constexpr std::size_t maxInputs{32}, maxCubes{8};
+    if (netlist.inputs.size() > maxInputs) { std::cout << "output functions: skipped (more than 32 inputs)\n\n"; return; }
+    if (netlist.datapath) { std::cout << "output functions: skipped (word-level blocks)\n\n"; return; }
+    
+    BddManager manager{int(netlist.inputs.size())};
+    const std::vector<BddManager::Ref> functions = BuildOutputBdds(netlist, manager);
+    if (functions.empty()) { std::cout << "output functions: skipped (combinational loop)\n\n"; return; }
+    
+    const std::uint64_t total {std::uint64_t{1} << netlist.inputs.size()};
+    std::cout << std::format("OUTPUT FUNCTIONS (cubes: input{}..input1)\n", netlist.inputs.size());
+    for (std::size_t I{0}; I < functions.size(); ++I)
+    {
+        const BddManager::Ref F {functions[I]};
+        std::cout << std::format("  output{}: true for {}/{} inputs", I+1, manager.SatisfyingCount(F), total);
+        if (!manager.IsSatisfiable(F)) { std::cout << '\n'; continue; }
+        
+        const std::vector<std::string> cubes = manager.Cubes(F, maxCubes);
+        std::cout << "; ";
+        for (const std::string& cube: cubes) { std::cout << cube << ' '; }
+        if (cubes.size() == maxCubes) std::cout << "...";
+        std::cout << '\n';
+    }
+    std::cout << '\n';
+    return;
+}
+
+
+// the whole argument must be a number within [min, max]; trailing characters, signs on unsigned types and overflow are rejected
+template<typename T>
+bool ParseArgument(const char* text, T& value, T min, T max=std::numeric_limits<T>::max())
+{
+    const char* const end {text + std::strlen(text)};
+    T parsed{};
+    const auto [last, error] {std::from_chars(text, end, parsed)};
+    if ((error != std::errc{}) || (last != end) || (parsed < min) || (parsed > max)) return false;
+    value = parsed;
+    return true;
+}
+
+
 //draws a line following the mouse while holding left-click
-void MouseDragLoop(sf::RenderWindow& mainWindow, sf::Vector2f initalPosition, bool activeColor)
+void MouseDragLoop(sf::RenderWindow& mainWindow, EventTrace& trace, sf::Vector2f initalPosition, bool activeColor)
 {
     auto [szx, szy] = mainWindow.getSize();
     sf::Texture overlayTexture{}; overlayTexture.create(szx, szy); overlayTexture.setSmooth(false);
@@ -56,9 +145,9 @@ void MouseDragLoop(sf::RenderWindow& mainWindow, sf::Vector2f initalPosition, bo
     dragline.setOutlineColor(sf::Color(0x00000077));
     dragline.setFillColor(activeColor? sf::Color(0xFF222277) : sf::Color(0xAABBFF88));
     
-    while(sf::Mouse::isButtonPressed(sf::Mouse::Button::Left)) 
+    while(trace.IsButtonPressed(sf::Mouse::Button::Left)) 
     {
-        auto nextPosition = sf::Vector2f{sf::Mouse::getPosition(mainWindow)};
+        auto nextPosition = sf::Vector2f{trace.MousePosition(mainWindow)};
         auto [dx,dy] = nextPosition-initalPosition;
         
         dragline.setSize({5.f, std::sqrt(dx*dx + dy*dy)}); //pythagorean theorem.
@@ -77,6 +166,67 @@ void MouseDragLoop(sf::RenderWindow& mainWindow, sf::Vector2f initalPosition, bo
 
 int main(int argc, char** argv)
 {
+    // batch-mode: '--vectors <file|->' streams input-vectors through the circuit instead of opening any windows
+    bool isBatchMode{false};
+    bool usingOptimizer{false}; // batch-mode only; see 'Optimize'
+    bool usingReorder{false};   // batch-mode only; see 'Reorder'
+    // '--record <file>' saves the main-window's input; '--replay <file>' feeds it back as fast as possible
+    EventTrace::Mode traceMode{EventTrace::Mode::Off};
+    std::string tracePath{};
+    Ordering ordering{Ordering::LevelDfs};
+    int lutInputs{0};           // batch-mode only; '--lut <k>' maps the netlist to k-input LUTs (see 'MapToLuts')
+    int workerCount{0};         // batch-mode only; '--workers <k>' simulates in k worker processes (see 'Cluster')
+    bool usingFourValued{false}; // batch-mode only; '--four-valued' streams 0/1/X/Z vectors, with unconnected pins floating
+    std::size_t instanceCount{1}; // batch-mode only; '--instances <n>' streams n copies of the circuit side by side (see 'SubcircuitBank')
+    Transport transport{Transport::Unix};
+    StreamOptions streamOptions{};
+    // interactive-mode only; '--autosave <file>' (empty to disable) is written in the background, '--restore <file>' loads one on startup
+    std::string autosavePath{"autosave.checkpoint"};
+    std::string restorePath{};
+    bool usingPlacer{false};    // interactive-mode only; '--place' lays the canvas out on startup (see 'Place')
+    
+    for (int C{1}; C < argc; ++C) {
+        std::string arg {argv[C]};
+        const bool hasValue {(C+1) < argc};
+        bool isValid{true};
+        if      (arg == "--vectors" && hasValue) { isBatchMode = true; streamOptions.inputPath = argv[++C]; }
+        else if (arg == "--out"     && hasValue) { streamOptions.outputPath = argv[++C]; }
+        else if (arg == "--batch"   && hasValue) { isValid = ParseArgument<std::size_t>(argv[++C], streamOptions.batchSize, 1); }
+        else if (arg == "--binary") { streamOptions.isBinary = true; }
+        else if (arg == "--memo"    && hasValue) { // MiB
+            isValid = ParseArgument<std::size_t>(argv[++C], streamOptions.memoBytes, 0, (std::numeric_limits<std::size_t>::max() >> 20));
+            streamOptions.memoBytes <<= 20;
+        }
+        else if (arg == "--optimize") { usingOptimizer = true; }
+        else if (arg == "--lut" && hasValue) { isValid = ParseArgument(argv[++C], lutInputs, 2, LutGate::MAX_INPUTS); }
+        else if (arg == "--workers" && hasValue) { isValid = ParseArgument(argv[++C], workerCount, 1); }
+        else if (arg == "--tcp") { transport = Transport::Tcp; }
+        else if (arg == "--four-valued") { usingFourValued = true; }
+        else if (arg == "--instances" && hasValue) { isValid = ParseArgument<std::size_t>(argv[++C], instanceCount, 1, 4096); }
+        else if (arg == "--coverage" && hasValue) { streamOptions.coveragePath = argv[++C]; }
+        else if (arg == "--reorder")     { usingReorder = true; ordering = Ordering::LevelDfs; }
+        else if (arg == "--reorder-rcm") { usingReorder = true; ordering = Ordering::LevelRcm; }
+        else if (arg == "--record" && hasValue) { traceMode = EventTrace::Mode::Record; tracePath = argv[++C]; }
+        else if (arg == "--replay" && hasValue) { traceMode = EventTrace::Mode::Replay; tracePath = argv[++C]; }
+        else if (arg == "--autosave" && hasValue) { autosavePath = argv[++C]; }
+        else if (arg == "--restore" && hasValue) { restorePath = argv[++C]; }
+        else if (arg == "--place") { usingPlacer = true; }
+        
+        if (!isValid) {
+            std::cerr << "Invalid value for '" << arg << "': '" << argv[C] << "'\n"
+                      << "  --batch <vectors>  (at least 1)\n"
+                      << "  --memo <MiB>\n"
+                      << "  --lut <k>          (2 to " << LutGate::MAX_INPUTS << ")\n"
+                      << "  --workers <count>  (at least 1)\n"
+                      << "  --instances <count> (1 to 4096)\n";
+            return 1;
+        }
+    }
+    
+    // keeping stdout clean for the response-stream; diagnostics go to stderr instead
+    std::streambuf* const coutBuffer {std::cout.rdbuf()};
+    if (isBatchMode && (streamOptions.outputPath == "-")) { std::cout.rdbuf(std::cerr.rdbuf()); Log::SetOutput(stderr); }
+    
     std::cout << "Circuit Simulator\n";
     
     for (int C{0}; C < argc; ++C) {
@@ -85,46 +235,30 @@ int main(int argc, char** argv)
     }
     
     PrintProgramConfiguration();
-    
-    sf::ContextSettings contextSettings{}; contextSettings.antialiasingLevel = 16; // 16 is highest
-    sf::RenderWindow mainWindow (sf::VideoMode(1024, 1024), "Circuit Simulator", sf::Style::Close, contextSettings);
-    mainWindow.setFramerateLimit(framerateCap);
-    mainWindow.setVerticalSyncEnabled(usingVsync);
-    mainWindow.setPosition({2600, 0});
-    
-    std::cout << "antialiasing level: " << mainWindow.getSettings().antialiasingLevel << "\n\n";
+    MarkStartupPhase("configuration");
     
     int status = TextureStorage::Init(spriteScale);
     if(status != 0) { return status; }
+    MarkStartupPhase("textures");
     
-    SelectorWindow selectorWindow(spriteScale);
-    selectorWindow.setPosition({int(mainWindow.getPosition().x + mainWindow.getSize().x + 45), 0});
-    
-    #ifndef _ISDEBUG
-    // trying to regain keyboard/window focus from selectorWindow on startup
-    mainWindow.requestFocus();
-    mainWindow.setVisible(false);
-    mainWindow.setVisible(true);
-    mainWindow.requestFocus();
-    #endif
-    
-    sf::Sprite heldSprite = TextureStorage::GetSprite(selectorWindow.selection);
     ComponentMap components{};
     Component* selectedComponent{nullptr};
+    int selectedOutput{0}; // of 'selectedComponent' (cells have several)
     
     #ifdef CHECK_COMPONENT_PINCOUNT
-      bool tooManyInputs{false};
+      bool pinMismatch{false};
       for (int i{1}; i < LogicGate::LAST_ENUM; ++i) {
           Component& component = components.Push(LogicGate::OpType(i));
           component.SetPosition(i*96, i*64);
-          std::cout << component.Name() << std::format(": {} inputs", component.GetPinCount()) << '\n';
-          if(component.GetPinCount() > 2) tooManyInputs = true;
+          std::cout << component.Name() << std::format(": {} inputs, {} outputs", component.GetPinCount(), component.GetOutputCount()) << '\n';
+          if(component.GetPinCount() != std::size_t(LogicGate::InputCount(LogicGate::OpType(i)))) pinMismatch = true;
+          if(component.GetOutputCount() != std::size_t(LogicGate::OutputCount(LogicGate::OpType(i)))) pinMismatch = true;
           
           // staggered
           Component& componentTwo = components.Push(LogicGate::OpType(i));
           componentTwo.SetPosition(i*96, ((i-1)*64 + 512));
       }
-      if(tooManyInputs) { std::cerr << "\nError: #Inputs > 2 \n Exiting.\n"; return 3; }
+      if(pinMismatch) { std::cerr << "\nError: #Pins doesn't match 'LogicGate::InputCount/OutputCount' \n Exiting.\n"; return 3; }
       std::cout << "\n";
     #endif
     
@@ -134,20 +268,49 @@ int main(int argc, char** argv)
     MakeGlobalIO(globalOutput, false, {});
     std::cout << "\nGlobal Input = " << ReadIO(globalInputs) << "\n\n";
     
-    // printing truth tables
-    #define EVALTEST(a, b) std::cout << std::boolalpha << \
-    std::format( "  ({}, {}): {}\n", a, b, LogicGate::Eval(LogicGate::OpType(i), a, b) );
+    // a word-level adder of the inputs' low and high nibble; its sum drives four more global inputs
+    {
+        Datapath& datapath {components.datapath};
+        const int low {datapath.AddBus("low", 4)}, high {datapath.AddBus("high", 4)};
+        datapath.PackFrom(low, {0, 1, 2, 3});
+        datapath.PackFrom(high, {4, 5, 6, 7});
+        const int sum {datapath.AddBlock(WordBlock::ADD, low, high)};
+        datapath.buses[sum].name = "sum";
+        MakeGlobalIO(globalInputs, datapath, sum);
+        datapath.Levelize();
+        UpdateDatapath(globalInputs, datapath);
+        std::cout << "Word-level sum = " << ReadIO(globalInputs, datapath.toBits.back()) << "\n\n";
+    }
+    
+    // the fixed blocks are checked at compile time; here they check the runtime engine (and its passes) in turn
+    #ifdef _ISDEBUG
+    {
+        auto check = [](const auto& block) {
+            const Netlist netlist {block.ToNetlist()};
+            assert(block.MatchesNetlist(netlist));
+            assert(block.MatchesNetlist(Optimize(netlist)));
+            assert(block.MatchesNetlist(Reorder(netlist)));
+        };
+        check(FixedBlocks::Decoder2);
+        check(FixedBlocks::HalfAdder);
+        check(FixedBlocks::FullAdder);
+        check(FixedBlocks::Mux2);
+        check(FixedBlocks::Parity8);
+    }
+    #endif
     
-    for (int i{2}; i < LogicGate::LAST_ENUM; ++i) 
+    // printing truth tables, as the cubes of (A, B) for which each gate is true
     {
-        std::cout << LogicGate::GetName(LogicGate::OpType(i)) << "\n";
-        EVALTEST(true, true);
-        EVALTEST(true, false);
-        EVALTEST(false, true);
-        EVALTEST(false, false);
+        BddManager manager{2};
+        const BddManager::Ref A {manager.Var(1)}, B {manager.Var(0)};
+        for (int i{2}; i < LogicGate::FIRST_CELL; ++i) {
+            const BddManager::Ref F {manager.Apply(LogicGate::OpType(i), A, B)};
+            std::cout << std::format("{:>5}: ", LogicGate::GetName(LogicGate::OpType(i)));
+            for (const std::string& cube: manager.Cubes(F)) { std::cout << cube << ' '; }
+            std::cout << '\n';
+        }
         std::cout << '\n';
     }
-    #undef EVALTEST
     
     using BankT = std::vector<Component*>;
     std::vector<BankT> banks {
@@ -159,13 +322,13 @@ int main(int argc, char** argv)
     BankT* prev = nullptr;
     for (int bankIndex{0}; bankIndex < static_cast<int>(banks.size()); ++bankIndex) 
     {
-        std::cout << "\nbank #" << bankIndex << '\n';
+        Log::Debug("bank #{}", bankIndex);
         BankT& bank = banks[bankIndex];
         
         int I{0};
         for (Component* component: bank)
         {
-            std::cout << component->UUID() << '\n';
+            Log::Debug("{}", component->UUID());
             if (!prev) continue;
             assert(I < static_cast<int>(prev->size()));
             
@@ -173,7 +336,7 @@ int main(int argc, char** argv)
             {
                 if((component->gate.mType == LogicGate::NOT) && (K > 0)) break;
                 Pin* pin = &component->inputs[K];
-                std::cout << "  " << prev->at(I+K)->UUID() << " -> " << pin->UUID << '\n';
+                Log::Debug("  {} -> {}", prev->at(I+K)->UUID(), pin->UUID);
                 prev->at(I+K)->CreateConnection(component, pin);
             }
             I = ((I+2) % prev->size());
@@ -184,7 +347,7 @@ int main(int argc, char** argv)
     
     // linking to global inputs
     assert(banks.size() > 0);
-    std::cout << "\nGLOBAL INPUTS\n";
+    Log::Debug("GLOBAL INPUTS");
     BankT& firstBank = banks[0];
     std::size_t I{0};
     for (Component* component: firstBank) {
@@ -192,7 +355,7 @@ int main(int argc, char** argv)
         for (int K{0}; K < 2; ++K) {
             if((component->gate.mType == LogicGate::NOT) && (K > 0)) break;
             Pin* pin = &component->inputs[K];
-            std::cout << "  " << globalInputs.at(I+K).UUID() << " -> " << pin->UUID << '\n';
+            Log::Debug("  {} -> {}", globalInputs.at(I+K).UUID(), pin->UUID);
             globalInputs.at(I+K).CreateConnection(component, pin);
             globalInputs.at(I+K).PropagateLogic();
             component->PropagateLogic();
@@ -202,33 +365,247 @@ int main(int argc, char** argv)
     }
     
     // linking to global outputs
-    std::cout << "\nGLOBAL OUTPUTS\n";
+    Log::Debug("GLOBAL OUTPUTS");
     BankT& lastBank{banks[banks.size()-1]};
     const std::size_t numOutputs { (lastBank.size() <= globalOutput.size())? lastBank.size() : globalOutput.size()};
     for (std::size_t I{0}; I < numOutputs; ++I)
     {
         Component& component = globalOutput.at(I);
         Pin* pin = &component.inputs[0];
-        std::cout << "  " << lastBank.at(I)->UUID() << " -> " << pin->UUID << '\n';
+        Log::Debug("  {} -> {}", lastBank.at(I)->UUID(), pin->UUID);
         lastBank.at(I)->CreateConnection(&component, pin);
         lastBank.at(I)->PropagateLogic();
     }
+    // and the word-level sum straight through, to the outputs after those
+    const std::vector<Netlist::NetID>& sumBits {components.datapath.toBits.back().bits};
+    for (std::size_t K{0}; K < sumBits.size() && (numOutputs + K) < globalOutput.size(); ++K)
+    {
+        Component& component = globalOutput.at(numOutputs + K);
+        globalInputs.at(sumBits[K]).CreateConnection(&component, &component.inputs[0]);
+        globalInputs.at(sumBits[K]).PropagateLogic();
+    }
+    Log::Flush(); // the reports below are printed directly
     std::cout << "\n\n";
+    PrintOutputFunctions(Netlist::Extract(globalInputs, components, globalOutput));
+    MarkStartupPhase("circuit");
+    
+    if (isBatchMode && usingFourValued) {
+        // the other passes assume two-valued logic (and tie undriven nets to 'CONST0')
+        if (usingOptimizer || usingReorder || lutInputs || workerCount || (instanceCount > 1)) {
+            Log::Warning("'--four-valued' ignores '--optimize', '--reorder', '--lut', '--workers' and '--instances'");
+        }
+        const FourValuedNetlist netlist {Netlist::Extract(globalInputs, components, globalOutput, Netlist::Undriven::Floating)};
+        status = RunVectorStream(netlist, streamOptions);
+        Log::Flush();
+        std::cout.rdbuf(coutBuffer);
+        return status;
+    }
+    if (isBatchMode) {
+        Netlist netlist = Netlist::Extract(globalInputs, components, globalOutput);
+        if (netlist.datapath && (usingOptimizer || usingReorder || lutInputs || workerCount || (instanceCount > 1))) {
+            // each of these builds a new gate-level netlist, which wouldn't have the word blocks
+            Log::Warning("word-level blocks: ignoring '--optimize', '--reorder', '--lut', '--workers' and '--instances'");
+            usingOptimizer = usingReorder = false;
+            lutInputs = workerCount = 0;
+            instanceCount = 1;
+        }
+        if (usingOptimizer) {
+            OptimizeStats stats{};
+            Netlist optimized = Optimize(netlist, &stats);
+            std::cout << stats.Report();
+            #ifdef _ISDEBUG
+            assert(SimulateEquivalent(netlist, optimized));
+            #endif
+            netlist = std::move(optimized);
+        }
+        if (usingReorder) {
+            const std::size_t stride {std::max<std::size_t>(streamOptions.batchSize/64, 1)};
+            Netlist reordered = Reorder(netlist, ordering);
+            std::cout << MeasureLocality(netlist, 64, stride).Report("before reorder");
+            std::cout << MeasureLocality(reordered, 64, stride).Report("after reorder ");
+            #ifdef _ISDEBUG
+            assert(SimulateEquivalent(netlist, reordered));
+            #endif
+            netlist = std::move(reordered);
+        }
+        if (instanceCount > 1) {
+            // the (optimized/reordered) circuit becomes one definition, and every instance runs its schedule at once
+            if (lutInputs || workerCount) Log::Warning("'--instances' ignores '--lut' and '--workers'");
+            const SubcircuitDef definition {"canvas", netlist};
+            if (std::size_t(definition.NetCount())*instanceCount > std::size_t(std::numeric_limits<Netlist::NetID>::max())) {
+                Log::Error("{} instances of {} nets are too many", instanceCount, definition.NetCount());
+                status = 1;
+            } else {
+                const SubcircuitBank bank{definition, instanceCount};
+                #ifdef _ISDEBUG
+                assert(SimulateEquivalent(bank.Flatten(), bank));
+                #endif
+                Log::Info("{} instances of '{}': {} gates scheduled once, {} words of state per lane-word",
+                    instanceCount, definition.name, definition.gates.size(), std::size_t(definition.NetCount())*instanceCount);
+                status = RunVectorStream(bank, streamOptions);
+            }
+        } else if (workerCount > 0) {
+            Cluster cluster{};
+            if (!cluster.Start(netlist, workerCount, transport)) { status = 4; }
+            else {
+                #ifdef _ISDEBUG
+                assert(SimulateEquivalent(netlist, cluster));
+                #endif
+                status = RunVectorStream(cluster, streamOptions);
+                cluster.Stop();
+                Log::Flush();
+                std::cout << cluster.Report();
+            }
+        } else if (lutInputs > 0) {
+            LutMapStats stats{};
+            const LutNetlist mapped = MapToLuts(netlist, lutInputs, &stats);
+            std::cout << stats.Report();
+            #ifdef _ISDEBUG
+            assert(SimulateEquivalent(netlist, mapped));
+            #endif
+            status = RunVectorStream(mapped, streamOptions);
+        } else { status = RunVectorStream(netlist, streamOptions); }
+        std::cout.rdbuf(coutBuffer);
+        return status;
+    }
+    
+    // only the drag-line is ever rotated; everything else is axis-aligned, so 4x is plenty (16 is highest)
+    sf::ContextSettings contextSettings{}; contextSettings.antialiasingLevel = 4;
+    sf::RenderWindow mainWindow (sf::VideoMode(1024, 1024), "Circuit Simulator", sf::Style::Close, contextSettings);
+    mainWindow.setFramerateLimit(framerateCap);
+    mainWindow.setVerticalSyncEnabled(usingVsync);
+    
+    EventTrace trace{};
+    if (!trace.Open(traceMode, tracePath)) { Log::Error("Failed to open event-trace: '{}'", tracePath); return 1; }
+    if (trace.IsReplaying()) { mainWindow.setFramerateLimit(0); mainWindow.setVerticalSyncEnabled(false); }
+    mainWindow.setPosition({2600, 0});
+    
+    std::cout << "antialiasing level: " << mainWindow.getSettings().antialiasingLevel << "\n\n";
+    
+    // not opened until it's requested (tilde or mouse-wheel), so it can't steal focus on startup
+    SelectorWindow selectorWindow(spriteScale);
+    selectorWindow.windowPosition = {int(mainWindow.getPosition().x + mainWindow.getSize().x + 45), 0};
+    
+    sf::Sprite heldSprite = TextureStorage::GetSprite(selectorWindow.selection);
+    
+    // static layers of the canvas; the held sprite and drag-line are drawn on top, uncached
+    RenderCache renderCache{};
+    const bool usingRenderCache {renderCache.Create(mainWindow.getSize())};
+    if (!usingRenderCache) std::cerr << "Failed to create render-cache; drawing uncached\n";
+    
+    // optional free-running simulation on its own thread ('T' toggles); edits re-send the extracted netlist
+    SimulationThread simulation{};
+    std::shared_ptr<const Netlist> simulatedNetlist{};
+    std::vector<Component*> shownChanges{}; // components whose outputs the latest snapshot changed (reused every frame)
+    auto LoadSimulation = [&]()
+    {
+        if (!simulation.IsStarted()) return;
+        simulatedNetlist = std::make_shared<const Netlist>(Netlist::Extract(globalInputs, components, globalOutput));
+        std::vector<bool> inputValues{};
+        for (const Component& component: globalInputs) { inputValues.push_back(component.ReadState()); }
+        while (!simulation.Post({SimulationThread::Command::Load, simulatedNetlist, inputValues})) { std::this_thread::yield(); }
+    };
+    
+    // static timing ('C' toggles); while shown, edits update it incrementally and the critical path is outlined
+    TimingGraph timing{};
+    auto ReportTiming = [&]() {
+        if (!timing.IsBuilt()) return;
+        Log::Info("timing: critical delay {:.2f} ({} levels); updated in {:.0f}us ({} visits)",
+            timing.CriticalDelay(), timing.Depth(), timing.LastUpdateMicroseconds(), timing.LastUpdateVisits());
+    };
+    
+    // topological order of the canvas, maintained connection by connection; orders each transaction's repropagation
+    ComponentOrder componentOrder{};
+    componentOrder.Build(globalInputs, components, globalOutput);
+    
+    // transitive fanin/fanout cones, cached between the edits that touch them; clicking an input-pin (or 'F') highlights one
+    ConeIndex cones{};
+    cones.Build(globalInputs, components, globalOutput);
+    Component* coneRoot{nullptr};
+    ConeIndex::Direction coneDirection{ConeIndex::Direction::Fanin};
+    auto ShowCone = [&](Component* root, ConeIndex::Direction direction) {
+        coneRoot = root; coneDirection = direction;
+        if (!root) { Log::Info("cone: hidden"); return; }
+        const bool isFanin {direction == ConeIndex::Direction::Fanin};
+        const ConeIndex::Cone& cone {cones.Query(root, direction)};
+        std::string boundary{};
+        for (const Component* component: cone.boundary) { boundary += std::format(" {}={}", component->UUID(), int(component->ReadState())); }
+        Log::Info("{} cone of {}: {} components in {:.0f}us{} | {}:{}", (isFanin? "fanin" : "fanout"), root->UUID(), cone.members.size(),
+            cones.LastQueryMicroseconds(), (cones.LastQueryWasCached()? " (cached)" : ""), (isFanin? "driven by" : "reaching"), boundary);
+    };
+    
+    // copy-on-write checkpoints: 'S' takes one (and saves it), 'L' restores it; autosaved every 30s when something changed
+    Checkpointer checkpoints{};
+    auto Observers = [&]() { return EditObservers{(timing.IsBuilt()? &timing : nullptr), &componentOrder, &checkpoints, &cones}; };
+    if (!restorePath.empty()) {
+        const std::optional<Checkpoint> restored {Checkpoint::Read(restorePath)};
+        if (restored && checkpoints.Restore(*restored, globalInputs, components, globalOutput, Observers())) {
+            Log::Info("restored {} components from '{}'", restored->ComponentCount(), restorePath);
+        } else Log::Error("Failed to restore checkpoint: '{}'", restorePath);
+    }
+    if (usingPlacer) { Log::Flush(); std::cout << Place(globalInputs, components, globalOutput).Report(); }
+    Checkpoint knownState {checkpoints.Take(globalInputs, components, globalOutput)}; // so an untouched canvas is never autosaved
+    sf::Clock autosaveClock{};
+    
+    // switching-activity heatmap ('A' toggles): the same 64k random input-vectors through the extracted netlist, rerun after edits
+    bool showingHeatmap{false};
+    std::vector<std::pair<const Component*, double>> heatmap{};
+    auto UpdateHeatmap = [&](bool isReporting=false) {
+        if (!showingHeatmap) return;
+        const Netlist netlist {Netlist::Extract(globalInputs, components, globalOutput)};
+        constexpr std::size_t stride{1024};
+        std::vector<Netlist::Word> state {netlist.MakeState(stride)};
+        std::mt19937_64 random{};
+        for (Netlist::NetID N: netlist.inputs) { std::generate_n(&state[N*stride], stride, std::ref(random)); }
+        netlist.Evaluate(state.data(), stride, stride);
+        
+        ToggleCoverage coverage{};
+        coverage.Reset(netlist.NetCount());
+        coverage.Accumulate(state.data(), stride, stride*64);
+        heatmap.clear();
+        for (Netlist::NetID N{1}; N < netlist.NetCount(); ++N) {
+            if (netlist.origin[N] && !netlist.origin[N]->IsCell()) heatmap.emplace_back(netlist.origin[N], coverage.Activity(N));
+        }
+        // a cell's internal nets aren't any of its pins, so it shows its most active output
+        for (const auto& [cell, outputs]: netlist.cellOutputs) {
+            double activity{0.0};
+            for (Netlist::NetID N: outputs) { activity = std::max(activity, coverage.Activity(N)); }
+            heatmap.emplace_back(cell, activity);
+        }
+        if (!isReporting) return;
+        Log::Flush();
+        std::cout << '\n' << coverage.Report(netlist.origin, netlist.cellOutputs);
+    };
+    auto RestoreKnownState = [&]() {
+        const sf::Clock restoreClock{};
+        if (!checkpoints.Restore(knownState, globalInputs, components, globalOutput, Observers())) return;
+        selectedComponent = nullptr;
+        Log::Info("restored checkpoint #{} ({} components) in {:.2f}ms",
+            knownState.sequence, knownState.ComponentCount(), restoreClock.getElapsedTime().asMicroseconds()/1000.0);
+        LoadSimulation();
+        ReportTiming();
+        UpdateHeatmap();
+    };
+    MarkStartupPhase("windows");
+    bool isFirstFrame{true};
     
     
     while (mainWindow.isOpen())
     {
-        if (selectorWindow.isOpen()) {
+        if (selectorWindow.isOpen() && !trace.IsReplaying()) {
             selectorWindow.EventLoop();
             selectorWindow.Redraw();
-            if (selectorWindow.selectionHasChanged) {
-                heldSprite = TextureStorage::GetSprite(selectorWindow.selection);
-                selectorWindow.selectionHasChanged = false;
-            }
+        }
+        // the selector's own events aren't traced; only the selection they result in
+        const auto tracedSelection {LogicGate::OpType(trace.Sample(selectorWindow.selection))};
+        if (tracedSelection != selectorWindow.selection) selectorWindow.SetSelection(tracedSelection);
+        if (selectorWindow.selectionHasChanged) {
+            heldSprite = TextureStorage::GetSprite(selectorWindow.selection);
+            selectorWindow.selectionHasChanged = false;
         }
         
         sf::Event event;
-        while(mainWindow.pollEvent(event))
+        while(trace.PollEvent(mainWindow, event))
         {
             switch(event.type)
             {
@@ -245,6 +622,7 @@ int main(int argc, char** argv)
                         break;
                         
                         case sf::Keyboard::Tilde:
+                            if(!selectorWindow.isOpen()) { selectorWindow.Create(); }
                             selectorWindow.setVisible(true);
                             selectorWindow.requestFocus();
                         break;
@@ -270,16 +648,18 @@ int main(int argc, char** argv)
                         
                         case sf::Keyboard::Space:
                         {
+                            UpdateDatapath(globalInputs, components.datapath);
                             for(Component& component: globalInputs) { component.PropagateLogic(); }
                             components.ForEach([](Component& component) { component.PropagateLogic(); });
                             for(Component& component: globalOutput) { component.PropagateLogic(); }
+                            checkpoints.TouchAll();
                             
                             {
                                 // don't reprint output if it hasn't changed
                                 static int prevResult {-1};
                                 const int result = ReadIO(globalOutput);
                                 if (result == prevResult) break;
-                                std::cout << "\nGlobal Output = " << result << "\n\n";
+                                Log::Info("Global Output = {}", result);
                                 prevResult = result;
                             }
                         }
@@ -287,36 +667,171 @@ int main(int argc, char** argv)
                         
                         case sf::Keyboard::H:
                             Pin::displayHitboxes = !Pin::displayHitboxes;
-                            std::cout << "\npins' hitboxes: " << (Pin::displayHitboxes? "shown" : "hidden") << "\n\n";
+                            Log::Info("pins' hitboxes: {}", (Pin::displayHitboxes? "shown" : "hidden"));
                             
                             for(Component& component: globalInputs) { component.UpdateLeadColors(); }
                             for(Component& component: globalOutput) { component.UpdateLeadColors(); }
                             components.ForEach([](Component& component){ component.UpdateLeadColors(); });
+                            renderCache.Invalidate(); // hitbox-display isn't part of the components' signatures
                         break;
                         
                         case sf::Keyboard::J:
                             Pin::hideConnectedHitboxes = !Pin::hideConnectedHitboxes;
-                            std::cout << "\nconnected pins' hitboxes: " << (Pin::hideConnectedHitboxes? "hidden" : "shown") << "\n\n";
+                            Log::Info("connected pins' hitboxes: {}", (Pin::hideConnectedHitboxes? "hidden" : "shown"));
                             
                             for(Component& component: globalInputs) { component.UpdateLeadColors(); }
                             for(Component& component: globalOutput) { component.UpdateLeadColors(); }
                             components.ForEach([](Component& component){ component.UpdateLeadColors(); });
+                            renderCache.Invalidate(); // hitbox-display isn't part of the components' signatures
+                        break;
+                        
+                        case sf::Keyboard::O:
+                        {
+                            // reporting only; the canvas itself is never rewritten
+                            OptimizeStats stats{};
+                            const Netlist netlist = Netlist::Extract(globalInputs, components, globalOutput);
+                            if (netlist.datapath) { Log::Warning("optimizer: skipped (word-level blocks)"); break; }
+                            const Netlist optimized = Optimize(netlist, &stats);
+                            Log::Flush(); // keeping the report in order with logged lines
+                            std::cout << '\n' << stats.Report();
+                            std::cout << "equivalent at global outputs: " << std::boolalpha << SimulateEquivalent(netlist, optimized) << "\n\n";
+                        }
+                        break;
+                        
+                        case sf::Keyboard::B:
+                            Log::Flush();
+                            std::cout << '\n';
+                            PrintOutputFunctions(Netlist::Extract(globalInputs, components, globalOutput));
+                        break;
+                        
+                        case sf::Keyboard::X:
+                        {
+                            // four-valued check of the current inputs: unconnected pins float (Z) instead of reading false
+                            const FourValuedNetlist netlist {Netlist::Extract(globalInputs, components, globalOutput, Netlist::Undriven::Floating)};
+                            std::vector<Netlist::Word> state {netlist.MakeState()};
+                            for (std::size_t I{0}; I < netlist.Source().inputs.size(); ++I) { // the driven inputs come last
+                                FourValuedNetlist::Write(state.data(), 1, netlist.Source().inputs[I], 0, (globalInputs[I].ReadState()? Logic4::One : Logic4::Zero));
+                            }
+                            netlist.Evaluate(state);
+                            std::string outputs{};
+                            for (std::size_t I{netlist.Source().outputs.size()}; I-- > 0;) {
+                                outputs.push_back(ToChar(FourValuedNetlist::Read(state.data(), 1, netlist.Source().outputs[I], 0)));
+                            }
+                            Log::Info("four-valued output (output{}..output1) = {} | {} unconnected gate-inputs", globalOutput.size(), outputs, netlist.UndrivenReads());
+                        }
+                        break;
+                        
+                        case sf::Keyboard::T:
+                            if (!simulation.IsStarted()) {
+                                simulation.Start();
+                                LoadSimulation();
+                                simulation.Post({SimulationThread::Command::SetRunning, {}, {}, 0, true});
+                                Log::Info("simulation thread: free-running");
+                            } else {
+                                simulation.Stop();
+                                simulatedNetlist.reset();
+                                Log::Info("simulation thread: stopped after {} iterations", simulation.Iterations());
+                            }
+                        break;
+                        
+                        case sf::Keyboard::C:
+                            if (!timing.IsBuilt()) {
+                                timing.Build(globalInputs, components, globalOutput);
+                                Log::Flush();
+                                std::cout << '\n' << timing.Report();
+                            } else {
+                                timing.Clear();
+                                Log::Info("timing: hidden");
+                            }
+                        break;
+                        
+                        case sf::Keyboard::A:
+                            showingHeatmap = !showingHeatmap;
+                            if (showingHeatmap) { UpdateHeatmap(true); }
+                            else { heatmap.clear(); Log::Info("activity heatmap: hidden"); }
+                        break;
+                        
+                        case sf::Keyboard::S:
+                            knownState = checkpoints.Take(globalInputs, components, globalOutput);
+                            Log::Info("checkpoint #{}: {} components; {} pages copied in {:.0f}us",
+                                knownState.sequence, knownState.ComponentCount(), checkpoints.LastPagesCopied(), checkpoints.LastTakeMicroseconds());
+                            if (!autosavePath.empty()) { checkpoints.SaveAsync(knownState, autosavePath); autosaveClock.restart(); }
+                        break;
+                        
+                        case sf::Keyboard::L:
+                            RestoreKnownState();
+                        break;
+                        
+                        case sf::Keyboard::F:
+                        {
+                            // the fanout-cone of an output-pin, the fanin-cone of anything else; hidden over empty space
+                            const sf::Vector2f mousePosition{ trace.MousePosition(mainWindow) };
+                            Component* root{nullptr};
+                            ConeIndex::Direction direction{ConeIndex::Direction::Fanin};
+                            auto search = [&](Component& component) {
+                                if (component.isOutputPinClicked(mousePosition)) direction = ConeIndex::Direction::Fanout;
+                                else if (!component.ContainsCoord(mousePosition)) return false;
+                                root = &component; ComponentMap::Break(); return true;
+                            };
+                            for(Component& component: globalInputs) { if(!root) search(component); }
+                            for(Component& component: globalOutput) { if(!root) search(component); }
+                            if (!root) components.ForEach(search);
+                            ShowCone(root, direction);
+                        }
+                        break;
+                        
+                        case sf::Keyboard::G:
+                        {
+                            // memoizes the components whose bodies lie within a 256px box around the cursor as one group
+                            // of the simulation thread; with shift held, every group is dropped instead
+                            if (!simulation.IsStarted()) { Log::Info("memoized groups: start the simulation thread ('T') first"); break; }
+                            SimulationThread::Command command{SimulationThread::Command::Group};
+                            if (!event.key.shift) {
+                                const sf::Vector2f mousePosition{ trace.MousePosition(mainWindow) };
+                                const sf::FloatRect box {mousePosition - sf::Vector2f{128.f, 128.f}, {256.f, 256.f}};
+                                components.ForEach([&](Component& component) {
+                                    if (box.intersects(component.GetSpriteBounds())) command.group.push_back(&component);
+                                });
+                                if (command.group.empty()) break;
+                            }
+                            while (!simulation.Post(command)) { std::this_thread::yield(); }
+                        }
+                        break;
+                        
+                        case sf::Keyboard::P:
+                        {
+                            selectedComponent = nullptr;
+                            const PlacementStats stats {Place(globalInputs, components, globalOutput)};
+                            Log::Flush();
+                            std::cout << '\n' << stats.Report();
+                            checkpoints.TouchAll(); // every position may have changed
+                            renderCache.Invalidate();
+                        }
                         break;
                         
                         case sf::Keyboard::Delete:
                         {
                             selectedComponent = nullptr;
-                            const sf::Vector2f mousePosition{ sf::Mouse::getPosition(mainWindow) };
+                            const sf::Vector2f mousePosition{ trace.MousePosition(mainWindow) };
+                            // with shift held, every component whose body lies partly within a 256px box around the cursor is deleted (its outgoing wires don't count)
+                            const bool isBoxDelete {event.key.shift};
+                            const sf::FloatRect box {mousePosition - sf::Vector2f{128.f, 128.f}, {256.f, 256.f}};
+                            EditTransaction edit{globalInputs, components, globalOutput, Observers()};
                             auto search = [&](Component& component)
                             {
-                                if(component.ContainsCoord(mousePosition)) {
-                                    std::cout << "Deleting: " << component.UUID() << '\n';
-                                    component.RemoveAllConnections();
-                                    components.Remove(component);
-                                    ComponentMap::Break(); return true;
+                                if (isBoxDelete? box.intersects(component.GetSpriteBounds()) : component.ContainsCoord(mousePosition)) {
+                                    Log::Info("Deleting: {}", component.UUID());
+                                    edit.Delete(component);
+                                    if (!isBoxDelete) ComponentMap::Break();
+                                    return true;
                                 } return false;
                             };
                             components.ForEach(search);
+                            if (edit.EditCount() == 0) break;
+                            edit.Commit();
+                            LoadSimulation();
+                            ReportTiming();
+                            UpdateHeatmap();
                         }
                         break;
                         
@@ -340,24 +855,25 @@ int main(int argc, char** argv)
                     {
                         case sf::Mouse::Button::Left:
                         if (selectorWindow.selection > 0) // place component if it's not 'EQ'
-                        { components.Push(selectorWindow.selection, heldSprite); }
+                        { checkpoints.Touch(&components.Push(selectorWindow.selection, heldSprite)); }
                         else
                         {
                             bool hitboxFound{false};
                             std::string identifier;
-                            const sf::Vector2f mousePosition{ sf::Mouse::getPosition(mainWindow) };
+                            const sf::Vector2f mousePosition{ trace.MousePosition(mainWindow) };
+                            Component* faninRoot{nullptr};
                             
                             auto lambda = [&](Component& component)
                             {
-                                if (component.isOutputPinClicked(mousePosition)) {
-                                    identifier = std::format("{} output-pin", component.UUID());
-                                    hitboxFound = true; selectedComponent = &component;
-                                    component.HighlightOutputPin(); mainWindow.draw(component); // draw the highlight before screencap
-                                    MouseDragLoop(mainWindow, mousePosition, component.ReadState());
-                                    component.HighlightOutputPin(false); ComponentMap::Break(); return true;
+                                if (const int output {component.getClickedOutput(mousePosition)}; output >= 0) {
+                                    identifier = std::format("{} output-pin {}", component.UUID(), output);
+                                    hitboxFound = true; selectedComponent = &component; selectedOutput = output;
+                                    component.HighlightOutputPin(true, output); mainWindow.draw(component); // draw the highlight before screencap
+                                    MouseDragLoop(mainWindow, trace, mousePosition, component.ReadOutput(output));
+                                    component.HighlightOutputPin(false, output); ComponentMap::Break(); return true;
                                 } else if(component.inputHitboxClicked(mousePosition)) {
                                     identifier = std::format("{} input-pin", component.UUID());
-                                    hitboxFound = true; selectedComponent = nullptr; ComponentMap::Break(); return true;
+                                    hitboxFound = true; selectedComponent = nullptr; faninRoot = &component; ComponentMap::Break(); return true;
                                 } else if(component.ContainsCoord(mousePosition)) {
                                     #ifdef _ISDEBUG
                                     component.PrintConnections();
@@ -373,24 +889,25 @@ int main(int argc, char** argv)
                             
                             endSearch:
                             if (!hitboxFound) identifier = "empty click";
-                            std::cout << std::format("{} @({}, {})", identifier, mousePosition.x, mousePosition.y);
-                            if (!selectedComponent) std::cout << '\n';
+                            Log::Info("{} @({}, {})", identifier, mousePosition.x, mousePosition.y);
+                            if (faninRoot) ShowCone(faninRoot, ConeIndex::Direction::Fanin);
                         }
                         break;
                         
                         case sf::Mouse::Button::Right:
                         {
                             bool hitboxFound{false};
-                            const sf::Vector2f mousePosition{ sf::Mouse::getPosition(mainWindow) };
+                            const sf::Vector2f mousePosition{ trace.MousePosition(mainWindow) };
+                            EditTransaction edit{globalInputs, components, globalOutput, Observers()};
                             auto lambda = [&](Component& component)
                             {
                                 if(component.ContainsCoord(mousePosition)) {
                                     std::string identifier = std::format("{}", component.UUID());
-                                    std::cout << std::format("disconnecting: {} @({}, {})\n", identifier, mousePosition.x, mousePosition.y);
+                                    Log::Info("disconnecting: {} @({}, {})", identifier, mousePosition.x, mousePosition.y);
                                     #ifdef _ISDEBUG
                                     component.PrintConnections();
                                     #endif
-                                    component.RemoveAllConnections();
+                                    edit.Disconnect(component);
                                     selectedComponent = nullptr;
                                     //selectedComponent = &component;
                                     hitboxFound = true; ComponentMap::Break(); return true;
@@ -402,11 +919,11 @@ int main(int argc, char** argv)
                             components.ForEach(lambda);
                             
                             endSearch2:
-                            if (!hitboxFound) { std::cout << "empty right-click\n"; break; }
-                            // don't need to do this for inputs because their state never changes
-                            for(Component& component: globalInputs) { component.Update(); component.PropagateLogic(); component.UpdateLeadColors(); }
-                            for(Component& component: globalOutput) { component.Update(); component.PropagateLogic(); component.UpdateLeadColors(); }
-                            components.ForEach([](Component& component){ component.Update(); component.PropagateLogic(); component.UpdateLeadColors(); });
+                            if (!hitboxFound) { Log::Info("empty right-click"); break; }
+                            edit.Commit(); // repropagates the disconnected component's fanout-cone only
+                            LoadSimulation();
+                            ReportTiming();
+                            UpdateHeatmap();
                         }
                         break;
                         
@@ -421,15 +938,18 @@ int main(int argc, char** argv)
                     if (!selectedComponent) break; // only output pins can be routed to input
                     
                     bool hitboxFound{false};
-                    const sf::Vector2f mousePosition{ sf::Mouse::getPosition(mainWindow) };
+                    const sf::Vector2f mousePosition{ trace.MousePosition(mainWindow) };
+                    EditTransaction edit{globalInputs, components, globalOutput, Observers()};
                     auto lambda = [&](Component& component) {
                         if (component.inputHitboxClicked(mousePosition)) {
-                            std::cout << std::format(" -> {} input-pin @({}, {})\n",
-                                component.UUID(), mousePosition.x, mousePosition.y);
+                            Log::Info("  -> {} input-pin @({}, {})", component.UUID(), mousePosition.x, mousePosition.y);
                             hitboxFound = true;
-                            selectedComponent->CreateConnection(&component, component.getClickedInput(mousePosition));
-                            selectedComponent->PropagateLogic();
-                            component.PropagateLogic();
+                            std::vector<Component*> cycle{};
+                            if (!edit.Connect(*selectedComponent, component, component.getClickedInput(mousePosition), selectedOutput, &cycle)) {
+                                std::string loop{};
+                                for (const Component* member: cycle) { loop += ' ' + member->UUID(); }
+                                Log::Warning("connection closes a combinational loop of {} components:{}", cycle.size(), loop);
+                            }
                             ComponentMap::Break(); return true;
                         } return false;
                     };
@@ -439,9 +959,9 @@ int main(int argc, char** argv)
                     components.ForEach(lambda);
                     
                     endSearch3:
-                    if (!hitboxFound) std::cout << '\n'; // flushing held output
                     selectedComponent = nullptr;
-                    if(hitboxFound) components.ForEach([](Component& component){ component.Update(); component.PropagateLogic(); component.UpdateLeadColors(); });
+                    edit.Commit();
+                    if(hitboxFound) { LoadSimulation(); ReportTiming(); UpdateHeatmap(); }
                 }
                 break;
                 
@@ -449,21 +969,98 @@ int main(int argc, char** argv)
             }
         }
         
+        if (simulation.IsStarted()) {
+            if (const SimulationThread::Snapshot* snapshot = simulation.Latest()) {
+                shownChanges.clear();
+                ApplySnapshot(*snapshot, simulatedNetlist, shownChanges);
+                for (const Component* component: shownChanges) { checkpoints.Touch(component); }
+            }
+        }
+        
+        // the snapshot is O(changed pages) here; serializing and fsync happen on the checkpointer's thread
+        if (!autosavePath.empty() && checkpoints.HasChanges() && autosaveClock.getElapsedTime().asSeconds() > 30.f) {
+            checkpoints.SaveAsync(checkpoints.Take(globalInputs, components, globalOutput), autosavePath);
+            autosaveClock.restart();
+            if (checkpoints.LastSaveFailed()) Log::Warning("last autosave to '{}' failed", autosavePath);
+        }
+        
         mainWindow.clear(backgroundColor);
         
-        for(const Component& component: globalInputs) { mainWindow.draw(component); }
-        for(const Component& component: globalOutput) { mainWindow.draw(component); }
-        components.ForEach([&mainWindow](const Component& component){ mainWindow.draw(component); });
+        if (usingRenderCache) {
+            renderCache.Update(globalInputs, globalOutput, components); // only re-renders tiles that changed
+            renderCache.Draw(mainWindow);
+        } else {
+            for(const Component& component: globalInputs) { mainWindow.draw(component); }
+            for(const Component& component: globalOutput) { mainWindow.draw(component); }
+            components.ForEach([&mainWindow](const Component& component){ mainWindow.draw(component); });
+        }
+        
+        if (timing.IsBuilt()) {
+            // outlines aren't part of the render-cache; the path is short, so it's recomputed every frame
+            sf::RectangleShape outline{};
+            outline.setFillColor(sf::Color::Transparent);
+            outline.setOutlineColor(sf::Color(0xFF8800DD));
+            outline.setOutlineThickness(3.f);
+            for (const Component* component: timing.CriticalPath()) {
+                const sf::FloatRect bounds {component->GetSpriteBounds()};
+                outline.setPosition(bounds.left, bounds.top);
+                outline.setSize({bounds.width, bounds.height});
+                mainWindow.draw(outline);
+            }
+        }
+        
+        if (coneRoot && !cones.Contains(coneRoot)) coneRoot = nullptr; // deleted
+        if (coneRoot) {
+            // cached until an edit touches the cone, so this is a lookup on most frames
+            const ConeIndex::Cone& cone {cones.Query(coneRoot, coneDirection)};
+            sf::RectangleShape outline{};
+            outline.setFillColor(sf::Color::Transparent);
+            outline.setOutlineColor((coneDirection == ConeIndex::Direction::Fanin)? sf::Color(0x33CCFFDD) : sf::Color(0xDD44FFDD));
+            outline.setOutlineThickness(2.f);
+            for (const Component* component: cone.members) {
+                const sf::FloatRect bounds {component->GetSpriteBounds()};
+                outline.setPosition(bounds.left, bounds.top);
+                outline.setSize({bounds.width, bounds.height});
+                mainWindow.draw(outline);
+            }
+        }
+        
+        if (showingHeatmap) {
+            // blue (quiet) to red (toggling on every vector); grey for components that never toggled
+            sf::RectangleShape tint{};
+            for (const auto& [component, activity]: heatmap) {
+                const float T {std::min(float(activity)*2.f, 1.f)};
+                tint.setFillColor((activity > 0.0)? sf::Color(std::uint8_t(255*T), 64, std::uint8_t(255*(1.f - T)), 0x66) : sf::Color(0x80808088));
+                const sf::FloatRect bounds {component->GetSpriteBounds()};
+                tint.setPosition(bounds.left, bounds.top);
+                tint.setSize({bounds.width, bounds.height});
+                mainWindow.draw(tint);
+            }
+        }
         
         if (selectorWindow.selection > 0)
         {
-            const auto&& [x, y] = sf::Mouse::getPosition(mainWindow);
-            heldSprite.setPosition(x-64, y-32); // offsets to center it
+            const auto&& [x, y] = trace.MousePosition(mainWindow);
+            const sf::FloatRect bounds {heldSprite.getGlobalBounds()};
+            heldSprite.setPosition(x - bounds.width/2.f, y - bounds.height/2.f); // offsets to center it
             mainWindow.draw(heldSprite);
         }
         
         mainWindow.display();
+        trace.EndFrame();
+        if (trace.IsReplaying() && trace.IsFinished()) mainWindow.close();
+        
+        if (isFirstFrame) {
+            MarkStartupPhase("first frame");
+            PrintStartupPhases();
+            isFirstFrame = false;
+        }
     }
     
+    if (trace.GetMode() != EventTrace::Mode::Off) { Log::Flush(); std::cout << '\n' << trace.Report(); }
+    if (!autosavePath.empty() && checkpoints.HasChanges()) {
+        checkpoints.SaveAsync(checkpoints.Take(globalInputs, components, globalOutput), autosavePath);
+    }
+    checkpoints.Flush();
     return 0;
 }
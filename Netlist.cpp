@@ -0,0 +1,198 @@
+#include "Netlist.hpp"
+#include "ComponentMap.hpp"
+#include "StaticNetlist.hpp" // 'CellBlocks'
+#include "Datapath.hpp"
+
+#include <unordered_map>
+#include <type_traits>
+#include <algorithm>
+#include <cassert>
+
+
+bool Netlist::Levelize()
+{
+    const std::size_t gateCount{gates.size()};
+    std::vector<int> driver(netCount, -1); // gate-index driving each net
+    for (std::size_t I{0}; I < gateCount; ++I) { driver[gates[I].out] = int(I); }
+
+    // fanout of each gate in CSR form; duplicate fanins (A == B) are counted twice, which is harmless
+    std::vector<int> pending(gateCount, 0);
+    std::vector<int> fanoutStart(gateCount+1, 0);
+    auto forEachFanin = [&](const Gate& gate, auto&& lambda) {
+        lambda(gate.A);
+        if(!LogicGate::IsUnary(gate.type)) lambda(gate.B);
+    };
+    for (std::size_t I{0}; I < gateCount; ++I) {
+        forEachFanin(gates[I], [&](NetID N){ if(driver[N] >= 0) { ++pending[I]; ++fanoutStart[driver[N]+1]; } });
+    }
+    for (std::size_t I{0}; I < gateCount; ++I) { fanoutStart[I+1] += fanoutStart[I]; }
+    std::vector<int> fanout(fanoutStart.back());
+    {
+        std::vector<int> fill{fanoutStart.begin(), fanoutStart.end()-1};
+        for (std::size_t I{0}; I < gateCount; ++I) {
+            forEachFanin(gates[I], [&](NetID N){ if(driver[N] >= 0) fanout[fill[driver[N]]++] = int(I); });
+        }
+    }
+
+    // Kahn's algorithm, one level at a time; each level keeps the gates' existing relative order
+    std::vector<int> order; order.reserve(gateCount);
+    std::vector<int> current;
+    for (std::size_t I{0}; I < gateCount; ++I) { if(pending[I] == 0) current.push_back(int(I)); }
+
+    levelStart.clear();
+    while (!current.empty())
+    {
+        levelStart.push_back(int(order.size()));
+        std::vector<int> next;
+        for (int G: current) {
+            order.push_back(G);
+            for (int K{fanoutStart[G]}; K < fanoutStart[G+1]; ++K) {
+                if(--pending[fanout[K]] == 0) next.push_back(fanout[K]);
+            }
+        }
+        std::sort(next.begin(), next.end());
+        current.swap(next);
+    }
+
+    const bool isAcyclic{order.size() == gateCount};
+    if (!isAcyclic) {
+        levelStart.push_back(int(order.size()));
+        for (std::size_t I{0}; I < gateCount; ++I) { if(pending[I] > 0) order.push_back(int(I)); }
+    }
+
+    std::vector<Gate> sorted; sorted.reserve(gateCount);
+    for (int G: order) { sorted.push_back(gates[G]); }
+    gates.swap(sorted);
+    isLevelized = true;
+    hasLoops = !isAcyclic;
+    return isAcyclic;
+}
+
+
+void Netlist::EvaluateGate(const Gate& gate, Word* state, std::size_t stride, std::size_t count)
+{
+    Word* out {state + gate.out*stride};
+    const Word* A {state + gate.A*stride};
+    const Word* B {state + gate.B*stride};
+
+    // dispatching once per gate, so the inner loop is a plain (vectorizable) bitwise op
+    auto kernel = [&](auto&& op) { for (std::size_t W{0}; W < count; ++W) { out[W] = op(A[W], B[W]); } };
+    switch(gate.type) {
+        case LogicGate::EQ:   kernel([](Word a, Word  ) { return  a; });      break;
+        case LogicGate::NOT:  kernel([](Word a, Word  ) { return ~a; });      break;
+        case LogicGate::OR:   kernel([](Word a, Word b) { return  (a | b); }); break;
+        case LogicGate::NOR:  kernel([](Word a, Word b) { return ~(a | b); }); break;
+        case LogicGate::AND:  kernel([](Word a, Word b) { return  (a & b); }); break;
+        case LogicGate::NAND: kernel([](Word a, Word b) { return ~(a & b); }); break;
+        case LogicGate::XOR:  kernel([](Word a, Word b) { return  (a ^ b); }); break;
+        case LogicGate::XNOR: kernel([](Word a, Word b) { return ~(a ^ b); }); break;
+        default:              kernel([](Word  , Word  ) { return Word{0}; }); break;
+    }
+    return;
+}
+
+
+void Netlist::Evaluate(Word* state, std::size_t stride, std::size_t count) const
+{
+    if (datapath) EvaluateWords(state, stride, count);
+    for (const Gate& gate: gates) { EvaluateGate(gate, state, stride, count); }
+    return;
+}
+
+
+void Netlist::EvaluateWords(Word* state, std::size_t stride, std::size_t count) const
+{
+    // each lane-word is 64 vectors; the buses hold one value per vector
+    std::vector<Datapath::Word> values {datapath->MakeValues(count*64)};
+    datapath->Gather(state, stride, values.data(), count*64);
+    datapath->Evaluate(values.data(), count*64);
+    datapath->Scatter(values.data(), count*64, state, stride);
+    return;
+}
+
+
+Netlist Netlist::Extract(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput,
+                         Undriven undriven)
+{
+    Netlist netlist{};
+    std::unordered_map<const Component*, NetID> netOf{};
+    const bool isFloating {undriven == Undriven::Floating};
+    NetID floating {CONST0}; // created on first use
+    auto unconnected = [&]() { if (isFloating && floating == CONST0) floating = netlist.NewNet(); return floating; };
+
+    // inputs that a word block drives get a net of their own, but aren't inputs of the netlist
+    const Datapath& words {components.datapath};
+    std::vector<bool> isWordDriven(globalInputs.size(), false);
+    for (const Datapath::Boundary& boundary: words.toBits) {
+        for (NetID I: boundary.bits) { assert(std::size_t(I) < globalInputs.size()); isWordDriven[I] = true; }
+    }
+    for (std::size_t I{0}; I < globalInputs.size(); ++I) {
+        const NetID N {isWordDriven[I]? netlist.NewNet() : netlist.AddInput()};
+        netlist.origin[N] = &globalInputs[I];
+        netOf[&globalInputs[I]] = N;
+    }
+
+    // first pass assigns a net to every gate, so that fanin can refer forwards. Cells are lowered to the gates of their
+    // block ('CellBlocks'), with one net per output; every net of the block has the cell as its origin
+    struct Fanin { Component* component; std::size_t gateIndex; bool isB; int pin; }; // operand reading an input-pin
+    std::vector<Fanin> pending{};
+    auto assign = [&](Component& component) {
+        if (component.incoming.empty() && !isFloating) { netOf[&component] = CONST0; return; }
+        if (!component.IsCell()) {
+            const NetID N {netlist.AddGate(component.gate.mType, unconnected(), unconnected())};
+            netlist.origin[N] = &component;
+            netOf[&component] = N;
+            for (int K{0}; K < int(component.inputs.size()) && K < 2; ++K) { pending.push_back({&component, netlist.gates.size()-1, (K == 1), K}); }
+            return;
+        }
+        CellBlocks::Visit(component.gate.mType, [&](const auto& block) {
+            std::array<NetID, std::decay_t<decltype(block)>::NetCount> local{}; // the block's nets in this netlist; its inputs are resolved below
+            for (std::size_t I{0}; I < block.Inputs; ++I) { local[block.Input(I)] = unconnected(); }
+            for (int G: block.order) {
+                const auto& gate {block.gates[G]};
+                const NetID N {netlist.AddGate(gate.type, local[gate.A], local[gate.B])};
+                netlist.origin[N] = &component;
+                local[block.Out(G)] = N;
+                const auto pinOf = [&block](int net) { return (net > 0 && std::size_t(net) <= block.Inputs)? net-1 : -1; };
+                if (pinOf(gate.A) >= 0) pending.push_back({&component, netlist.gates.size()-1, false, pinOf(gate.A)});
+                if (pinOf(gate.B) >= 0 && !LogicGate::IsUnary(gate.type)) pending.push_back({&component, netlist.gates.size()-1, true, pinOf(gate.B)});
+            }
+            std::vector<NetID>& outputs {netlist.cellOutputs[&component]};
+            for (int N: block.outputs) { outputs.push_back(local[N]); }
+            netOf[&component] = outputs[0];
+        });
+    };
+    components.ForEach(assign);
+    for (Component& component: globalOutput) { assign(component); }
+
+    // the net that drives the input-pin 'pinUUID' of 'component'; cells are read from the output the wire leaves from
+    auto driverOf = [&](const Component* component, const std::string& pinUUID) {
+        const Component* source {component->incoming.at(pinUUID)};
+        auto found = netOf.find(source);
+        if (found == netOf.end()) return unconnected();
+        if (found->second == CONST0 || !source->IsCell()) return found->second;
+        return netlist.cellOutputs.at(source).at(source->OutputDriving(pinUUID));
+    };
+    for (auto [component, gateIndex, isB, pin]: pending) {
+        Gate& gate {netlist.gates[gateIndex]};
+        const std::string& pinUUID {component->inputs[pin].UUID};
+        if (!component->incoming.contains(pinUUID)) continue; // unconnected pins read false (or float)
+        (isB? gate.B : gate.A) = driverOf(component, pinUUID);
+    }
+
+    for (Component& component: globalOutput) { netlist.MarkOutput(netOf[&component]); }
+
+    // the canvas' boundaries are indices into 'globalInputs'; the netlist's are their nets
+    if (!words.blocks.empty()) {
+        std::shared_ptr<Datapath> mapped {std::make_shared<Datapath>(words)};
+        for (std::vector<Datapath::Boundary>* boundaries: {&mapped->fromBits, &mapped->toBits}) {
+            for (Datapath::Boundary& boundary: *boundaries) {
+                for (NetID& bit: boundary.bits) { bit = netOf.at(&globalInputs.at(bit)); }
+            }
+        }
+        netlist.datapath = std::move(mapped);
+    }
+
+    netlist.Levelize();
+    return netlist;
+}
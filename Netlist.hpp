@@ -0,0 +1,107 @@
+#ifndef CIRCUITSIM_NETLIST_HPP
+#define CIRCUITSIM_NETLIST_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "LogicGate.hpp"
+
+
+class Component;
+class ComponentMap;
+class Datapath;
+
+// flat gate-level view of a circuit; nets are plain indices into state-arrays.
+// every gate drives exactly one net. Net 0 is always constant-false (unconnected pins read from it)
+class Netlist
+{
+    public:
+    using NetID = std::int32_t;
+    using Word  = std::uint64_t; // one bit per lane (input-vector or instance)
+    static constexpr NetID CONST0{0};
+
+    struct Gate
+    {
+        LogicGate::OpType type;
+        NetID A{CONST0}, B{CONST0}; // fanin; 'B' is ignored by unary gates
+        NetID out;
+    };
+
+    std::vector<Gate>  gates;   // in evaluation-order after 'Levelize'
+    std::vector<NetID> inputs;
+    std::vector<NetID> outputs;
+    std::vector<int> levelStart; // index into 'gates' where each level begins (valid after 'Levelize')
+    std::vector<Component*> origin; // component that each net was extracted from (if any)
+    using CellOutputs = std::unordered_map<const Component*, std::vector<NetID>>;
+    CellOutputs cellOutputs; // each cell's output-nets, by output (kept by 'Reorder' only); its other nets are internal
+    // word-level blocks run ahead of the gates: their buses are packed from nets and unpacked into nets no gate drives.
+    // Set by 'Extract' (from 'ComponentMap::datapath'); the passes that build a new netlist don't carry it over
+    std::shared_ptr<const Datapath> datapath{};
+
+    NetID NetCount() const { return netCount; }
+    int Depth() const { return int(levelStart.size()); }
+    bool IsLevelized() const { return isLevelized; }
+    bool HasLoops() const { return hasLoops; } // as of the last 'Levelize'
+    // changes with every edit (and is unique across netlists), so cached results can tell when they're stale.
+    // 'Levelize' keeps it; edits made directly through the public vectors must call 'Touch'
+    std::uint64_t Version() const { return version; }
+    void Touch() { version = NextVersion(); }
+
+    NetID AddInput() { inputs.push_back(netCount); Touch(); return NewNet(); }
+    NetID AddGate(LogicGate::OpType T, NetID A, NetID B=CONST0) {
+        gates.push_back({T, A, B, netCount}); isLevelized = false; Touch();
+        return NewNet();
+    }
+    void MarkOutput(NetID N) { outputs.push_back(N); Touch(); }
+
+    // (stably) sorts 'gates' by logic-level; returns false if a combinational loop was found
+    // (gates on a loop are appended as a final level, in arbitrary order)
+    bool Levelize();
+
+    // evaluates every gate in schedule-order over 'count' lanes-words per net.
+    // 'state' is net-major: word 'w' of net 'N' is at state[N*stride + w]. Input nets are read as-is; the nets
+    // 'datapath' drives are written first ('EvaluateWords')
+    void Evaluate(Word* state, std::size_t stride, std::size_t count) const;
+    void EvaluateWords(Word* state, std::size_t stride, std::size_t count) const; // only the word-level stage
+    void Evaluate(std::vector<Word>& state) const { Evaluate(state.data(), 1, 1); }
+    static void EvaluateGate(const Gate& gate, Word* state, std::size_t stride, std::size_t count);
+    std::vector<Word> MakeState(std::size_t stride=1) const { return std::vector<Word>(std::size_t(netCount)*stride, 0); }
+
+    // how 'Extract' treats unconnected pins: as constant-false (like 'Component::PropagateLogic'), or as reading one
+    // shared net that nothing drives (neither a gate's output nor an input), which four-valued evaluation sees as Z
+    enum class Undriven { False, Floating };
+
+    // builds a netlist from the interactive canvas, following the same rules as 'Component::PropagateLogic';
+    // components without any incoming connection are tied to 'CONST0' (or become gates reading the floating net)
+    static Netlist Extract(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput,
+                           Undriven undriven=Undriven::False);
+
+    // in-place 64x64 bit-matrix transpose: afterwards, bit 'R' of row 'C' is the former bit 'C' of row 'R'.
+    // converts between bit-sliced lanes (one word per net) and packed values (one word per lane)
+    static void Transpose64(Word rows[64]) {
+        Word mask {0x00000000FFFFFFFF};
+        for (int J{32}; J != 0; J >>= 1, mask ^= (mask << J)) {
+            for (int K{0}; K < 64; K = ((K | J) + 1) & ~J) {
+                const Word T {((rows[K] >> J) ^ rows[K|J]) & mask};
+                rows[K|J] ^= T; rows[K] ^= (T << J);
+            }
+        }
+    }
+
+    Netlist() { NewNet(); } // reserving 'CONST0'
+
+    protected:
+    NetID netCount{0};
+    bool isLevelized{true};
+    bool hasLoops{false};
+    std::uint64_t version{NextVersion()};
+    NetID NewNet() { origin.push_back(nullptr); return netCount++; }
+    static std::uint64_t NextVersion() { static std::atomic<std::uint64_t> counter{0}; return ++counter; }
+};
+
+
+#endif
@@ -0,0 +1,190 @@
+#include "Optimizer.hpp"
+
+#include <format>
+#include <random>
+#include <unordered_map>
+
+
+namespace {
+
+using NetID  = Netlist::NetID;
+using OpType = LogicGate::OpType;
+
+// reference to a net in the optimized netlist, optionally inverted. (CONST0, true) is constant-true
+struct Literal
+{
+    NetID net{Netlist::CONST0};
+    bool isInverted{false};
+
+    Literal operator!() const { return {net, !isInverted}; }
+    bool operator==(const Literal&) const = default;
+    bool IsConstant() const { return (net == Netlist::CONST0); }
+};
+
+// every binary gate is one of three base-ops, optionally inverted
+OpType BaseOf(OpType T) { return ((T == LogicGate::NAND)? LogicGate::AND : (T == LogicGate::NOR)? LogicGate::OR : (T == LogicGate::XNOR)? LogicGate::XOR : T); }
+bool IsInvertedOp(OpType T) { return (T == LogicGate::NAND || T == LogicGate::NOR || T == LogicGate::XNOR); }
+OpType Compose(OpType base, bool isInverted) { return (isInverted? OpType(base+1) : base); } // each inverted op follows its base in 'OpType'
+
+
+class Builder
+{
+    Netlist& out;
+    OptimizeStats& stats;
+    std::unordered_map<std::uint64_t, NetID> structure{}; // (type, A, B) -> net
+
+    static std::uint64_t Key(OpType T, NetID A, NetID B) {
+        if (A > B) std::swap(A, B); // every binary op is commutative
+        return (std::uint64_t(T) << 58) ^ (std::uint64_t(std::uint32_t(A)) << 29) ^ std::uint64_t(std::uint32_t(B));
+    }
+
+    public:
+    NetID Emit(OpType T, NetID A, NetID B, Component* origin)
+    {
+        auto [iter, isNew] = structure.try_emplace(Key(T, A, B), Netlist::CONST0);
+        if (!isNew) { ++stats.gatesMerged; return iter->second; }
+        iter->second = out.AddGate(T, A, B);
+        out.origin[iter->second] = origin;
+        return iter->second;
+    }
+
+    NetID Materialize(Literal L, Component* origin) { return (L.isInverted? Emit(LogicGate::NOT, L.net, L.net, origin) : L.net); }
+
+    // simplified result of a binary gate; only emits a gate when nothing else applies
+    Literal Binary(OpType T, Literal A, Literal B, Component* origin)
+    {
+        OpType base {BaseOf(T)};
+        bool isInverted {IsInvertedOp(T)};
+
+        // constant inputs and repeated inputs
+        if (B.IsConstant()) std::swap(A, B);
+        auto fold = [&](Literal result) { ++stats.constantsFolded; return (isInverted? !result : result); };
+        const Literal ZERO{}, ONE{!Literal{}};
+        if (A.IsConstant()) {
+            const bool value {A.isInverted};
+            switch (base) {
+                case LogicGate::AND: return fold(value? B : ZERO);
+                case LogicGate::OR:  return fold(value? ONE : B);
+                default:             return fold(value? !B : B); // XOR
+            }
+        }
+        if (A == B)  { return fold((base == LogicGate::XOR)? ZERO : A); }
+        if (A == !B) { return fold((base == LogicGate::AND)? ZERO : ONE); }
+
+        // absorbing input-inversions into the gate-type
+        if (base == LogicGate::XOR) {
+            isInverted ^= (A.isInverted != B.isInverted);
+            A.isInverted = B.isInverted = false;
+        } else if (A.isInverted && B.isInverted) { // De Morgan
+            base = ((base == LogicGate::AND)? LogicGate::OR : LogicGate::AND);
+            isInverted = !isInverted;
+            A.isInverted = B.isInverted = false;
+        }
+
+        return {Emit(Compose(base, isInverted), Materialize(A, origin), Materialize(B, origin), origin), false};
+    }
+
+    Builder(Netlist& N, OptimizeStats& S): out{N}, stats{S} {;}
+};
+
+
+// removes gates that don't reach an output, renumbering nets to stay dense
+Netlist Sweep(const Netlist& netlist, OptimizeStats& stats)
+{
+    std::vector<bool> isLive(netlist.NetCount(), false);
+    for (NetID N: netlist.outputs) { isLive[N] = true; }
+    for (auto iter = netlist.gates.rbegin(); iter != netlist.gates.rend(); ++iter) { // reverse schedule-order
+        if (!isLive[iter->out]) continue;
+        isLive[iter->A] = true;
+        if (!LogicGate::IsUnary(iter->type)) isLive[iter->B] = true;
+    }
+
+    Netlist swept{};
+    std::vector<NetID> remap(netlist.NetCount(), Netlist::CONST0);
+    for (NetID N: netlist.inputs) { remap[N] = swept.AddInput(); swept.origin[remap[N]] = netlist.origin[N]; }
+    for (const Netlist::Gate& gate: netlist.gates) {
+        if (!isLive[gate.out]) { ++stats.gatesDead; continue; }
+        remap[gate.out] = swept.AddGate(gate.type, remap[gate.A], remap[gate.B]);
+        swept.origin[remap[gate.out]] = netlist.origin[gate.out];
+    }
+    for (NetID N: netlist.outputs) { swept.MarkOutput(remap[N]); }
+    swept.Levelize();
+    return swept;
+}
+
+} // namespace
+
+
+std::string OptimizeStats::Report() const
+{
+    if (wasSkipped) return std::format("optimizer: skipped; netlist has combinational loops ({} gates)\n", gatesBefore);
+    return std::format(
+        "optimizer: {} -> {} gates, depth {} -> {}\n"
+        "\tconstants folded: {} | buffers/inverters removed: {} | merged: {} | dead: {}\n",
+        gatesBefore, gatesAfter, depthBefore, depthAfter, constantsFolded, buffersRemoved, gatesMerged, gatesDead
+    );
+}
+
+
+Netlist Optimize(const Netlist& source, OptimizeStats* statsOut)
+{
+    OptimizeStats stats{};
+    Netlist netlist{source};
+    stats.gatesBefore = int(netlist.gates.size());
+    if (!netlist.IsLevelized()) netlist.Levelize();
+    if (netlist.HasLoops()) {
+        stats.wasSkipped = true;
+        if (statsOut) *statsOut = stats;
+        return netlist;
+    }
+    stats.depthBefore = netlist.Depth();
+
+    Netlist optimized{};
+    Builder builder{optimized, stats};
+    std::vector<Literal> literal(netlist.NetCount());
+    for (NetID N: netlist.inputs) {
+        literal[N] = {optimized.AddInput(), false};
+        optimized.origin[literal[N].net] = netlist.origin[N];
+    }
+
+    for (const Netlist::Gate& gate: netlist.gates)
+    {
+        Component* origin {netlist.origin[gate.out]};
+        switch (gate.type) {
+            case LogicGate::EQ:  literal[gate.out] =  literal[gate.A]; ++stats.buffersRemoved; break;
+            case LogicGate::NOT: literal[gate.out] = !literal[gate.A]; ++stats.buffersRemoved; break;
+            default: literal[gate.out] = builder.Binary(gate.type, literal[gate.A], literal[gate.B], origin); break;
+        }
+    }
+
+    // outputs need real nets; inverted outputs get their NOT here (constant-true is NOT(CONST0))
+    for (NetID N: netlist.outputs) {
+        const Literal L {literal[N]};
+        optimized.MarkOutput(builder.Materialize(L, netlist.origin[N]));
+        if (L.isInverted) --stats.buffersRemoved; // that inverter wasn't removed after all
+    }
+
+    Netlist swept {Sweep(optimized, stats)};
+    stats.gatesAfter = int(swept.gates.size());
+    stats.depthAfter = swept.Depth();
+    if (statsOut) *statsOut = stats;
+    return swept;
+}
+
+
+bool SimulateEquivalent(const Netlist& A, const Netlist& B, int rounds)
+{
+    if (A.inputs.size() != B.inputs.size() || A.outputs.size() != B.outputs.size()) return false;
+
+    std::mt19937_64 random{0x5EED};
+    std::vector<Netlist::Word> stateA {A.MakeState()}, stateB {B.MakeState()};
+    for (int R{0}; R < rounds; ++R)
+    {
+        for (std::size_t I{0}; I < A.inputs.size(); ++I) { stateA[A.inputs[I]] = stateB[B.inputs[I]] = random(); }
+        A.Evaluate(stateA); B.Evaluate(stateB);
+        for (std::size_t I{0}; I < A.outputs.size(); ++I) {
+            if (stateA[A.outputs[I]] != stateB[B.outputs[I]]) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef CIRCUITSIM_OPTIMIZER_HPP
+#define CIRCUITSIM_OPTIMIZER_HPP
+
+#include <string>
+
+#include "Netlist.hpp"
+
+
+struct OptimizeStats
+{
+    int gatesBefore{0}, gatesAfter{0};
+    int depthBefore{0}, depthAfter{0};
+    int constantsFolded{0}; // gates replaced by a constant or by one of their inputs
+    int buffersRemoved{0};  // 'EQ' gates and absorbed/cancelled inverters
+    int gatesMerged{0};     // structurally identical to an existing gate
+    int gatesDead{0};       // not driving any output
+    bool wasSkipped{false}; // combinational loops are left untouched
+
+    std::string Report() const;
+};
+
+
+// returns an equivalent netlist (at the inputs/outputs) with constants folded, buffers and inverter-pairs
+// collapsed, identical (type, fanin) gates merged, and gates that reach no output removed.
+// Inverters are carried as a flag on each net-reference and absorbed into the consuming gate where
+// possible (e.g. AND(!a,!b) -> NOR(a,b), XOR(!a,b) -> XNOR(a,b)), so only unavoidable NOTs are emitted.
+// Nets keep their 'origin' component when one survives.
+Netlist Optimize(const Netlist& netlist, OptimizeStats* stats=nullptr);
+
+// random-simulation check that both netlists produce the same outputs; 'rounds' x 64 vectors
+bool SimulateEquivalent(const Netlist& A, const Netlist& B, int rounds=16);
+
+
+#endif
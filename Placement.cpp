@@ -0,0 +1,276 @@
+#include "Placement.hpp"
+#include "Interactives.hpp"
+#include "ComponentMap.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+
+
+std::string PlacementStats::Report() const
+{
+    return std::format("placement: {} gates in {} columns ({} connections) | crossings between adjacent columns: {} -> {} in {} sweeps | {:.1f}ms on {} threads\n",
+        gates, columns, edges, crossingsBefore, crossingsAfter, sweeps, milliseconds, threads);
+}
+
+
+namespace {
+
+// hands out [0, count) in chunks of 'grain' to 'threads' threads, the caller being one of them
+void ParallelFor(std::size_t count, unsigned threads, std::size_t grain, auto&& body)
+{
+    std::atomic<std::size_t> next{0};
+    auto work = [&]() {
+        for (std::size_t begin; (begin = next.fetch_add(grain)) < count;) {
+            const std::size_t end {std::min(count, begin + grain)};
+            for (std::size_t I{begin}; I < end; ++I) { body(I); }
+        }
+    };
+    const std::size_t chunks {(count + grain - 1)/grain};
+    std::vector<std::thread> helpers{};
+    for (std::size_t T{1}; T < threads && T < chunks; ++T) { helpers.emplace_back(work); }
+    work();
+    for (std::thread& helper: helpers) { helper.join(); }
+}
+
+
+// nets that are drawn, as a graph in CSR form (both directions, since barycenters look both ways)
+struct LayerGraph
+{
+    std::vector<Netlist::NetID> nets{};       // by node
+    std::vector<std::size_t> faninStart{}, fanoutStart{};
+    std::vector<int> fanin{}, fanout{};
+    std::vector<int> column{};                 // by node
+    std::vector<std::vector<int>> columns{};   // nodes, top to bottom
+    std::vector<char> isFixed{};
+
+    std::size_t NodeCount() const { return nets.size(); }
+};
+
+
+LayerGraph BuildGraph(const Netlist& netlist)
+{
+    LayerGraph graph{};
+    std::vector<int> nodeOf(netlist.NetCount(), -1);
+    std::vector<int> level(netlist.NetCount(), -1);
+    auto addNode = [&](Netlist::NetID N, int L) { nodeOf[N] = int(graph.nets.size()); graph.nets.push_back(N); level[N] = L; };
+
+    for (Netlist::NetID N: netlist.inputs) { addNode(N, 0); }
+    for (std::size_t L{0}; L < netlist.levelStart.size(); ++L) {
+        const std::size_t end {(L+1 < netlist.levelStart.size())? std::size_t(netlist.levelStart[L+1]) : netlist.gates.size()};
+        for (std::size_t G(netlist.levelStart[L]); G < end; ++G) { addNode(netlist.gates[G].out, int(L)+1); }
+    }
+
+    graph.faninStart.assign(graph.NodeCount()+1, 0);
+    graph.fanoutStart.assign(graph.NodeCount()+1, 0);
+    std::vector<int> driverGate(graph.NodeCount(), -1);
+    for (std::size_t G{0}; G < netlist.gates.size(); ++G) { driverGate[nodeOf[netlist.gates[G].out]] = int(G); }
+    auto forEachFanin = [&](int V, auto&& lambda) {
+        if (driverGate[V] < 0) return;
+        const Netlist::Gate& gate {netlist.gates[driverGate[V]]};
+        if (nodeOf[gate.A] >= 0) lambda(nodeOf[gate.A]);
+        if (!LogicGate::IsUnary(gate.type) && nodeOf[gate.B] >= 0) lambda(nodeOf[gate.B]);
+    };
+    for (std::size_t V{0}; V < graph.NodeCount(); ++V) {
+        forEachFanin(int(V), [&](int U) { graph.fanin.push_back(U); ++graph.fanoutStart[U+1]; });
+        graph.faninStart[V+1] = graph.fanin.size();
+    }
+    std::partial_sum(graph.fanoutStart.begin(), graph.fanoutStart.end(), graph.fanoutStart.begin());
+    graph.fanout.resize(graph.fanin.size());
+    {
+        std::vector<std::size_t> fill {graph.fanoutStart.begin(), graph.fanoutStart.end()-1};
+        for (std::size_t V{0}; V < graph.NodeCount(); ++V) {
+            for (std::size_t K{graph.faninStart[V]}; K < graph.faninStart[V+1]; ++K) { graph.fanout[fill[graph.fanin[K]]++] = int(V); }
+        }
+    }
+
+    // outputs that drive nothing get a column of their own, in output-order
+    const int lastLevel {int(netlist.levelStart.size())};
+    graph.isFixed.assign(graph.NodeCount(), false);
+    graph.column.assign(graph.NodeCount(), 0);
+    for (std::size_t V{0}; V < graph.NodeCount(); ++V) { graph.column[V] = level[graph.nets[V]]; }
+    for (Netlist::NetID N: netlist.inputs) { graph.isFixed[nodeOf[N]] = true; }
+    std::vector<int> sinks{};
+    for (Netlist::NetID N: netlist.outputs) {
+        const int V {nodeOf[N]};
+        if (V < 0 || graph.isFixed[V] || graph.fanoutStart[V] != graph.fanoutStart[V+1]) continue;
+        graph.isFixed[V] = true;
+        sinks.push_back(V);
+    }
+    for (int V: sinks) { graph.column[V] = lastLevel + 1; }
+
+    graph.columns.resize(lastLevel + (sinks.empty()? 1 : 2));
+    for (std::size_t V{0}; V < graph.NodeCount(); ++V) {
+        if (graph.isFixed[V] && graph.column[V] > 0) continue; // sinks are added in output-order below
+        graph.columns[graph.column[V]].push_back(int(V));
+    }
+    for (int V: sinks) { graph.columns[graph.column[V]].push_back(V); }
+    return graph;
+}
+
+
+// crossings among the edges from column 'C' to column 'C+1': with both ends sorted by row, every inversion
+// of the targets' rows is one crossing (counted with a Fenwick tree)
+std::size_t CountCrossings(const LayerGraph& graph, const std::vector<int>& rank, std::size_t C)
+{
+    const std::vector<int>& next {graph.columns[C+1]};
+    std::vector<int> targets{}, tree(next.size()+1, 0);
+    std::size_t crossings{0}, seen{0};
+    for (int U: graph.columns[C]) {
+        targets.clear();
+        for (std::size_t K{graph.fanoutStart[U]}; K < graph.fanoutStart[U+1]; ++K) {
+            const int V {graph.fanout[K]};
+            if (graph.column[V] == int(C)+1) targets.push_back(rank[V]);
+        }
+        std::sort(targets.begin(), targets.end());
+        for (int R: targets) {
+            std::size_t atMost{0};
+            for (int I{R+1}; I > 0; I -= (I & -I)) { atMost += tree[I]; }
+            crossings += seen - atMost;
+        }
+        for (int R: targets) {
+            for (std::size_t I(R+1); I < tree.size(); I += (I & -I)) { ++tree[I]; }
+            ++seen;
+        }
+    }
+    return crossings;
+}
+
+
+std::size_t CountCrossings(const LayerGraph& graph, const std::vector<int>& rank, unsigned threads)
+{
+    if (graph.columns.size() < 2) return 0;
+    std::vector<std::size_t> perColumn(graph.columns.size()-1, 0);
+    ParallelFor(perColumn.size(), threads, 1, [&](std::size_t C) { perColumn[C] = CountCrossings(graph, rank, C); });
+    return std::accumulate(perColumn.begin(), perColumn.end(), std::size_t{0});
+}
+
+} // namespace
+
+
+Placement LayOut(const Netlist& source, const PlacementOptions& options, PlacementStats* stats)
+{
+    const auto startTime {std::chrono::steady_clock::now()};
+    Netlist levelized{};
+    if (!source.IsLevelized()) { levelized = source; levelized.Levelize(); }
+    const Netlist& netlist {source.IsLevelized()? source : levelized};
+    const unsigned threads {(options.threads > 0)? options.threads : std::max(1u, std::thread::hardware_concurrency())};
+
+    LayerGraph graph {BuildGraph(netlist)};
+    const std::size_t nodeCount {graph.NodeCount()};
+    std::vector<int> rank(nodeCount, 0);
+    std::vector<float> row(nodeCount, 0.f); // normalized, (rank + 0.5)/column-size
+    auto assignRanks = [&](std::size_t C) {
+        const std::vector<int>& nodes {graph.columns[C]};
+        for (std::size_t R{0}; R < nodes.size(); ++R) { rank[nodes[R]] = int(R); row[nodes[R]] = (float(R) + 0.5f)/float(nodes.size()); }
+    };
+    for (std::size_t C{0}; C < graph.columns.size(); ++C) { assignRanks(C); }
+
+    std::size_t crossings {CountCrossings(graph, rank, threads)};
+    const std::size_t crossingsBefore {crossings};
+    std::vector<std::vector<int>> best {graph.columns};
+    std::vector<int> movable{}; // columns that hold anything but fixed nodes
+    for (std::size_t C{0}; C < graph.columns.size(); ++C) {
+        const auto& nodes {graph.columns[C]};
+        if (std::any_of(nodes.begin(), nodes.end(), [&](int V) { return !graph.isFixed[V]; })) movable.push_back(int(C));
+    }
+
+    std::vector<float> barycenter(nodeCount, 0.f);
+    int sweeps{0}, sinceImproved{0};
+    for (; sweeps < options.maxSweeps && crossings > 0 && sinceImproved < 4; ++sweeps)
+    {
+        for (int parity{0}; parity < 2; ++parity)
+        {
+            // rows are only read from the other parity's columns (or longer edges, as of the last half-sweep)
+            ParallelFor(nodeCount, threads, 4096, [&](std::size_t V) {
+                if (graph.isFixed[V] || (graph.column[V] % 2) != parity) return;
+                float sum{0.f}; std::size_t count{0};
+                for (std::size_t K{graph.faninStart[V]}; K < graph.faninStart[V+1]; ++K) { sum += row[graph.fanin[K]]; ++count; }
+                for (std::size_t K{graph.fanoutStart[V]}; K < graph.fanoutStart[V+1]; ++K) { sum += row[graph.fanout[K]]; ++count; }
+                barycenter[V] = (count? sum/float(count) : row[V]); // unconnected gates stay where they are
+            });
+            ParallelFor(movable.size(), threads, 1, [&](std::size_t I) {
+                const std::size_t C(movable[I]);
+                if (int(C % 2) != parity) return;
+                std::vector<int>& nodes {graph.columns[C]};
+                std::stable_sort(nodes.begin(), nodes.end(), [&](int A, int B) { return barycenter[A] < barycenter[B]; });
+                assignRanks(C);
+            });
+        }
+
+        const std::size_t swept {CountCrossings(graph, rank, threads)};
+        if (swept < crossings) { crossings = swept; best = graph.columns; sinceImproved = 0; }
+        else ++sinceImproved;
+    }
+
+    Placement placement{};
+    placement.column.assign(netlist.NetCount(), -1);
+    placement.rank.assign(netlist.NetCount(), -1);
+    for (std::size_t C{0}; C < best.size(); ++C) {
+        placement.columnSize.push_back(int(best[C].size()));
+        for (std::size_t R{0}; R < best[C].size(); ++R) {
+            const Netlist::NetID N {graph.nets[best[C][R]]};
+            placement.column[N] = int(C);
+            placement.rank[N] = int(R);
+        }
+    }
+
+    if (stats) {
+        stats->gates = std::size_t(std::count(graph.isFixed.begin(), graph.isFixed.end(), false));
+        stats->columns = movable.size();
+        stats->edges = graph.fanin.size();
+        stats->crossingsBefore = crossingsBefore;
+        stats->crossingsAfter = crossings;
+        stats->sweeps = sweeps;
+        stats->threads = threads;
+        stats->milliseconds = std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - startTime}.count();
+    }
+    return placement;
+}
+
+
+PlacementStats Place(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput,
+                     const PlacementOptions& options)
+{
+    const auto startTime {std::chrono::steady_clock::now()};
+    // floating, so that unconnected components are extracted (and placed) too
+    const Netlist netlist {Netlist::Extract(globalInputs, components, globalOutput, Netlist::Undriven::Floating)};
+    PlacementStats stats{};
+    const Placement placement {LayOut(netlist, options, &stats)};
+
+    std::vector<Component*> moved{};
+    std::vector<Netlist::NetID> netOf{};
+    std::unordered_map<const Component*, std::size_t> cellIndex{}; // cells own several nets; they're placed at their last column
+    for (Netlist::NetID N{0}; N < netlist.NetCount(); ++N) {
+        Component* component {netlist.origin[N]};
+        if (!component || component->isGlobalIn || component->isGlobalOut || placement.column[N] < 0) continue;
+        if (component->IsCell()) {
+            auto [iter, isNew] = cellIndex.try_emplace(component, moved.size());
+            if (!isNew) {
+                Netlist::NetID& placedNet {netOf[iter->second]};
+                if (placement.column[N] > placement.column[placedNet]) placedNet = N;
+                continue;
+            }
+        }
+        moved.push_back(component);
+        netOf.push_back(N);
+    }
+
+    // every component only touches its own sprite, pins and wires; wires are rerouted once all pins have moved
+    ParallelFor(moved.size(), stats.threads, 256, [&](std::size_t I) {
+        const Netlist::NetID N {netOf[I]};
+        const float spacing {std::max(options.minRowSpacing, options.canvasHeight/float(placement.columnSize[placement.column[N]] + 1))};
+        moved[I]->SetPosition(options.firstColumnX + float(placement.column[N] - 1)*options.columnSpacing, float(placement.rank[N] + 1)*spacing);
+    });
+    std::vector<Component*> all{};
+    for (Component& component: globalInputs) { all.push_back(&component); }
+    all.insert(all.end(), moved.begin(), moved.end());
+    ParallelFor(all.size(), stats.threads, 256, [&](std::size_t I) { all[I]->RerouteWires(); });
+
+    stats.milliseconds = std::chrono::duration<double, std::milli>{std::chrono::steady_clock::now() - startTime}.count();
+    return stats;
+}
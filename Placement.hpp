@@ -0,0 +1,57 @@
+#ifndef CIRCUITSIM_PLACEMENT_HPP
+#define CIRCUITSIM_PLACEMENT_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "Netlist.hpp"
+
+class Component;
+class ComponentMap;
+
+
+struct PlacementOptions
+{
+    float firstColumnX{172.f};   // the same as 'ComponentMap::AddBank's first bank
+    float columnSpacing{172.f};
+    float canvasHeight{1024.f};  // columns are spread over this height, as 'AddBank' does...
+    float minRowSpacing{72.f};   // ...unless that would put gates closer together than this
+    int maxSweeps{24};           // each sweep reorders the odd columns, then the even ones
+    unsigned threads{0};         // 0: one per hardware thread
+};
+
+
+struct PlacementStats
+{
+    std::size_t gates{0}, columns{0}, edges{0};
+    std::size_t crossingsBefore{0}, crossingsAfter{0}; // between adjacent columns only (longer edges aren't counted)
+    int sweeps{0};
+    unsigned threads{0};
+    double milliseconds{0.0};
+
+    std::string Report() const;
+};
+
+
+// a column and a row ('rank', top to bottom) for every net; -1 for nets that aren't drawn ('CONST0', undriven)
+struct Placement
+{
+    std::vector<int> column{}, rank{};
+    std::vector<int> columnSize{};
+};
+
+// levelized (Sugiyama-style) layout: inputs take column 0 and every gate the column after its logic-level
+// (gates on loops share the last one), then gates are reordered within their columns by the barycenter of their
+// neighbours' rows, to reduce crossings. Columns of one parity don't read each other, so each half-sweep reorders
+// all of them in parallel; the ordering with the fewest crossings is kept. Inputs, and outputs that drive nothing
+// (given a column of their own, after every gate), keep their order
+Placement LayOut(const Netlist& netlist, const PlacementOptions& options={}, PlacementStats* stats=nullptr);
+
+// lays out the canvas through 'LayOut' and moves every gate there with 'Component::SetPosition' (rerouting its wires);
+// global inputs/outputs keep their positions
+PlacementStats Place(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput,
+                     const PlacementOptions& options={});
+
+
+#endif
@@ -0,0 +1,120 @@
+#include "RenderCache.hpp"
+
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/View.hpp>
+
+#include <algorithm>
+
+
+// Main.cpp
+extern const sf::Color backgroundColor;
+
+
+bool RenderCache::Create(sf::Vector2u canvasSize, unsigned size)
+{
+    tileSize = size;
+    tiles.clear(); entries.clear(); nextOrder = 0;
+    
+    sf::ContextSettings contextSettings{}; contextSettings.antialiasingLevel = 4;
+    for (unsigned Y{0}; Y < canvasSize.y; Y += tileSize) {
+        for (unsigned X{0}; X < canvasSize.x; X += tileSize) {
+            auto& tile = tiles.emplace_back(std::make_unique<Tile>());
+            if (!tile->texture.create(tileSize, tileSize, contextSettings)) { tiles.clear(); return false; }
+            tile->area = sf::FloatRect(float(X), float(Y), float(tileSize), float(tileSize));
+        }
+    }
+    return true;
+}
+
+
+void RenderCache::MarkDirty(const sf::FloatRect& area)
+{
+    for (auto& tile: tiles) { if (tile->area.intersects(area)) tile->isDirty = true; }
+    return;
+}
+
+
+void RenderCache::AddMember(const Component* component, const Entry& entry)
+{
+    for (auto& tile: tiles) {
+        if (!tile->area.intersects(entry.bounds)) continue;
+        tile->members.emplace_back(entry.order, component);
+        tile->isDirty = true;
+    }
+    return;
+}
+
+
+void RenderCache::RemoveMember(const Component* component, const sf::FloatRect& bounds)
+{
+    for (auto& tile: tiles) {
+        if (!tile->area.intersects(bounds)) continue;
+        std::erase_if(tile->members, [component](const auto& member) { return member.second == component; });
+        tile->isDirty = true; // also clearing wherever it used to be drawn
+    }
+    return;
+}
+
+
+void RenderCache::Update(std::vector<Component>& globalInputs, std::vector<Component>& globalOutput, ComponentMap& components)
+{
+    if (entries.empty()) {
+        for (Component& component: globalInputs) { component.MarkChanged(); }
+        for (Component& component: globalOutput) { component.MarkChanged(); }
+        components.ForEach([](Component& component) { component.MarkChanged(); });
+    }
+    changed.clear(); removed.clear();
+    Component::TakeCacheQueues(changed, removed);
+    
+    // removals first: a new component may reuse a deleted one's address
+    for (const Component* component: removed) {
+        auto search = entries.find(component);
+        if (search == entries.end()) continue;
+        RemoveMember(component, search->second.bounds);
+        entries.erase(search);
+    }
+    
+    for (Component* component: changed)
+    {
+        const std::size_t signature {component->VisualSignature()};
+        const sf::FloatRect bounds {component->GetDrawBounds()};
+        
+        auto [iter, isNew] = entries.try_emplace(component, Entry{signature, bounds, nextOrder});
+        Entry& entry {iter->second};
+        if (isNew) { ++nextOrder; component->cacheState.isCached = true; AddMember(component, entry); continue; }
+        
+        const bool isMoved {(entry.bounds.left != bounds.left) || (entry.bounds.top    != bounds.top)
+                         || (entry.bounds.width != bounds.width) || (entry.bounds.height != bounds.height)};
+        if (isMoved) {
+            RemoveMember(component, entry.bounds);
+            entry.bounds = bounds; entry.signature = signature;
+            AddMember(component, entry);
+        }
+        else if (entry.signature != signature) { entry.signature = signature; MarkDirty(bounds); }
+    }
+    
+    tilesRedrawn = 0;
+    for (auto& tile: tiles)
+    {
+        if (!tile->isDirty) continue;
+        std::sort(tile->members.begin(), tile->members.end());
+        tile->texture.setView(sf::View(tile->area));
+        tile->texture.clear(backgroundColor);
+        for (const auto& [order, component]: tile->members) { tile->texture.draw(*component); }
+        tile->texture.display();
+        tile->isDirty = false;
+        ++tilesRedrawn;
+    }
+    return;
+}
+
+
+void RenderCache::Draw(sf::RenderTarget& target) const
+{
+    for (const auto& tile: tiles) {
+        sf::Sprite sprite{tile->texture.getTexture()};
+        sprite.setPosition(tile->area.left, tile->area.top);
+        target.draw(sprite);
+    }
+    return;
+}
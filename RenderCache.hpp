@@ -0,0 +1,61 @@
+#ifndef CIRCUITSIM_RENDERCACHE_HPP
+#define CIRCUITSIM_RENDERCACHE_HPP
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+
+#include "Interactives.hpp"
+#include "ComponentMap.hpp"
+
+
+// keeps the (mostly static) canvas rendered into a grid of render-textures.
+// Components queue themselves whenever something they draw changes (see 'Component::MarkChanged'); each frame
+// only those are revisited, and only tiles overlapping a changed, moved, added or deleted component are re-rendered.
+// Drawing the canvas is then one textured quad per tile.
+class RenderCache
+{
+    struct Tile
+    {
+        sf::RenderTexture texture;
+        sf::FloatRect area;
+        bool isDirty{true};
+        std::vector<std::pair<std::size_t, const Component*>> members; // (draw-order, component) overlapping 'area'
+    };
+    
+    struct Entry
+    {
+        std::size_t signature;
+        sf::FloatRect bounds;
+        std::size_t order; // first-seen order; overlapping components are drawn in it
+    };
+    
+    std::vector<std::unique_ptr<Tile>> tiles; // 'sf::RenderTexture' is non-copyable and non-movable
+    std::unordered_map<const Component*, Entry> entries;
+    std::size_t nextOrder{0};
+    std::vector<Component*> changed;        // reused between frames
+    std::vector<const Component*> removed;
+    unsigned tileSize{256};
+    std::size_t tilesRedrawn{0};
+    
+    void AddMember(const Component* component, const Entry& entry);
+    void RemoveMember(const Component* component, const sf::FloatRect& bounds);
+    
+    public:
+    bool Create(sf::Vector2u canvasSize, unsigned tileSize=256); // returns false on failure
+    void Invalidate() { for (auto& tile: tiles) { tile->isDirty = true; } } // e.g. after toggling hitbox-display
+    void MarkDirty(const sf::FloatRect& area);
+    
+    // applies the queued changes, then re-renders the dirty tiles. The first call after 'Create' visits every component
+    void Update(std::vector<Component>& globalInputs, std::vector<Component>& globalOutput, ComponentMap& components);
+    void Draw(sf::RenderTarget& target) const;
+    
+    std::size_t TilesRedrawn() const { return tilesRedrawn; } // by the most recent 'Update'
+    std::size_t TileCount() const { return tiles.size(); }
+};
+
+
+#endif
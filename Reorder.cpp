@@ -0,0 +1,187 @@
+#include "Reorder.hpp"
+
+#include <format>
+#include <chrono>
+#include <numeric>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/syscall.h>
+  #include <sys/ioctl.h>
+  #include <unistd.h>
+#endif
+
+
+namespace {
+
+using NetID = Netlist::NetID;
+
+// rank of each net in depth-first post-order from the outputs, so a cone's gates are ranked together
+std::vector<int> DfsRank(const Netlist& netlist, const std::vector<int>& driver)
+{
+    std::vector<int> rank(netlist.NetCount(), -1);
+    int next{0};
+    std::vector<std::pair<NetID, bool>> stack{}; // (net, are fanins done)
+    auto visit = [&](NetID root) {
+        stack.emplace_back(root, false);
+        while (!stack.empty()) {
+            auto [N, isExpanded] = stack.back(); stack.pop_back();
+            if (rank[N] >= 0) continue;
+            if (isExpanded || driver[N] < 0) { rank[N] = next++; continue; }
+            const Netlist::Gate& gate {netlist.gates[driver[N]]};
+            stack.emplace_back(N, true);
+            if (!LogicGate::IsUnary(gate.type)) stack.emplace_back(gate.B, false);
+            stack.emplace_back(gate.A, false);
+        }
+    };
+    for (NetID N: netlist.outputs) { visit(N); }
+    for (const Netlist::Gate& gate: netlist.gates) { visit(gate.out); } // gates that reach no output
+    return rank;
+}
+
+
+// reverse Cuthill-McKee over the undirected net-graph (fanin edges)
+std::vector<int> RcmRank(const Netlist& netlist)
+{
+    const std::size_t count {std::size_t(netlist.NetCount())};
+    std::vector<std::vector<NetID>> adjacent(count);
+    for (const Netlist::Gate& gate: netlist.gates) {
+        for (NetID N: {gate.A, gate.B}) {
+            if (N == Netlist::CONST0 || (N == gate.B && LogicGate::IsUnary(gate.type))) continue;
+            adjacent[gate.out].push_back(N); adjacent[N].push_back(gate.out);
+        }
+    }
+
+    std::vector<NetID> byDegree(count);
+    std::iota(byDegree.begin(), byDegree.end(), 0);
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&](NetID L, NetID R){ return adjacent[L].size() < adjacent[R].size(); });
+
+    std::vector<NetID> order{}; order.reserve(count);
+    std::vector<bool> isVisited(count, false);
+    for (NetID start: byDegree) // each disconnected part starts from its lowest-degree net
+    {
+        if (isVisited[start]) continue;
+        isVisited[start] = true;
+        std::size_t head {order.size()};
+        order.push_back(start);
+        while (head < order.size()) {
+            std::vector<NetID>& neighbours {adjacent[order[head++]]};
+            std::sort(neighbours.begin(), neighbours.end(), [&](NetID L, NetID R){ return adjacent[L].size() < adjacent[R].size(); });
+            for (NetID N: neighbours) { if (!isVisited[N]) { isVisited[N] = true; order.push_back(N); } }
+        }
+    }
+
+    std::vector<int> rank(count);
+    for (std::size_t I{0}; I < count; ++I) { rank[order[I]] = int(count - 1 - I); }
+    return rank;
+}
+
+
+#ifdef __linux__
+// thin wrapper over a perf-event counter; unusable counters (permissions, VMs) just read -1
+class PerfCounter
+{
+    int fd{-1};
+    public:
+    explicit PerfCounter(std::uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~PerfCounter() { if (fd >= 0) close(fd); }
+    void Start() { if (fd >= 0) { ioctl(fd, PERF_EVENT_IOC_RESET, 0); ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); } }
+    std::int64_t Stop() {
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        std::int64_t value{0};
+        return ((read(fd, &value, sizeof(value)) == sizeof(value))? value : -1);
+    }
+};
+#endif
+
+} // namespace
+
+
+Netlist Reorder(const Netlist& source, Ordering ordering)
+{
+    Netlist netlist{source};
+    if (!netlist.IsLevelized()) netlist.Levelize();
+
+    std::vector<int> driver(netlist.NetCount(), -1);
+    for (std::size_t I{0}; I < netlist.gates.size(); ++I) { driver[netlist.gates[I].out] = int(I); }
+    const std::vector<int> rank {(ordering == Ordering::LevelDfs)? DfsRank(netlist, driver) : RcmRank(netlist)};
+
+    // level-major: sorting each level's slice of the schedule by rank
+    std::vector<int> order(netlist.gates.size());
+    std::iota(order.begin(), order.end(), 0);
+    for (int L{0}; L < netlist.Depth(); ++L) {
+        const int begin {netlist.levelStart[L]};
+        const int end {(L+1 < netlist.Depth())? netlist.levelStart[L+1] : int(order.size())};
+        std::sort(order.begin()+begin, order.begin()+end, [&](int G, int H){ return rank[netlist.gates[G].out] < rank[netlist.gates[H].out]; });
+    }
+
+    Netlist reordered{};
+    std::vector<NetID> remap(netlist.NetCount(), Netlist::CONST0);
+    for (NetID N: netlist.inputs) { remap[N] = reordered.AddInput(); reordered.origin[remap[N]] = netlist.origin[N]; }
+    for (int G: order) { // fanins of a loop may not be renumbered yet, so they're patched afterwards
+        remap[netlist.gates[G].out] = reordered.AddGate(netlist.gates[G].type, Netlist::CONST0, Netlist::CONST0);
+        reordered.origin[remap[netlist.gates[G].out]] = netlist.origin[netlist.gates[G].out];
+    }
+    for (std::size_t I{0}; I < order.size(); ++I) {
+        reordered.gates[I].A = remap[netlist.gates[order[I]].A];
+        reordered.gates[I].B = remap[netlist.gates[order[I]].B];
+    }
+    for (NetID N: netlist.outputs) { reordered.MarkOutput(remap[N]); }
+    for (const auto& [cell, nets]: netlist.cellOutputs) {
+        for (NetID N: nets) { reordered.cellOutputs[cell].push_back(remap[N]); }
+    }
+
+    reordered.Levelize(); // already in level-order, so this only rebuilds 'levelStart'
+    return reordered;
+}
+
+
+std::string LocalityStats::Report(const std::string& label) const
+{
+    const std::string misses {(cacheMisses < 0)? std::string{"n/a"} : std::format("{} of {} refs", cacheMisses, cacheReferences)};
+    return std::format("{}: {:.2f} ns/gate | mean fanin distance: {:.0f} bytes | cache-misses: {}\n",
+        label, nsPerGate, meanFaninDistance, misses);
+}
+
+
+LocalityStats MeasureLocality(const Netlist& netlist, int iterations, std::size_t stride)
+{
+    LocalityStats stats{};
+    double distance{0.0}; std::size_t edges{0};
+    for (const Netlist::Gate& gate: netlist.gates) {
+        distance += std::abs(gate.out - gate.A); ++edges;
+        if (!LogicGate::IsUnary(gate.type)) { distance += std::abs(gate.out - gate.B); ++edges; }
+    }
+    stats.meanFaninDistance = (edges? (distance/edges)*stride*sizeof(Netlist::Word) : 0.0);
+
+    std::vector<Netlist::Word> state {netlist.MakeState(stride)};
+    for (std::size_t I{0}; I < netlist.inputs.size(); ++I) { std::fill_n(&state[netlist.inputs[I]*stride], stride, 0x9E3779B97F4A7C15*(I+1)); }
+    netlist.Evaluate(state.data(), stride, stride); // warm-up
+
+    #ifdef __linux__
+    PerfCounter misses{PERF_COUNT_HW_CACHE_MISSES}, references{PERF_COUNT_HW_CACHE_REFERENCES};
+    misses.Start(); references.Start();
+    #endif
+    const auto startTime {std::chrono::steady_clock::now()};
+    for (int I{0}; I < iterations; ++I) { netlist.Evaluate(state.data(), stride, stride); }
+    const std::chrono::duration<double, std::nano> elapsed {std::chrono::steady_clock::now() - startTime};
+    #ifdef __linux__
+    stats.cacheMisses = misses.Stop(); stats.cacheReferences = references.Stop();
+    #endif
+
+    const double gateCount {double(std::max<std::size_t>(netlist.gates.size(), 1))};
+    stats.nsPerGate = elapsed.count() / (gateCount*std::max(iterations, 1));
+    return stats;
+}
@@ -0,0 +1,35 @@
+#ifndef CIRCUITSIM_REORDER_HPP
+#define CIRCUITSIM_REORDER_HPP
+
+#include <string>
+#include <cstdint>
+
+#include "Netlist.hpp"
+
+
+enum class Ordering
+{
+    LevelDfs, // level-major; within a level, in depth-first order from the outputs (cones stay together)
+    LevelRcm, // level-major; within a level, in reverse Cuthill-McKee order of the whole (undirected) graph
+};
+
+// renumbers gates and nets so that state is written sequentially (inputs, then gates in schedule-order)
+// and each gate's fanin sits close to it. The result is equivalent, with 'origin' carried over
+Netlist Reorder(const Netlist& netlist, Ordering ordering=Ordering::LevelDfs);
+
+
+struct LocalityStats
+{
+    double nsPerGate{0.0};
+    double meanFaninDistance{0.0}; // bytes between a gate's state-word and its fanin's, averaged
+    std::int64_t cacheMisses{-1};  // hardware counter over the timed run; -1 if unavailable
+    std::int64_t cacheReferences{-1};
+
+    std::string Report(const std::string& label) const;
+};
+
+// times 'iterations' evaluations over 'stride' words per net, counting cache-misses where the OS allows it
+LocalityStats MeasureLocality(const Netlist& netlist, int iterations=64, std::size_t stride=1);
+
+
+#endif
@@ -0,0 +1,236 @@
+#include "ResultCache.hpp"
+#include "Logger.hpp"
+
+#include <format>
+#include <queue>
+#include <algorithm>
+#include <functional>
+
+
+std::string ResultCache::Stats::Report(const std::string& label) const
+{
+    return std::format("{}: {} hits, {} misses ({:.1f}% hit-rate) | {} inserted, {} evicted, {} invalidated\n",
+        label, hits, misses, HitRate()*100.0, insertions, evictions, invalidations);
+}
+
+
+std::size_t ResultCache::KeyHash::operator()(const KeyView& K) const
+{
+    std::uint64_t hash {0x9E3779B97F4A7C15 ^ K.size};
+    for (std::size_t I{0}; I < K.size; ++I) { hash = (hash ^ K.data[I]) * 0xFF51AFD7ED558CCD; hash ^= (hash >> 32); }
+    return std::size_t(hash);
+}
+
+bool ResultCache::KeyEqual::operator()(const KeyView& A, const KeyView& B) const
+{
+    return (A.size == B.size) && std::equal(A.data, A.data + A.size, B.data);
+}
+
+
+void ResultCache::Validate(std::uint64_t V)
+{
+    if (V == version) return;
+    stats.invalidations += entries.size();
+    Clear();
+    version = V;
+}
+
+
+void ResultCache::Clear()
+{
+    index.clear();
+    entries.clear();
+    bytes = 0;
+}
+
+
+const ResultCache::Word* ResultCache::Find(const Word* key, std::size_t keyWords)
+{
+    auto found = index.find(KeyView{key, keyWords});
+    if (found == index.end()) { ++stats.misses; return nullptr; }
+    ++stats.hits;
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->value.data();
+}
+
+
+void ResultCache::Insert(const Word* key, std::size_t keyWords, const Word* value, std::size_t valueWords)
+{
+    if (auto found = index.find(KeyView{key, keyWords}); found != index.end()) {
+        // already there (e.g. the same vector missed twice in one batch); the result can't differ
+        entries.splice(entries.begin(), entries, found->second);
+        return;
+    }
+
+    Entry entry{{key, key + keyWords}, {value, value + valueWords}};
+    const std::size_t entryBytes {EntryBytes(entry)};
+    if (entryBytes > budget) return;
+    while (bytes + entryBytes > budget) {
+        const Entry& oldest {entries.back()};
+        index.erase(KeyView{oldest.key.data(), oldest.key.size()});
+        bytes -= EntryBytes(oldest);
+        entries.pop_back();
+        ++stats.evictions;
+    }
+
+    entries.push_front(std::move(entry));
+    index.emplace(KeyView{entries.front().key.data(), entries.front().key.size()}, entries.begin());
+    bytes += entryBytes;
+    ++stats.insertions;
+}
+
+
+
+bool MemoizedNetlist::AddGroup(const std::vector<NetID>& members)
+{
+    std::vector<NetID> unique {members};
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+    if (unique.empty()) return false;
+    groups.push_back({unique, {}, {}, {}, ResultCache{bytesPerGroup}});
+    if (Rebuild()) return true;
+    groups.pop_back();
+    Rebuild();
+    return false;
+}
+
+
+bool MemoizedNetlist::AddGroup(const std::vector<const Component*>& components)
+{
+    std::vector<NetID> members{};
+    for (NetID N{0}; N < netlist.NetCount(); ++N) {
+        if (std::find(components.begin(), components.end(), netlist.origin[N]) != components.end()) members.push_back(N);
+    }
+    return AddGroup(members);
+}
+
+
+bool MemoizedNetlist::Rebuild()
+{
+    builtVersion = netlist.Version();
+    schedule.clear();
+    const int gateCount {int(netlist.gates.size())};
+    auto valid = [&](bool isValid) {
+        if (!isValid) schedule.clear(); // 'Evaluate' falls back to the plain netlist
+        return isValid;
+    };
+    if (!netlist.IsLevelized() || netlist.HasLoops()) return valid(groups.empty());
+
+    std::vector<int> driver(netlist.NetCount(), -1);
+    for (int G{0}; G < gateCount; ++G) { driver[netlist.gates[G].out] = G; }
+
+    // nodes are gates, except that all gates of a group share the node 'gateCount + group'
+    std::vector<int> node(gateCount);
+    for (int G{0}; G < gateCount; ++G) { node[G] = G; }
+    for (std::size_t I{0}; I < groups.size(); ++I) {
+        Group& group {groups[I]};
+        group.gates.clear(); group.boundary.clear(); group.outputs.clear();
+        for (NetID N: group.members) {
+            if (N < 0 || N >= netlist.NetCount() || driver[N] < 0 || node[driver[N]] >= gateCount) return valid(false); // overlapping groups
+            node[driver[N]] = gateCount + int(I);
+            group.gates.push_back(driver[N]);
+        }
+        std::sort(group.gates.begin(), group.gates.end());
+    }
+
+    auto forEachFanin = [&](const Netlist::Gate& gate, auto&& lambda) {
+        lambda(gate.A);
+        if (!LogicGate::IsUnary(gate.type)) lambda(gate.B);
+    };
+    auto isInside = [&](NetID N, int I) { return (driver[N] >= 0) && (node[driver[N]] == gateCount + I); };
+
+    // boundaries (inputs read from outside) and outputs (read from outside, or global outputs)
+    std::vector<std::vector<int>> fanout(gateCount + groups.size());
+    for (int G{0}; G < gateCount; ++G) {
+        const int consumer {node[G]};
+        forEachFanin(netlist.gates[G], [&](NetID N) {
+            if (driver[N] < 0) { // global input (or CONST0, which never changes)
+                if (consumer >= gateCount && N != Netlist::CONST0) groups[consumer-gateCount].boundary.push_back(N);
+                return;
+            }
+            const int producer {node[driver[N]]};
+            if (producer == consumer) return;
+            fanout[producer].push_back(consumer);
+            if (consumer >= gateCount) groups[consumer-gateCount].boundary.push_back(N);
+            if (producer >= gateCount) groups[producer-gateCount].outputs.push_back(N);
+        });
+    }
+    for (std::size_t I{0}; I < groups.size(); ++I) {
+        for (NetID N: netlist.outputs) { if (isInside(N, int(I))) groups[I].outputs.push_back(N); }
+        for (auto* nets: {&groups[I].boundary, &groups[I].outputs}) {
+            std::sort(nets->begin(), nets->end());
+            nets->erase(std::unique(nets->begin(), nets->end()), nets->end());
+        }
+    }
+
+    // Kahn's algorithm on the contracted graph, preferring the existing schedule-order (a group goes at its first gate)
+    std::vector<int> pending(fanout.size(), 0);
+    for (const auto& targets: fanout) { for (int T: targets) { ++pending[T]; } }
+    auto position = [&](int N) { return ((N < gateCount)? N : groups[N-gateCount].gates.front()); };
+    using Ready = std::pair<int, int>; // (position, node)
+    std::priority_queue<Ready, std::vector<Ready>, std::greater<Ready>> ready{};
+    for (std::size_t N{0}; N < fanout.size(); ++N) {
+        const bool isLive {(int(N) >= gateCount) || (node[N] == int(N))}; // grouped gates aren't nodes of their own
+        if (isLive && pending[N] == 0) ready.emplace(position(int(N)), int(N));
+    }
+    std::size_t liveCount {std::size_t(std::count_if(node.begin(), node.end(), [&](int N){ return N < gateCount; })) + groups.size()};
+    while (!ready.empty()) {
+        const int N {ready.top().second}; ready.pop();
+        schedule.push_back((N < gateCount)? Step{N, -1} : Step{-1, N-gateCount});
+        for (int T: fanout[N]) { if (--pending[T] == 0) ready.emplace(position(T), T); }
+    }
+    return valid(schedule.size() == liveCount); // a group reaching itself through outside gates leaves a cycle
+}
+
+
+void MemoizedNetlist::Evaluate(Word* state, std::size_t stride, std::size_t count)
+{
+    if (netlist.Version() != builtVersion) {
+        if (!Rebuild()) Log::Warning("memoized netlist: groups no longer apply after an edit; evaluating without them");
+        for (Group& group: groups) { group.cache.Validate(builtVersion); }
+    }
+    if (schedule.empty()) { netlist.Evaluate(state, stride, count); return; }
+    if (netlist.datapath) netlist.EvaluateWords(state, stride, count); // its nets are read like inputs by the groups
+
+    for (const Step& step: schedule)
+    {
+        if (step.gate >= 0) { Netlist::EvaluateGate(netlist.gates[step.gate], state, stride, count); continue; }
+
+        Group& group {groups[step.group]};
+        key.clear();
+        for (NetID N: group.boundary) { key.insert(key.end(), state + N*stride, state + N*stride + count); }
+        if (const Word* hit = group.cache.Find(key.data(), key.size())) {
+            for (std::size_t I{0}; I < group.members.size(); ++I) { std::copy_n(hit + I*count, count, state + group.members[I]*stride); }
+            continue;
+        }
+
+        for (int G: group.gates) { Netlist::EvaluateGate(netlist.gates[G], state, stride, count); }
+        value.clear();
+        for (NetID N: group.members) { value.insert(value.end(), state + N*stride, state + N*stride + count); }
+        group.cache.Insert(key.data(), key.size(), value.data(), value.size());
+    }
+}
+
+
+ResultCache::Stats MemoizedNetlist::Totals() const
+{
+    ResultCache::Stats totals{};
+    for (const Group& group: groups) {
+        const ResultCache::Stats& S {group.cache.GetStats()};
+        totals.hits += S.hits; totals.misses += S.misses;
+        totals.insertions += S.insertions; totals.evictions += S.evictions; totals.invalidations += S.invalidations;
+    }
+    return totals;
+}
+
+
+std::string MemoizedNetlist::Report() const
+{
+    std::string text {Totals().Report(std::format("memoized netlist ({} groups)", groups.size()))};
+    for (std::size_t I{0}; I < groups.size(); ++I) {
+        const Group& group {groups[I]};
+        text += "\t" + group.cache.GetStats().Report(std::format("group {}: {} gates, {} in, {} out, {} entries",
+            I, group.gates.size(), group.boundary.size(), group.outputs.size(), group.cache.Size()));
+    }
+    return text;
+}
@@ -0,0 +1,108 @@
+#ifndef CIRCUITSIM_RESULTCACHE_HPP
+#define CIRCUITSIM_RESULTCACHE_HPP
+
+#include <list>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+#include "Netlist.hpp"
+
+
+// least-recently-used map from an input-vector (any number of words) to the outputs it produced.
+// bounded by an approximate byte-budget; results belong to one netlist-version and are
+// dropped as soon as 'Validate' sees a different one
+class ResultCache
+{
+    public:
+    using Word = Netlist::Word;
+
+    struct Stats
+    {
+        std::uint64_t hits{0}, misses{0};
+        std::uint64_t insertions{0}, evictions{0};
+        std::uint64_t invalidations{0}; // entries dropped because the netlist changed
+
+        double HitRate() const { return ((hits + misses)? double(hits)/double(hits + misses) : 0.0); }
+        std::string Report(const std::string& label) const;
+    };
+
+    void Validate(std::uint64_t version);
+
+    // nullptr on a miss; a hit becomes the most-recently-used entry. The result stays valid until the next 'Insert'/'Validate'
+    const Word* Find(const Word* key, std::size_t keyWords);
+    void Insert(const Word* key, std::size_t keyWords, const Word* value, std::size_t valueWords);
+    void Clear();
+
+    std::size_t Size() const { return entries.size(); }
+    std::size_t Bytes() const { return bytes; }
+    const Stats& GetStats() const { return stats; }
+
+    explicit ResultCache(std::size_t byteBudget): budget{byteBudget} {;}
+
+    private:
+    struct Entry { std::vector<Word> key, value; };
+    struct KeyView { const Word* data; std::size_t size; }; // into an entry's 'key', or a lookup's
+    struct KeyHash  { std::size_t operator()(const KeyView& K) const; };
+    struct KeyEqual { bool operator()(const KeyView& A, const KeyView& B) const; };
+
+    const std::size_t budget;
+    std::size_t bytes{0};
+    std::uint64_t version{0};
+    std::list<Entry> entries; // most-recently-used first; list-nodes never move, so 'index' can point into them
+    std::unordered_map<KeyView, std::list<Entry>::iterator, KeyHash, KeyEqual> index;
+    Stats stats{};
+
+    static std::size_t EntryBytes(const Entry& E) { return (E.key.size() + E.value.size())*sizeof(Word) + 96; } // + node/bucket overhead
+};
+
+
+// evaluates a netlist with user-marked groups of gates memoized: a group is looked up by the words of its
+// input boundary (nets it reads but doesn't drive) and on a hit every net it drives is copied instead of
+// re-evaluating its gates (internal nets too, so the whole state stays displayable). Caches are keyed by all 'count' lane-words, so any lane-count works.
+// Groups survive edits to the netlist (they're net-IDs); their caches are invalidated by its 'Version'
+class MemoizedNetlist
+{
+    public:
+    using NetID = Netlist::NetID;
+    using Word  = Netlist::Word;
+
+    // 'members' are the nets driven by the group's gates; returns false (and adds nothing) if the
+    // netlist has loops, a member isn't a gate-output, or the group would depend on itself through outside gates
+    bool AddGroup(const std::vector<NetID>& members);
+    bool AddGroup(const std::vector<const Component*>& components); // via 'Netlist::origin'
+
+    // same contract as 'Netlist::Evaluate'
+    void Evaluate(Word* state, std::size_t stride, std::size_t count);
+    void Evaluate(std::vector<Word>& state) { Evaluate(state.data(), 1, 1); }
+
+    std::size_t GroupCount() const { return groups.size(); }
+    ResultCache::Stats Totals() const;
+    std::string Report() const;
+
+    // 'netlist' must outlive this; 'bytesPerGroup' bounds each group's cache
+    MemoizedNetlist(const Netlist& netlist, std::size_t bytesPerGroup): netlist{netlist}, bytesPerGroup{bytesPerGroup} {;}
+
+    private:
+    struct Group
+    {
+        std::vector<NetID> members;
+        std::vector<NetID> boundary, outputs; // derived by 'Rebuild'
+        std::vector<int> gates;               // indices into 'netlist.gates', in schedule-order
+        ResultCache cache;
+    };
+    struct Step { int gate; int group; }; // exactly one is >= 0
+
+    const Netlist& netlist;
+    const std::size_t bytesPerGroup;
+    std::vector<Group> groups{};
+    std::vector<Step> schedule{};
+    std::uint64_t builtVersion{0};
+    std::vector<Word> key{}, value{};
+
+    bool Rebuild(); // derives boundaries and a schedule with each group contracted to one step
+};
+
+
+#endif
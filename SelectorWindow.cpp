@@ -12,6 +12,7 @@ extern const sf::Color backgroundColor;
 
 void SelectorWindow::Redraw()
 {
+    if (!isOpen()) return; // created lazily; see 'Create'
     clear(backgroundColor);
     for(const sf::Sprite& sprite: TextureStorage::sprites) { draw(sprite); }
     draw(selectionRect);
@@ -28,27 +29,27 @@ void SelectorWindow::Create()
     #else
     const int hWinSize{windowSize};
     #endif
+    const sf::IntRect lastSlot {TextureStorage::Slot(OpType(OpType::LAST_ENUM-1))};
+    const int vWinSize {static_cast<int>((lastSlot.top + lastSlot.height)*spriteScale)};
     
-    sf::ContextSettings contextSettings{}; contextSettings.antialiasingLevel = 16;
-    create(sf::VideoMode(hWinSize, windowSize), "SelectorWindow", sf::Style::Titlebar, contextSettings);
+    // only axis-aligned sprites and rectangles are drawn here, so there's nothing to antialias
+    create(sf::VideoMode(hWinSize, vWinSize), "SelectorWindow", sf::Style::Titlebar);
     setVerticalSyncEnabled(usingVsync);
     setFramerateLimit(framerateCap);
+    setPosition(windowPosition);
+    Redraw();
     return;
 }
 
 
 SelectorWindow::SelectorWindow(float scale): windowSize{static_cast<int>(1024.f*scale)}, spriteScale{scale}
 {
-    const sf::Vector2f spriteSize {windowSize/2.f, windowSize/4.f};
-    
-    selectionRect = sf::RectangleShape{spriteSize};
     selectionRect.setFillColor(sf::Color::Transparent);
     selectionRect.setOutlineColor(sf::Color::Cyan);
     selectionRect.setOutlineThickness(-4.f);
     SetSelection(OpType::EQ);
     
-    Create();
-    Redraw();
+    // the window itself isn't created until it's first shown ('Create')
     return;
 }
 
@@ -72,10 +73,9 @@ void SelectorWindow::SetSelection(OpType sel)
     selection = sel;
     selectionHasChanged = true;
     
-    //constexpr int W {512}, H {256}; // 1024x1024
-    constexpr int W {128}, H {64}; // 0.25 scale
-    const int X {W*(sel%2)}, Y {H*(sel/2)};
-    selectionRect.setPosition(X, Y);
+    const sf::IntRect slot {TextureStorage::Slot(sel)}; // cells' are taller
+    selectionRect.setSize({slot.width*spriteScale, slot.height*spriteScale});
+    selectionRect.setPosition(slot.left*spriteScale, slot.top*spriteScale);
     
     Redraw();
     
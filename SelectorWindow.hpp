@@ -9,19 +9,20 @@
 
 class SelectorWindow: sf::RenderWindow
 {
-    const int windowSize;
+    const int windowSize; // width; the height fits every 'TextureStorage::Slot'
     
     using OpType = LogicGate::OpType;
     OpType selection;
     float spriteScale;
     bool selectionHasChanged{false};
     sf::RectangleShape selectionRect{};
+    sf::Vector2i windowPosition{}; // applied whenever the window is (re)created
     
     OpType NextSelection(bool reverse=false, bool byColumn=false);
     void SetSelection(OpType);
     void EventLoop();
     void Redraw();
-    void Create();
+    void Create(); // opens the window; called lazily, on first use
     SelectorWindow(float spriteScale=1.f);
     
     public:
@@ -0,0 +1,156 @@
+#include "SimulationThread.hpp"
+#include "Interactives.hpp"
+#include "ResultCache.hpp"
+#include "Logger.hpp"
+
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+
+
+constexpr std::size_t memoBytesPerGroup{std::size_t{4} << 20};
+
+
+// what 'ApplySnapshot' shows, in schedule-order so wires deliver their state before the drains recolor.
+// A cell owns several nets (its lowered block), so it's shown once, at its last net (which comes after all of
+// its inputs'), with every output read from the snapshot. Only the netlist is read, never the components
+static std::vector<SimulationThread::Snapshot::Shown> ShownOf(const Netlist& netlist)
+{
+    std::unordered_map<const Component*, std::size_t> lastGate{};
+    for (std::size_t G{0}; G < netlist.gates.size(); ++G) {
+        const Component* component {netlist.origin[netlist.gates[G].out]};
+        if (netlist.cellOutputs.contains(component)) lastGate[component] = G;
+    }
+
+    std::vector<SimulationThread::Snapshot::Shown> shown{};
+    for (std::size_t G{0}; G < netlist.gates.size(); ++G) {
+        const Netlist::Gate& gate {netlist.gates[G]};
+        Component* component {netlist.origin[gate.out]};
+        if (!component) continue;
+        const auto cell {netlist.cellOutputs.find(component)};
+        if (cell == netlist.cellOutputs.end()) { shown.push_back({component, gate.out, 0}); continue; }
+        if (lastGate.at(component) != G) continue;
+        for (int K{0}; K < int(cell->second.size()); ++K) { shown.push_back({component, cell->second[K], K}); }
+    }
+    return shown;
+}
+
+
+void SimulationThread::Start()
+{
+    if (worker.joinable()) return;
+    shouldStop = false;
+    worker = std::thread{&SimulationThread::Run, this};
+    return;
+}
+
+
+void SimulationThread::Stop()
+{
+    if (!worker.joinable()) return;
+    shouldStop = true;
+    worker.join();
+    return;
+}
+
+
+void SimulationThread::Run()
+{
+    std::shared_ptr<const Netlist> netlist{};
+    std::shared_ptr<const std::vector<Snapshot::Shown>> shown{};
+    std::vector<Netlist::Word> state{};
+    std::vector<Netlist::Word> published{}; // the last published state; a settled circuit publishes nothing more
+    bool isRunning{false};
+    int stepsPending{0};
+    // memoized groups outlive each netlist; they're re-resolved through its 'origin' on every 'Load'
+    std::vector<std::vector<const Component*>> groups{};
+    std::optional<MemoizedNetlist> memoized{};
+    auto Memoize = [&]() {
+        memoized.reset();
+        if (!netlist || groups.empty()) return;
+        memoized.emplace(*netlist, memoBytesPerGroup);
+        for (const auto& group: groups) {
+            if (!memoized->AddGroup(group)) Log::Warning("simulation thread: a memoized group of {} components doesn't apply to this circuit", group.size());
+        }
+    };
+
+    while (!shouldStop.load(std::memory_order_relaxed))
+    {
+        Command command;
+        while (commands.Pop(command))
+        {
+            switch(command.type)
+            {
+                case Command::Load:
+                    netlist = command.netlist;
+                    shown = std::make_shared<const std::vector<Snapshot::Shown>>(ShownOf(*netlist));
+                    state = netlist->MakeState();
+                    for (std::size_t I{0}; I < command.inputValues.size() && I < netlist->inputs.size(); ++I) {
+                        state[netlist->inputs[I]] = (command.inputValues[I]? ~Netlist::Word{0} : 0);
+                    }
+                    Memoize();
+                    ++stepsPending; // publishing the new circuit's settled state even when paused
+                break;
+
+                case Command::SetInput:
+                    if (!netlist || command.pin >= int(netlist->inputs.size())) break;
+                    state[netlist->inputs[command.pin]] = (command.value? ~Netlist::Word{0} : 0);
+                    ++stepsPending;
+                break;
+
+                case Command::SetRunning: isRunning = command.value; break;
+                case Command::Step: ++stepsPending; break;
+
+                case Command::Group:
+                    if (memoized) {
+                        const ResultCache::Stats totals {memoized->Totals()};
+                        Log::Info("simulation thread: memoized groups so far: {} hits, {} misses ({:.1f}% hit-rate)",
+                            totals.hits, totals.misses, totals.HitRate()*100.0);
+                    }
+                    if (command.group.empty()) groups.clear();
+                    else groups.push_back(std::move(command.group));
+                    Memoize();
+                    Log::Info("simulation thread: {} memoized groups", (memoized? memoized->GroupCount() : 0));
+                break;
+            }
+        }
+
+        if (!netlist || (!isRunning && stepsPending == 0)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        if (memoized) memoized->Evaluate(state);
+        else netlist->Evaluate(state);
+        const std::uint64_t iteration {iterations.fetch_add(1, std::memory_order_relaxed) + 1};
+        const bool isRequested {stepsPending > 0}; // by 'Load', 'SetInput' or 'Step'
+        if (isRequested) --stepsPending;
+        if (!isRequested && state == published) continue;
+        published.assign(state.begin(), state.end());
+
+        Snapshot& snapshot {snapshots.Back()};
+        snapshot.netlist = netlist;
+        snapshot.shown = shown;
+        snapshot.state.assign(state.begin(), state.end());
+        snapshot.iteration = iteration;
+        snapshots.Publish();
+    }
+    return;
+}
+
+
+bool ApplySnapshot(const SimulationThread::Snapshot& snapshot, const std::shared_ptr<const Netlist>& current,
+                   std::vector<Component*>& changed)
+{
+    if (!current || (snapshot.netlist != current) || !snapshot.shown) return false;
+
+    // global inputs are owned by the GUI. An unchanged output isn't shown again: every 'ShowState' recolors its
+    // component, which queues it for the render-cache
+    for (const auto& [component, net, output]: *snapshot.shown) {
+        const bool state (snapshot.state[net] & 1);
+        if (component->ReadOutput(output) == state) continue;
+        component->ShowState(state, output);
+        if (changed.empty() || changed.back() != component) changed.push_back(component); // a cell's outputs are adjacent
+    }
+    return true;
+}
@@ -0,0 +1,118 @@
+#ifndef CIRCUITSIM_SIMULATIONTHREAD_HPP
+#define CIRCUITSIM_SIMULATIONTHREAD_HPP
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Netlist.hpp"
+
+
+// lock-free single-producer/single-consumer ring; 'Push' fails when full, 'Pop' fails when empty
+template <typename T, std::size_t N>
+class SpscQueue
+{
+    std::array<T, N> slots{};
+    alignas(64) std::atomic<std::size_t> head{0}; // next slot to read (consumer-owned)
+    alignas(64) std::atomic<std::size_t> tail{0}; // next slot to write (producer-owned)
+
+    public:
+    bool Push(T item) {
+        const std::size_t next {tail.load(std::memory_order_relaxed)};
+        if (next - head.load(std::memory_order_acquire) == N) return false;
+        slots[next % N] = std::move(item);
+        tail.store(next+1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& item) {
+        const std::size_t H {head.load(std::memory_order_relaxed)};
+        if (H == tail.load(std::memory_order_acquire)) return false;
+        item = std::move(slots[H % N]);
+        head.store(H+1, std::memory_order_release);
+        return true;
+    }
+};
+
+
+// lock-free handoff of the most recent complete value; the writer never waits for the reader.
+// one buffer is owned by each side, the third is the handoff slot (with a 'fresh' bit)
+template <typename T>
+class TripleBuffer
+{
+    std::array<T, 3> buffers{};
+    std::atomic<unsigned> middle{1};
+    unsigned back{0}, front{2};
+    static constexpr unsigned freshBit{4};
+
+    public:
+    T& Back() { return buffers[back]; }
+    void Publish() { back = (middle.exchange(back | freshBit, std::memory_order_acq_rel) & ~freshBit); }
+
+    // returns nullptr if nothing new was published since the last call
+    const T* Latest() {
+        if (!(middle.load(std::memory_order_relaxed) & freshBit)) return nullptr;
+        front = (middle.exchange(front, std::memory_order_acq_rel) & ~freshBit);
+        return &buffers[front];
+    }
+};
+
+
+// runs netlist evaluation on its own thread, so long propagations don't stall the UI.
+// The GUI posts commands (new netlist after edits, input changes, run/step); results come back
+// as snapshots of every net's state, which the render loop applies to the canvas ('ApplySnapshot').
+// While running, a snapshot is only published when some net changed (or a command asked for one).
+// Groups of components can be memoized (see 'MemoizedNetlist'); they're reapplied to every loaded netlist.
+class SimulationThread
+{
+    public:
+    struct Command
+    {
+        enum Type { Load, SetInput, SetRunning, Step, Group, } type;
+        std::shared_ptr<const Netlist> netlist{}; // Load
+        std::vector<bool> inputValues{};          // Load
+        int pin{0};                               // SetInput
+        bool value{false};                        // SetInput, SetRunning
+        std::vector<const Component*> group{};    // Group; only compared with 'Netlist::origin'. Empty clears every group
+    };
+
+    struct Snapshot
+    {
+        struct Shown { Component* component; Netlist::NetID net; int output; }; // an output-pin and the net it shows
+        std::shared_ptr<const Netlist> netlist{}; // the netlist these states belong to
+        std::shared_ptr<const std::vector<Shown>> shown{}; // what 'ApplySnapshot' visits, in order (built once per 'Load')
+        std::vector<Netlist::Word> state{};       // lane 0 of each net
+        std::uint64_t iteration{0};
+    };
+
+    bool Post(Command command) { return commands.Push(std::move(command)); }
+    const Snapshot* Latest() { return snapshots.Latest(); }
+    std::uint64_t Iterations() const { return iterations.load(std::memory_order_relaxed); }
+
+    void Start();
+    void Stop();
+    bool IsStarted() const { return worker.joinable(); }
+
+    SimulationThread() = default;
+    ~SimulationThread() { Stop(); }
+
+    private:
+    SpscQueue<Command, 64> commands{};
+    TripleBuffer<Snapshot> snapshots{};
+    std::atomic<bool> shouldStop{false};
+    std::atomic<std::uint64_t> iterations{0};
+    std::thread worker{};
+
+    void Run();
+};
+
+// copies a snapshot's states onto the components its netlist was extracted from (render-thread only); only output-pins
+// whose state differs are recolored, and their components are appended (once each) to 'changed'. 'current' must be
+// the netlist most recently loaded; stale snapshots are ignored since their components may be gone
+bool ApplySnapshot(const SimulationThread::Snapshot& snapshot, const std::shared_ptr<const Netlist>& current,
+                   std::vector<Component*>& changed);
+
+
+#endif
@@ -0,0 +1,314 @@
+#ifndef CIRCUITSIM_STATICNETLIST_HPP
+#define CIRCUITSIM_STATICNETLIST_HPP
+
+#include <array>
+#include <vector>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include "LogicGate.hpp"
+#include "Netlist.hpp"
+#include "Lut.hpp" // for 'LutGate::VariableTable'
+
+
+// gate-level circuit that's described, levelized and evaluated entirely at compile time, for blocks that never change.
+// Nets follow 'Netlist': 0 is constant-false, then the inputs, then one net per gate (in the order they were added).
+// Mistakes (a loop, a net out of range, too few or too many gates) fail constant-evaluation instead of running
+template<std::size_t InputCount, std::size_t GateCount, std::size_t OutputCount>
+struct StaticNetlist
+{
+    using NetID = int;
+    using Word  = Netlist::Word;
+    static constexpr NetID CONST0{0};
+    static constexpr std::size_t Inputs{InputCount}, Gates{GateCount}, Outputs{OutputCount};
+    static constexpr std::size_t NetCount{1 + InputCount + GateCount};
+
+    struct Gate
+    {
+        LogicGate::OpType type{LogicGate::EQ};
+        NetID A{CONST0}, B{CONST0}; // 'B' is ignored by unary gates
+    };
+
+    std::array<Gate, GateCount> gates{};
+    std::array<NetID, OutputCount> outputs{};
+    std::array<int, GateCount> order{}; // gate-indices in evaluation-order
+    int depth{0}; // levels
+
+    static constexpr NetID Input(std::size_t I) { return NetID(1 + I); }
+    static constexpr NetID Out(std::size_t G) { return NetID(1 + InputCount + G); } // net driven by gate 'G'
+
+    // passed to the lambda given to 'Build'
+    class Builder
+    {
+        StaticNetlist& circuit;
+        std::size_t added{0};
+        friend struct StaticNetlist;
+
+        public:
+        constexpr NetID Input(std::size_t I) const { return StaticNetlist::Input(I); }
+        constexpr NetID Add(LogicGate::OpType T, NetID A, NetID B=CONST0) {
+            if (added >= GateCount) throw std::length_error("StaticNetlist: more gates than declared");
+            circuit.gates[added] = {T, A, B};
+            return Out(added++);
+        }
+        constexpr void Output(std::size_t K, NetID N) { circuit.outputs.at(K) = N; }
+
+        constexpr explicit Builder(StaticNetlist& circuit): circuit{circuit} {;}
+    };
+
+    template<class Describe>
+    static constexpr StaticNetlist Build(Describe&& describe) {
+        StaticNetlist circuit{};
+        Builder builder{circuit};
+        describe(builder);
+        if (builder.added != GateCount) throw std::length_error("StaticNetlist: fewer gates than declared");
+        circuit.Levelize();
+        return circuit;
+    }
+
+    // Kahn's algorithm one level at a time, keeping the gates' relative order within each level (like 'Netlist::Levelize')
+    constexpr void Levelize() {
+        auto isValid = [](NetID N) { return (N >= 0) && (std::size_t(N) < NetCount); };
+        for (const Gate& gate: gates) {
+            if (!isValid(gate.A) || !isValid(gate.B)) throw std::out_of_range("StaticNetlist: fanin out of range");
+        }
+        for (NetID N: outputs) { if (!isValid(N)) throw std::out_of_range("StaticNetlist: output out of range"); }
+
+        std::array<bool, NetCount> isReady{};
+        for (std::size_t N{0}; N <= InputCount; ++N) { isReady[N] = true; }
+        std::size_t placed{0};
+        depth = 0;
+        while (placed < GateCount) {
+            const std::size_t levelStart{placed};
+            for (std::size_t G{0}; G < GateCount; ++G) {
+                const Gate& gate {gates[G]};
+                if (isReady[Out(G)] || !isReady[gate.A] || (!LogicGate::IsUnary(gate.type) && !isReady[gate.B])) continue;
+                order[placed++] = int(G);
+            }
+            if (placed == levelStart) throw std::logic_error("StaticNetlist: combinational loop");
+            for (std::size_t K{levelStart}; K < placed; ++K) { isReady[Out(order[K])] = true; }
+            ++depth;
+        }
+    }
+
+    // one pass over 'order'; see 'StaticBlock' for the unrolled form
+    constexpr std::array<Word, OutputCount> Evaluate(const std::array<Word, InputCount>& in) const {
+        std::array<Word, NetCount> state{};
+        for (std::size_t I{0}; I < InputCount; ++I) { state[Input(I)] = in[I]; }
+        for (int G: order) { state[Out(G)] = LogicGate::EvalWord(gates[G].type, state[gates[G].A], state[gates[G].B]); }
+        std::array<Word, OutputCount> out{};
+        for (std::size_t K{0}; K < OutputCount; ++K) { out[K] = state[outputs[K]]; }
+        return out;
+    }
+
+    // bit 'I' of table 'K' is output 'K' for the input-combination 'I' (input 0 is the lowest index-bit), like 'LutGate::table'
+    constexpr std::array<std::uint64_t, OutputCount> TruthTables() const requires (InputCount <= LutGate::MAX_INPUTS) {
+        std::array<Word, InputCount> in{};
+        for (std::size_t I{0}; I < InputCount; ++I) { in[I] = LutGate::VariableTable(int(I)); }
+        const Word mask {(InputCount == 6)? ~Word{0} : ((Word{1} << (1 << InputCount)) - 1)};
+        std::array<std::uint64_t, OutputCount> tables {Evaluate(in)};
+        for (std::uint64_t& table: tables) { table &= mask; }
+        return tables;
+    }
+
+    // the same circuit for the runtime engine
+    Netlist ToNetlist() const {
+        Netlist netlist{};
+        std::array<Netlist::NetID, NetCount> netOf{}; // 'CONST0' maps to itself
+        for (std::size_t I{0}; I < InputCount; ++I) { netOf[Input(I)] = netlist.AddInput(); }
+        for (int G: order) { netOf[Out(G)] = netlist.AddGate(gates[G].type, netOf[gates[G].A], netOf[gates[G].B]); }
+        for (NetID N: outputs) { netlist.MarkOutput(netOf[N]); }
+        netlist.Levelize();
+        return netlist;
+    }
+
+    // exhaustive check of a runtime netlist (same pin-order) against this one, over every input-combination
+    bool MatchesNetlist(const Netlist& netlist) const requires (InputCount <= 16) {
+        if (netlist.inputs.size() != InputCount || netlist.outputs.size() != OutputCount) return false;
+        const std::size_t words {std::max<std::size_t>((std::size_t{1} << InputCount)/64, 1)};
+        std::vector<Word> state {netlist.MakeState(words)};
+        std::vector<std::array<Word, OutputCount>> expected(words);
+        for (std::size_t W{0}; W < words; ++W) {
+            std::array<Word, InputCount> in{};
+            for (std::size_t I{0}; I < InputCount; ++I) {
+                in[I] = ((I < 6)? LutGate::VariableTable(int(I)) : (Word{0} - ((W >> (I-6)) & 1)));
+                state[netlist.inputs[I]*words + W] = in[I];
+            }
+            expected[W] = Evaluate(in);
+        }
+        netlist.Evaluate(state.data(), words, words);
+
+        const Word mask {(InputCount >= 6)? ~Word{0} : ((Word{1} << (1 << InputCount)) - 1)};
+        for (std::size_t W{0}; W < words; ++W) {
+            for (std::size_t K{0}; K < OutputCount; ++K) {
+                if ((state[netlist.outputs[K]*words + W] ^ expected[W][K]) & mask) return false;
+            }
+        }
+        return true;
+    }
+};
+
+
+// a 'StaticNetlist' as a branchless inline function: every gate is unrolled into its own word-op,
+// with its type known at compile time, so nothing is built, looked up or dispatched at run time
+template<auto Circuit>
+struct StaticBlock
+{
+    using Word = Netlist::Word;
+    static constexpr std::size_t Inputs{Circuit.Inputs}, Outputs{Circuit.Outputs};
+
+    // 64 independent lanes per word
+    static constexpr std::array<Word, Outputs> Evaluate(const std::array<Word, Inputs>& in) {
+        std::array<Word, Circuit.NetCount> state{};
+        for (std::size_t I{0}; I < Inputs; ++I) { state[Circuit.Input(I)] = in[I]; }
+        [&state]<std::size_t... K>(std::index_sequence<K...>) { (Step<K>(state), ...); }(std::make_index_sequence<Circuit.Gates>{});
+        std::array<Word, Outputs> out{};
+        for (std::size_t K{0}; K < Outputs; ++K) { out[K] = state[Circuit.outputs[K]]; }
+        return out;
+    }
+
+    // single vector: bit 'I' of 'inputs' is input 'I', bit 'K' of the result is output 'K'
+    static constexpr std::uint64_t Apply(std::uint64_t inputs) requires (Inputs <= 64 && Outputs <= 64) {
+        std::array<Word, Inputs> in{};
+        for (std::size_t I{0}; I < Inputs; ++I) { in[I] = Word{0} - ((inputs >> I) & 1); } // broadcast, without branching
+        const std::array<Word, Outputs> out {Evaluate(in)};
+        std::uint64_t result{0};
+        for (std::size_t K{0}; K < Outputs; ++K) { result |= ((out[K] & 1) << K); }
+        return result;
+    }
+
+    private:
+    template<std::size_t K>
+    static constexpr void Step(std::array<Word, Circuit.NetCount>& state) {
+        constexpr int G {Circuit.order[K]};
+        constexpr auto gate {Circuit.gates[G]};
+        state[Circuit.Out(G)] = LogicGate::EvalWord(gate.type, state[gate.A], state[gate.B]);
+    }
+};
+
+
+// fixed blocks, checked against their specification while compiling
+struct FixedBlocks
+{
+    template<LogicGate::OpType T>
+    static constexpr auto Gate2 = StaticNetlist<2, 1, 1>::Build([](auto& c) { c.Output(0, c.Add(T, c.Input(0), c.Input(1))); });
+
+    // one-hot: output 'K' is true for input-value 'K'
+    static constexpr auto Decoder2 = StaticNetlist<2, 6, 4>::Build([](auto& c) {
+        const int notA {c.Add(LogicGate::NOT, c.Input(0))}, notB {c.Add(LogicGate::NOT, c.Input(1))};
+        c.Output(0, c.Add(LogicGate::NOR, c.Input(0), c.Input(1)));
+        c.Output(1, c.Add(LogicGate::AND, c.Input(0), notB));
+        c.Output(2, c.Add(LogicGate::AND, notA, c.Input(1)));
+        c.Output(3, c.Add(LogicGate::AND, c.Input(0), c.Input(1)));
+    });
+
+    // output 0 is the sum, output 1 the carry
+    static constexpr auto HalfAdder = StaticNetlist<2, 2, 2>::Build([](auto& c) {
+        c.Output(0, c.Add(LogicGate::XOR, c.Input(0), c.Input(1)));
+        c.Output(1, c.Add(LogicGate::AND, c.Input(0), c.Input(1)));
+    });
+
+    // output 0 is the sum, output 1 the carry
+    static constexpr auto FullAdder = StaticNetlist<3, 5, 2>::Build([](auto& c) {
+        const int half {c.Add(LogicGate::XOR, c.Input(0), c.Input(1))};
+        c.Output(0, c.Add(LogicGate::XOR, half, c.Input(2)));
+        c.Output(1, c.Add(LogicGate::OR, c.Add(LogicGate::AND, c.Input(0), c.Input(1)), c.Add(LogicGate::AND, half, c.Input(2))));
+    });
+
+    // inputs are (A, B, select): 'A' while select is false, 'B' while it's true
+    static constexpr auto Mux2 = StaticNetlist<3, 4, 1>::Build([](auto& c) {
+        const int notS {c.Add(LogicGate::NOT, c.Input(2))};
+        c.Output(0, c.Add(LogicGate::OR, c.Add(LogicGate::AND, c.Input(0), notS), c.Add(LogicGate::AND, c.Input(1), c.Input(2))));
+    });
+
+    // balanced XOR-tree: true for an odd number of set inputs
+    static constexpr auto Parity8 = StaticNetlist<8, 7, 1>::Build([](auto& c) {
+        int level[8] {};
+        for (int I{0}; I < 8; ++I) { level[I] = c.Input(I); }
+        for (int width{8}; width > 1; width /= 2) {
+            for (int I{0}; I < width/2; ++I) { level[I] = c.Add(LogicGate::XOR, level[2*I], level[2*I+1]); }
+        }
+        c.Output(0, level[0]);
+    });
+};
+
+static_assert(FixedBlocks::Gate2<LogicGate::OR>.TruthTables()[0]   == 0b1110);
+static_assert(FixedBlocks::Gate2<LogicGate::NOR>.TruthTables()[0]  == 0b0001);
+static_assert(FixedBlocks::Gate2<LogicGate::AND>.TruthTables()[0]  == 0b1000);
+static_assert(FixedBlocks::Gate2<LogicGate::NAND>.TruthTables()[0] == 0b0111);
+static_assert(FixedBlocks::Gate2<LogicGate::XOR>.TruthTables()[0]  == 0b0110);
+static_assert(FixedBlocks::Gate2<LogicGate::XNOR>.TruthTables()[0] == 0b1001);
+
+static_assert(FixedBlocks::Decoder2.TruthTables() == std::array<std::uint64_t, 4>{0b0001, 0b0010, 0b0100, 0b1000});
+static_assert(FixedBlocks::Decoder2.depth == 2);
+static_assert(FixedBlocks::FullAdder.TruthTables() == std::array<std::uint64_t, 2>{0x96, 0xE8});
+static_assert(FixedBlocks::HalfAdder.TruthTables() == std::array<std::uint64_t, 2>{0b0110, 0b1000});
+static_assert(FixedBlocks::Mux2.TruthTables()[0] == 0xCA);
+static_assert(FixedBlocks::Parity8.depth == 3);
+static_assert([] {
+    for (std::uint64_t V{0}; V < 256; ++V) {
+        if (StaticBlock<FixedBlocks::Parity8>::Apply(V) != std::uint64_t(std::popcount(V) & 1)) return false;
+    }
+    return true;
+}());
+
+
+// bit 'K' of entry 'I' is output 'K' of 'Block' for the input-combination 'I' (input 0 is the lowest bit);
+// blocks with fewer than 3 inputs ignore the higher bits
+template<auto Block>
+inline constexpr std::array<std::uint8_t, 8> CellTable = [] {
+    static_assert(Block.Inputs <= 3 && Block.Outputs <= 8);
+    std::array<std::uint8_t, 8> table{};
+    for (unsigned I{0}; I < 8; ++I) { table[I] = std::uint8_t(StaticBlock<Block>::Apply(I % (1u << Block.Inputs))); }
+    return table;
+}();
+
+
+// the fixed block behind each of the canvas' cells ('LogicGate::IsCell'): its fused kernel, and its gates for 'Netlist::Extract'
+struct CellBlocks
+{
+    // passes the cell's 'StaticNetlist' to 'lambda'
+    template<class Lambda>
+    static constexpr void Visit(LogicGate::OpType T, Lambda&& lambda) {
+        switch(T) {
+            case LogicGate::HALF_ADDER: lambda(FixedBlocks::HalfAdder); break;
+            case LogicGate::FULL_ADDER: lambda(FixedBlocks::FullAdder); break;
+            case LogicGate::MUX:        lambda(FixedBlocks::Mux2);      break;
+            case LogicGate::DECODER:    lambda(FixedBlocks::Decoder2);  break;
+            default: break;
+        }
+    }
+
+    // the whole cell as one table-lookup, however many gates its block has: bit 'K' of the result is
+    // output 'K' for the input-combination 'inputs' (input 0 is the lowest bit)
+    static constexpr unsigned Outputs(LogicGate::OpType T, unsigned inputs) {
+        return (LogicGate::IsCell(T)? tables[T - LogicGate::FIRST_CELL][inputs & 7] : 0);
+    }
+
+    private:
+    static constexpr std::array<std::array<std::uint8_t, 8>, LogicGate::LAST_ENUM - LogicGate::FIRST_CELL> tables {
+        CellTable<FixedBlocks::HalfAdder>, CellTable<FixedBlocks::FullAdder>, CellTable<FixedBlocks::Mux2>, CellTable<FixedBlocks::Decoder2>,
+    };
+    static_assert(LogicGate::HALF_ADDER == LogicGate::FIRST_CELL && LogicGate::DECODER+1 == LogicGate::LAST_ENUM); // the order of 'tables'
+};
+
+// the pin-counts in 'LogicGate' have to match the blocks
+static_assert([] {
+    bool isMatching{true};
+    for (int T{LogicGate::FIRST_CELL}; T < LogicGate::LAST_ENUM; ++T) {
+        CellBlocks::Visit(LogicGate::OpType(T), [&](const auto& block) {
+            isMatching &= (int(block.Inputs) == LogicGate::InputCount(LogicGate::OpType(T)));
+            isMatching &= (int(block.Outputs) == LogicGate::OutputCount(LogicGate::OpType(T)));
+        });
+    }
+    return isMatching;
+}());
+static_assert(CellBlocks::Outputs(LogicGate::FULL_ADDER, 0b111) == 0b11 && CellBlocks::Outputs(LogicGate::FULL_ADDER, 0b100) == 0b01);
+static_assert(CellBlocks::Outputs(LogicGate::DECODER, 0b10) == 0b0100 && CellBlocks::Outputs(LogicGate::MUX, 0b110) == 1);
+
+
+#endif
@@ -0,0 +1,78 @@
+#include "Subcircuit.hpp"
+
+#include <cassert>
+#include <random>
+#include <string>
+
+
+std::vector<Netlist::NetID> SubcircuitDef::Instantiate(const SubcircuitDef& child, const std::vector<NetID>& pinNets)
+{
+    assert(pinNets.size() == child.inputs.size());
+
+    // mapping the child's nets into this definition; its constant stays constant
+    std::vector<NetID> remap(child.NetCount(), CONST0);
+    for (std::size_t I{0}; I < child.inputs.size(); ++I) { remap[child.inputs[I]] = pinNets[I]; }
+
+    // gates are visited in the child's order, but any forward references are patched afterwards
+    const std::size_t firstGate{gates.size()};
+    for (const Gate& gate: child.gates) { remap[gate.out] = AddGate(gate.type, CONST0, CONST0); }
+    for (std::size_t I{0}; I < child.gates.size(); ++I) {
+        gates[firstGate+I].A = remap[child.gates[I].A];
+        gates[firstGate+I].B = remap[child.gates[I].B];
+    }
+
+    std::vector<NetID> outputNets{}; outputNets.reserve(child.outputs.size());
+    for (NetID N: child.outputs) { outputNets.push_back(remap[N]); }
+    return outputNets;
+}
+
+
+SubcircuitBank::SubcircuitBank(const SubcircuitDef& D, std::size_t N): def{D}, count{N}
+{
+    assert(def.IsLevelized() && count > 0);
+    for (std::size_t I{0}; I < count; ++I) {
+        for (NetID pin: def.inputs)  { inputs.push_back(Row(pin, I)); }
+        for (NetID pin: def.outputs) { outputs.push_back(Row(pin, I)); }
+    }
+}
+
+
+void SubcircuitBank::Evaluate(Word* state, std::size_t stride, std::size_t words) const
+{
+    // with whole rows, every net's instances are one run of words; a partial batch leaves gaps between them,
+    // so each instance gets its own pass (with the rows of the other instances stepped over)
+    if (words == stride) { def.Evaluate(state, count*stride, count*stride); return; }
+    for (std::size_t I{0}; I < count; ++I) { def.Evaluate(state + I*stride, count*stride, words); }
+    return;
+}
+
+
+SubcircuitDef SubcircuitBank::Flatten() const
+{
+    SubcircuitDef flat{def.name + 'x' + std::to_string(count)};
+    for (std::size_t I{0}; I < count; ++I) {
+        std::vector<NetID> pinNets{};
+        for (std::size_t pin{0}; pin < def.inputs.size(); ++pin) { pinNets.push_back(flat.AddInput()); }
+        for (NetID N: flat.Instantiate(def, pinNets)) { flat.MarkOutput(N); }
+    }
+    flat.Levelize();
+    return flat;
+}
+
+
+bool SimulateEquivalent(const Netlist& A, const SubcircuitBank& B, int rounds)
+{
+    if (A.inputs.size() != B.inputs.size() || A.outputs.size() != B.outputs.size()) return false;
+
+    std::mt19937_64 random{0x5EED};
+    std::vector<Netlist::Word> stateA {A.MakeState()}, stateB {B.MakeState()};
+    for (int R{0}; R < rounds; ++R)
+    {
+        for (std::size_t I{0}; I < A.inputs.size(); ++I) { stateA[A.inputs[I]] = stateB[B.inputs[I]] = random(); }
+        A.Evaluate(stateA); B.Evaluate(stateB);
+        for (std::size_t I{0}; I < A.outputs.size(); ++I) {
+            if (stateA[A.outputs[I]] != stateB[B.outputs[I]]) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef CIRCUITSIM_SUBCIRCUIT_HPP
+#define CIRCUITSIM_SUBCIRCUIT_HPP
+
+#include <string>
+#include <vector>
+
+#include "Netlist.hpp"
+
+
+// a reusable block with defined I/O pins; its gate-schedule is stored once per definition.
+// 'inputs'/'outputs' of the underlying netlist are the pins, in declaration order.
+class SubcircuitDef: public Netlist
+{
+    public:
+    const std::string name;
+
+    int InputPinCount()  const { return int(inputs.size()); }
+    int OutputPinCount() const { return int(outputs.size()); }
+
+    // inlines a child definition, wiring its input-pins to 'pinNets'; returns the nets of its output-pins.
+    // hierarchy is flattened once here, so instances never walk nested definitions
+    std::vector<NetID> Instantiate(const SubcircuitDef& child, const std::vector<NetID>& pinNets);
+
+    explicit SubcircuitDef(std::string N): name{N} {;}
+    SubcircuitDef(std::string N, Netlist body): Netlist{std::move(body)}, name{N} {;} // e.g. an extracted canvas
+};
+
+
+// 'count' instances of one definition, simulated as a single circuit whose pins are instance 0's pins, then
+// instance 1's, and so on (see 'RunVectorStream'). Only per-instance state exists: instance 'I' of the definition's
+// net 'N' is the state-row N*count + I, so each gate's rows for every instance are contiguous, and the definition's
+// schedule runs once with 'count' times the words per gate
+class SubcircuitBank
+{
+    public:
+    using NetID = Netlist::NetID;
+    using Word  = Netlist::Word;
+
+    std::vector<NetID> inputs;  // state-rows of every instance's pins
+    std::vector<NetID> outputs;
+
+    const SubcircuitDef& Definition() const { return def; }
+    std::size_t Count() const { return count; }
+    NetID Row(NetID N, std::size_t instance) const { return NetID(N*count + instance); }
+
+    std::vector<Word> MakeState(std::size_t stride=1) const { return std::vector<Word>(std::size_t(def.NetCount())*count*stride, 0); }
+    // like 'Netlist::Evaluate', over 'words' lane-words of every instance
+    void Evaluate(Word* state, std::size_t stride, std::size_t words) const;
+    void Evaluate(std::vector<Word>& state) const { Evaluate(state.data(), 1, 1); }
+
+    // the same circuit as 'count' separate copies, inlined into one definition (for checking)
+    SubcircuitDef Flatten() const;
+
+    // the definition must be complete (and outlive the bank); 'count' times its nets must fit a 'NetID'
+    SubcircuitBank(const SubcircuitDef& D, std::size_t N);
+
+    private:
+    const SubcircuitDef& def;
+    std::size_t count;
+};
+
+// compares a flat netlist against a bank over random vectors
+bool SimulateEquivalent(const Netlist& A, const SubcircuitBank& B, int rounds=16);
+
+
+#endif
@@ -1,37 +1,175 @@
 #include "TextureStorage.hpp"
 
 #include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <iterator> // std::size
+#include <algorithm>
+#include <string_view>
+
+// generated by the makefile from 'LogicGateSpriteSheet.png' (see 'tools/EmbedAtlas.cpp')
+#if __has_include("SpriteAtlas.inc")
+  #include "SpriteAtlas.inc"
+  #define HAS_EMBEDDED_ATLAS
+#endif
 
 
 // static members
 sf::Image TextureStorage::spriteSheet;
 sf::Texture TextureStorage::spriteSheetTexture;
+sf::Texture TextureStorage::cellSheetTexture;
 std::array<sf::Sprite, LogicGate::LAST_ENUM*2> TextureStorage::sprites;
 
 
+#ifdef HAS_EMBEDDED_ATLAS
+// expands the pre-downscaled atlas straight into the texture; no image-decoding or file-access
+static bool LoadEmbeddedAtlas(sf::Texture& texture)
+{
+    std::vector<std::uint8_t> pixels; pixels.reserve(EmbeddedAtlas::width*EmbeddedAtlas::height*4);
+    for (std::size_t I{0}; I+1 < std::size(EmbeddedAtlas::runs); I += 2) {
+        const std::uint32_t pixel {EmbeddedAtlas::runs[I+1]};
+        const std::uint8_t rgba[4] { std::uint8_t(pixel), std::uint8_t(pixel >> 8), std::uint8_t(pixel >> 16), std::uint8_t(pixel >> 24) };
+        for (std::uint32_t N{0}; N < EmbeddedAtlas::runs[I]; ++N) { pixels.insert(pixels.end(), rgba, rgba+4); }
+    }
+    if (pixels.size() != std::size_t(EmbeddedAtlas::width*EmbeddedAtlas::height*4)) return false;
+    if (!texture.create(EmbeddedAtlas::width, EmbeddedAtlas::height)) return false;
+    texture.update(pixels.data());
+    return true;
+}
+#endif
+
+
+sf::IntRect TextureStorage::Slot(LogicGate::OpType T)
+{
+    constexpr int imgsz{1024};
+    constexpr int W {imgsz/2}, H {imgsz/4};
+    if (!LogicGate::IsCell(T)) return sf::IntRect(W*(T%2), H*(T/2), W, H);
+    const int K {T - LogicGate::FIRST_CELL};
+    return sf::IntRect(W*(K%2), imgsz + 2*H*(K/2), W, 2*H); // below the sprite-sheet's four rows
+}
+
+
+// the cells, in the sprite-sheet's style: an outline with pin-stubs, labelled in a 5x7 pixel-font. Laid out like
+// the sprite-sheet (red sprites offset by 1024 pixels), at the slots' positions shifted up by the sheet's height
+static bool DrawCellSheet(sf::Texture& texture, float atlasScale)
+{
+    constexpr int imgsz{1024};
+    constexpr int W {imgsz/2};
+    const int width {int(std::lround(2*imgsz*atlasScale))}, height {int(std::lround(imgsz*atlasScale))};
+    std::vector<std::uint8_t> pixels(std::size_t(width)*height*4, 0); // transparent
+    
+    // in unscaled sheet-pixels
+    auto fill = [&](float left, float top, float right, float bottom, sf::Color color) {
+        const int X0 {std::max(0, int(std::lround(left*atlasScale)))}, X1 {std::min(width,  int(std::lround(right*atlasScale)))};
+        const int Y0 {std::max(0, int(std::lround(top*atlasScale)))},  Y1 {std::min(height, int(std::lround(bottom*atlasScale)))};
+        for (int Y{Y0}; Y < Y1; ++Y) {
+            for (int X{X0}; X < X1; ++X) {
+                std::uint8_t* pixel {&pixels[(std::size_t(Y)*width + X)*4]};
+                pixel[0] = color.r; pixel[1] = color.g; pixel[2] = color.b; pixel[3] = color.a;
+            }
+        }
+    };
+    
+    struct Glyph { char letter; std::uint8_t rows[7]; }; // 5 bits per row, leftmost pixel highest
+    constexpr Glyph font[] {
+        {'A', {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}}, {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+        {'D', {0x1E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1E}}, {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+        {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}}, {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+        {'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}}, {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+        {'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+    };
+    constexpr std::string_view labels[] {"HA", "FA", "MUX", "DEC"}; // by 'T - FIRST_CELL'
+    static_assert(std::size(labels) == LogicGate::LAST_ENUM - LogicGate::FIRST_CELL);
+    constexpr float dot{12.f}, line{8.f}, outline{12.f}; // pixel-font size, pin-stub and outline thickness
+    constexpr float bodyLeft{136.f}, bodyRight{376.f}, margin{24.f};
+    
+    for (int offset{0}; offset < 2; ++offset)
+    {
+        const sf::Color color {offset? sf::Color::Red : sf::Color::Black};
+        for (int T{LogicGate::FIRST_CELL}; T < LogicGate::LAST_ENUM; ++T)
+        {
+            const sf::IntRect slot {TextureStorage::Slot(LogicGate::OpType(T))};
+            const float X {float(slot.left + imgsz*offset)}, Y {float(slot.top - imgsz)}, height {float(slot.height)};
+            
+            fill(X+bodyLeft, Y+margin, X+bodyRight, Y+margin+outline, color);
+            fill(X+bodyLeft, Y+height-margin-outline, X+bodyRight, Y+height-margin, color);
+            fill(X+bodyLeft, Y+margin, X+bodyLeft+outline, Y+height-margin, color);
+            fill(X+bodyRight-outline, Y+margin, X+bodyRight, Y+height-margin, color);
+            
+            // where 'Component::SetPosition' puts the pins
+            const int inputs {LogicGate::InputCount(LogicGate::OpType(T))}, outputs {LogicGate::OutputCount(LogicGate::OpType(T))};
+            for (int I{0}; I < inputs; ++I) {
+                const float pinY {Y + height*(1 + 2*I)/(2*inputs)};
+                fill(X, pinY-line/2.f, X+bodyLeft, pinY+line/2.f, color);
+            }
+            for (int K{0}; K < outputs; ++K) {
+                const float pinY {Y + height*(1 + 2*K)/(2*outputs)};
+                fill(X+bodyRight, pinY-line/2.f, X+W, pinY+line/2.f, color);
+            }
+            
+            const std::string_view label {labels[T - LogicGate::FIRST_CELL]};
+            float textX {X + W/2.f - (label.size()*6 - 1)*dot/2.f};
+            const float textY {Y + height/2.f - 3.5f*dot};
+            for (char letter: label) {
+                const Glyph* glyph {std::find_if(std::begin(font), std::end(font), [letter](const Glyph& G) { return G.letter == letter; })};
+                for (int R{0}; R < 7; ++R) {
+                    for (int C{0}; C < 5; ++C) {
+                        if ((glyph->rows[R] >> (4-C)) & 1) fill(textX + C*dot, textY + R*dot, textX + (C+1)*dot, textY + (R+1)*dot, sf::Color::Black);
+                    }
+                }
+                textX += 6*dot;
+            }
+        }
+    }
+    if (!texture.create(width, height)) return false;
+    texture.update(pixels.data());
+    return true;
+}
+
+
 int TextureStorage::Init(float scale)
 {
-    const std::string spriteSheetPath {"LogicGateSpriteSheet.png"};
-    if(!spriteSheet.loadFromFile(spriteSheetPath)) {
-        std::cerr << "Failed to load image: '" << spriteSheetPath << "'\n Exiting.\n"; return 1;
+    float atlasScale {1.f}; // size of the loaded atlas relative to the original sprite-sheet
+    
+    #ifdef HAS_EMBEDDED_ATLAS
+    // the embedded atlas is only used when it doesn't need to be magnified
+    if ((scale <= EmbeddedAtlas::scale) && LoadEmbeddedAtlas(spriteSheetTexture)) { atlasScale = EmbeddedAtlas::scale; }
+    else
+    #endif
+    {
+        const std::string spriteSheetPath {"LogicGateSpriteSheet.png"};
+        if(!spriteSheet.loadFromFile(spriteSheetPath)) {
+            std::cerr << "Failed to load image: '" << spriteSheetPath << "'\n Exiting.\n"; return 1;
+        }
+        if(!spriteSheetTexture.loadFromImage(spriteSheet /*, sf::IntRect(0, 0, 1024, 1024)*/)) {
+            std::cout << "Failed to set texture!\n Exiting.\n"; return 2;
+        }
     }
     spriteSheetTexture.setSmooth(true);
-    if(!spriteSheetTexture.loadFromImage(spriteSheet /*, sf::IntRect(0, 0, 1024, 1024)*/)) {
-        std::cout << "Failed to set texture!\n Exiting.\n"; return 2;
+    spriteSheetTexture.generateMipmap(); // sprites are drawn smaller than the atlas when 'scale < atlasScale'
+    
+    if (!DrawCellSheet(cellSheetTexture, atlasScale)) {
+        std::cout << "Failed to create the cells' texture!\n Exiting.\n"; return 3;
     }
+    cellSheetTexture.setSmooth(true);
+    cellSheetTexture.generateMipmap();
     
     constexpr int imgsz{1024}; // square 1024x1024
-    constexpr int W {imgsz/2}, H {imgsz/4}; // sprite dimensions
+    const float drawScale {scale/atlasScale};
+    auto toAtlas = [atlasScale](int px) { return int(std::lround(px*atlasScale)); };
     
     for (int offset{0}; offset < 2; ++offset)
     {  // looping for red sprites (horizontal offset by 1024 pixels)
         for (int i{0}; i < LogicGate::LAST_ENUM; ++i) 
         {
-            const int X {W*(i%2)}, Y {H*(i/2)}; // two sprites per row
+            const auto [X, Y, W, H] = Slot(LogicGate::OpType(i));
+            const bool isCell {LogicGate::IsCell(LogicGate::OpType(i))};
+            const int sheetY {isCell? Y-imgsz : Y}; // see 'DrawCellSheet'
             
             sf::Sprite& sprite = sprites[i+int(offset*LogicGate::LAST_ENUM)];
-            sprite = sf::Sprite{spriteSheetTexture, sf::IntRect(X+(imgsz*offset), Y, W, H)};
-            sprite.setScale(scale, scale);
+            sprite = sf::Sprite{(isCell? cellSheetTexture : spriteSheetTexture), sf::IntRect(toAtlas(X+(imgsz*offset)), toAtlas(sheetY), toAtlas(W), toAtlas(H))};
+            sprite.setScale(drawScale, drawScale);
             #ifdef SELECTORWINDOW_DEBUG
               const float xOffset{float(imgsz*offset)/4.f}; // division by four is required because window width (and h-scaling) also doubles
             #else
@@ -44,5 +182,3 @@ int TextureStorage::Init(float scale)
     
     return 0;
 }
-
-
@@ -18,12 +18,17 @@ struct TextureStorage
 {
     static sf::Image spriteSheet;
     static sf::Texture spriteSheetTexture;
+    static sf::Texture cellSheetTexture; // the sprite-sheet only has the primitive gates; cells are drawn at startup
     static std::array<sf::Sprite, LogicGate::LAST_ENUM*2> sprites;
     
     static sf::Sprite GetSprite(LogicGate::OpType T, bool isRed=false) { 
         return (isRed? sprites[T+LogicGate::LAST_ENUM] : sprites[T]); 
     }
     
+    // each type's place in the selector-window, in sprite-sheet pixels (before scaling): two sprites per row,
+    // with the cells' rows twice as tall, so their pins are spaced like the gates'
+    static sf::IntRect Slot(LogicGate::OpType T);
+    
     static int Init(float scale=1.0f); // returns non-zero on failure
 };
 
@@ -0,0 +1,337 @@
+#include "Timing.hpp"
+#include "Interactives.hpp"
+#include "ComponentMap.hpp"
+#include "StaticNetlist.hpp" // 'CellBlocks'
+
+#include <queue>
+#include <chrono>
+#include <format>
+#include <algorithm>
+#include <type_traits>
+#include <functional>
+#include <unordered_set>
+
+
+DelayModel DelayModel::Default()
+{
+    DelayModel model{};
+    model.delay[LogicGate::EQ]   = 0.0;
+    model.delay[LogicGate::NOT]  = 1.0;
+    model.delay[LogicGate::NAND] = 1.0;
+    model.delay[LogicGate::NOR]  = 1.2;
+    model.delay[LogicGate::AND]  = 1.4;
+    model.delay[LogicGate::OR]   = 1.6;
+    model.delay[LogicGate::XOR]  = 2.2;
+    model.delay[LogicGate::XNOR] = 2.2;
+    
+    // a cell takes as long as the slowest path through its block
+    for (int T{LogicGate::FIRST_CELL}; T < LogicGate::LAST_ENUM; ++T) {
+        CellBlocks::Visit(LogicGate::OpType(T), [&model, T](const auto& block) {
+            std::array<double, std::decay_t<decltype(block)>::NetCount> arrival{};
+            for (int G: block.order) {
+                const auto& gate {block.gates[G]};
+                const double fanin {LogicGate::IsUnary(gate.type)? arrival[gate.A] : std::max(arrival[gate.A], arrival[gate.B])};
+                arrival[block.Out(G)] = fanin + model.delay[gate.type];
+            }
+            for (int N: block.outputs) { model.delay[T] = std::max(model.delay[T], arrival[N]); }
+        });
+    }
+    return model;
+}
+
+
+void TimingGraph::Clear()
+{
+    nodes.clear(); outputNodes.clear();
+    criticalDelay = 0; depth = 0;
+    loopConnections.clear();
+    isBuilt = false;
+}
+
+
+TimingGraph::Node& TimingGraph::Ensure(Component* component, std::vector<Component*>* discovered)
+{
+    auto [iter, isNew] = nodes.try_emplace(component, Node{component});
+    Node& node {iter->second};
+    if (isNew) {
+        const bool isPad {component->isGlobalIn || component->isGlobalOut};
+        node.delay = (isPad? 0.0 : model[component->gate.mType]);
+        if (component->isGlobalOut) outputNodes.push_back(&node);
+        if (discovered) discovered->push_back(component);
+    }
+    return node;
+}
+
+
+bool TimingGraph::Reaches(Node* from, const Node* target)
+{
+    ++visitStamp;
+    std::vector<Node*> stack{from};
+    from->visit = visitStamp;
+    while (!stack.empty()) {
+        Node* node {stack.back()}; stack.pop_back();
+        if (node == target) return true;
+        for (Node* next: node->fanout) {
+            if (next->visit == visitStamp || (next != target && next->level >= target->level)) continue;
+            next->visit = visitStamp; stack.push_back(next);
+        }
+    }
+    return false;
+}
+
+
+void TimingGraph::Raise(Node& node, int level)
+{
+    if (node.level >= level) return;
+    std::vector<Node*> stack{&node};
+    node.level = level;
+    while (!stack.empty()) {
+        Node* raised {stack.back()}; stack.pop_back();
+        for (Node* next: raised->fanout) {
+            if (next->level > raised->level) continue;
+            next->level = raised->level + 1; stack.push_back(next);
+        }
+    }
+}
+
+
+bool TimingGraph::Forward(Node& node)
+{
+    double arrival {UNTIMED};
+    int logicDepth{0}, level{0};
+    for (const Node* fanin: node.fanin) {
+        level = std::max(level, fanin->level + 1);
+        if (fanin->arrival == UNTIMED) continue; // constants (nothing connected upstream) don't count
+        arrival = std::max(arrival, fanin->arrival);
+        logicDepth = std::max(logicDepth, fanin->depth);
+    }
+    if (node.component->isGlobalIn) { arrival = 0.0; logicDepth = 0; }
+    else if (arrival != UNTIMED) { arrival += node.delay; logicDepth += (node.component->isGlobalOut? 0 : 1); }
+
+    const bool isChanged {(arrival != node.arrival) || (logicDepth != node.depth) || (level != node.level)};
+    node.arrival = arrival; node.depth = logicDepth; node.level = level;
+    return isChanged;
+}
+
+
+bool TimingGraph::Backward(Node& node)
+{
+    double tail {node.component->isGlobalOut? 0.0 : UNTIMED};
+    for (const Node* fanout: node.fanout) {
+        if (fanout->tail != UNTIMED) tail = std::max(tail, fanout->tail + fanout->delay);
+    }
+    const bool isChanged {tail != node.tail};
+    node.tail = tail;
+    return isChanged;
+}
+
+
+// worklists ordered by rank: lowest first for arrival, highest first for tails, so each node is normally
+// visited once; it's requeued whenever one of its inputs changes, so a stale rank only costs extra visits
+void TimingGraph::Propagate(std::vector<Node*>& forward, std::vector<Node*>& backward)
+{
+    using Entry = std::pair<int, Node*>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> shallowest{};
+    for (Node* node: forward) { if (!node->isQueued) { node->isQueued = true; shallowest.emplace(node->level, node); } }
+    while (!shallowest.empty()) {
+        Node* node {shallowest.top().second}; shallowest.pop();
+        node->isQueued = false; ++lastUpdateVisits;
+        if (!Forward(*node)) continue;
+        for (Node* next: node->fanout) { if (!next->isQueued) { next->isQueued = true; shallowest.emplace(next->level, next); } }
+    }
+
+    std::priority_queue<Entry> deepest{};
+    for (Node* node: backward) { if (!node->isQueued) { node->isQueued = true; deepest.emplace(node->level, node); } }
+    while (!deepest.empty()) {
+        Node* node {deepest.top().second}; deepest.pop();
+        node->isQueued = false; ++lastUpdateVisits;
+        if (!Backward(*node)) continue;
+        for (Node* next: node->fanin) { if (!next->isQueued) { next->isQueued = true; deepest.emplace(next->level, next); } }
+    }
+}
+
+
+void TimingGraph::UpdateCritical()
+{
+    criticalDelay = 0; depth = 0;
+    for (const Node* node: outputNodes) {
+        if (node->arrival == UNTIMED) continue;
+        criticalDelay = std::max(criticalDelay, node->arrival);
+        depth = std::max(depth, node->depth);
+    }
+}
+
+
+void TimingGraph::Build(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput)
+{
+    const auto startTime {std::chrono::steady_clock::now()};
+    Clear();
+    for (Component& component: globalInputs) { Ensure(&component); }
+    components.ForEach([this](Component& component) { Ensure(&component); });
+    for (Component& component: globalOutput) { Ensure(&component); }
+
+    for (auto& [component, node]: nodes) {
+        for (auto [pinUUID, source]: component->incoming) {
+            auto found = nodes.find(source);
+            if (found == nodes.end() || std::find(node.fanin.begin(), node.fanin.end(), &found->second) != node.fanin.end()) continue;
+            node.fanin.push_back(&found->second);
+            found->second.fanout.push_back(&node);
+        }
+    }
+
+    // depth-first over fanout: edges back onto the stack close loops and are set aside;
+    // reversed post-order is then a topological order of what remains
+    std::vector<Node*> postOrder{}; postOrder.reserve(nodes.size());
+    std::vector<std::pair<Node*, Node*>> backEdges{};
+    std::unordered_map<Node*, std::uint8_t> color{}; // absent: unvisited, 1: on stack, 2: done
+    std::vector<std::pair<Node*, std::size_t>> stack{};
+    for (auto& [component, root]: nodes) {
+        if (color.contains(&root)) continue;
+        stack.emplace_back(&root, 0); color[&root] = 1;
+        while (!stack.empty()) {
+            auto& [node, K] {stack.back()};
+            if (K < node->fanout.size()) {
+                Node* next {node->fanout[K++]};
+                auto found = color.find(next);
+                if (found == color.end()) { color[next] = 1; stack.emplace_back(next, 0); }
+                else if (found->second == 1) backEdges.emplace_back(node, next);
+                continue;
+            }
+            color[node] = 2; postOrder.push_back(node);
+            stack.pop_back();
+        }
+    }
+    for (auto [source, target]: backEdges) {
+        std::erase(source->fanout, target);
+        std::erase(target->fanin, source);
+    }
+    loopConnections = std::move(backEdges);
+
+    for (auto iter = postOrder.rbegin(); iter != postOrder.rend(); ++iter) { Forward(**iter); }
+    for (Node* node: postOrder) { Backward(*node); }
+    UpdateCritical();
+    isBuilt = true;
+    lastUpdateVisits = nodes.size()*2;
+    lastUpdateMicroseconds = std::chrono::duration<double, std::micro>{std::chrono::steady_clock::now() - startTime}.count();
+}
+
+
+void TimingGraph::Update(const std::vector<Component*>& changed, const std::vector<Component*>& removed)
+{
+    if (!isBuilt) return;
+    const auto startTime {std::chrono::steady_clock::now()};
+    lastUpdateVisits = 0;
+    std::vector<Node*> forward{}, backward{};
+
+    // detaching removed nodes first; they're erased once nothing can refer to them anymore
+    std::unordered_set<const Node*> gone{};
+    for (Component* component: removed) {
+        auto found = nodes.find(component);
+        if (found == nodes.end()) continue;
+        Node& node {found->second};
+        gone.insert(&node);
+        for (Node* fanin: node.fanin)   { std::erase(fanin->fanout, &node); backward.push_back(fanin); }
+        for (Node* fanout: node.fanout) { std::erase(fanout->fanin, &node); forward.push_back(fanout); }
+        node.fanin.clear(); node.fanout.clear();
+    }
+
+    // re-reading fanin from 'incoming'; new components are appended to 'work' as they're found
+    std::vector<Component*> work {changed};
+    for (std::size_t I{0}; I < work.size(); ++I)
+    {
+        Node& node {Ensure(work[I], &work)};
+        if (gone.contains(&node)) continue;
+        std::vector<Node*> desired{};
+        for (auto [pinUUID, source]: work[I]->incoming) {
+            Node* fanin {&Ensure(source, &work)};
+            if (!gone.contains(fanin) && std::find(desired.begin(), desired.end(), fanin) == desired.end()) desired.push_back(fanin);
+        }
+
+        bool isChanged{false};
+        for (Node* fanin: std::vector<Node*>{node.fanin}) {
+            if (std::find(desired.begin(), desired.end(), fanin) != desired.end()) continue;
+            std::erase(node.fanin, fanin); std::erase(fanin->fanout, &node);
+            backward.push_back(fanin); isChanged = true;
+        }
+        // the connections ignored here are decided again, from 'desired'
+        isChanged |= (std::erase_if(loopConnections, [&](const auto& connection) { return connection.second == &node; }) > 0);
+        for (Node* fanin: desired) {
+            if (std::find(node.fanin.begin(), node.fanin.end(), fanin) != node.fanin.end()) continue;
+            if (fanin == &node || Reaches(&node, fanin)) { loopConnections.emplace_back(fanin, &node); continue; }
+            node.fanin.push_back(fanin); fanin->fanout.push_back(&node);
+            Raise(node, fanin->level + 1);
+            backward.push_back(fanin); isChanged = true;
+        }
+        if (isChanged || node.arrival == UNTIMED) { forward.push_back(&node); backward.push_back(&node); }
+    }
+
+    // a loop can be opened by any edit along it, not only at the connection that was ignored, so every ignored
+    // connection is retried; one that no longer closes a loop is restored (as 'Build' would have kept it)
+    for (std::size_t I{0}; I < loopConnections.size();) {
+        auto [source, target] {loopConnections[I]};
+        const bool isGone {gone.contains(source) || gone.contains(target)};
+        if (!isGone && (source == target || Reaches(target, source))) { ++I; continue; }
+        loopConnections[I] = loopConnections.back(); loopConnections.pop_back();
+        if (isGone) continue;
+        target->fanin.push_back(source); source->fanout.push_back(target);
+        Raise(*target, source->level + 1);
+        forward.push_back(target); backward.push_back(target); backward.push_back(source);
+    }
+
+    std::erase_if(forward,  [&](Node* node) { return gone.contains(node); });
+    std::erase_if(backward, [&](Node* node) { return gone.contains(node); });
+    for (Component* component: removed) { nodes.erase(component); }
+
+    Propagate(forward, backward);
+    UpdateCritical();
+    lastUpdateMicroseconds = std::chrono::duration<double, std::micro>{std::chrono::steady_clock::now() - startTime}.count();
+}
+
+
+double TimingGraph::Arrival(const Component* component) const
+{
+    auto found = nodes.find(component);
+    return ((found == nodes.end())? UNTIMED : found->second.arrival);
+}
+
+
+double TimingGraph::Slack(const Component* component) const
+{
+    auto found = nodes.find(component);
+    if (found == nodes.end() || found->second.arrival == UNTIMED || found->second.tail == UNTIMED) return std::numeric_limits<double>::infinity();
+    return criticalDelay - found->second.tail - found->second.arrival;
+}
+
+
+std::vector<Component*> TimingGraph::CriticalPath() const
+{
+    const Node* node{nullptr};
+    for (const Node* output: outputNodes) {
+        if (output->arrival != UNTIMED && (!node || output->arrival > node->arrival)) node = output;
+    }
+    std::vector<Component*> path{};
+    while (node) {
+        path.push_back(node->component);
+        const Node* latest{nullptr};
+        for (const Node* fanin: node->fanin) {
+            if (fanin->arrival != UNTIMED && (!latest || fanin->arrival > latest->arrival)) latest = fanin;
+        }
+        node = latest;
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+
+std::string TimingGraph::Report() const
+{
+    std::string text {std::format("timing: critical delay {:.2f} over {} levels | {} components, {} loop-connections ignored\n",
+        criticalDelay, depth, nodes.size(), loopConnections.size())};
+    text += std::format("\tlast update: {} visits in {:.0f}us\n", lastUpdateVisits, lastUpdateMicroseconds);
+    text += "\tcritical path:";
+    for (const Component* component: CriticalPath()) {
+        text += std::format(" {}@{:.2f}", component->UUID(), Arrival(component));
+    }
+    text += '\n';
+    return text;
+}
@@ -0,0 +1,91 @@
+#ifndef CIRCUITSIM_TIMING_HPP
+#define CIRCUITSIM_TIMING_HPP
+
+#include <array>
+#include <utility>
+#include <vector>
+#include <string>
+#include <limits>
+#include <unordered_map>
+
+#include "LogicGate.hpp"
+
+class Component;
+class ComponentMap;
+
+
+// gate delays per 'OpType', in arbitrary units (1 ~ one NAND)
+struct DelayModel
+{
+    std::array<double, LogicGate::LAST_ENUM> delay{};
+
+    double operator[](LogicGate::OpType T) const { return delay[T]; }
+    static DelayModel Default(); // buffers are free; inverting gates are cheaper than their non-inverting forms
+};
+
+
+// static timing over the canvas' components: arrival-times are longest paths from 'globalInputs',
+// required-times count back from the latest 'globalOutput' (the critical delay), and slack is their difference.
+// 'Update' only revisits the fanout-cones (arrival) and fanin-cones (required) of components whose connections
+// changed, in depth-order, and stops wherever a value comes out unchanged.
+// Connections closing a combinational loop are ignored for timing (and counted in the report).
+class TimingGraph
+{
+    public:
+    static constexpr double UNTIMED {-std::numeric_limits<double>::infinity()}; // no path from an input/to an output
+
+    void Build(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput);
+    bool IsBuilt() const { return isBuilt; }
+    void Clear();
+
+    // 'changed' are components whose incoming connections may have changed (their fanin is re-read from 'incoming');
+    // 'removed' are about to be deleted. Components never seen before are picked up automatically
+    void Update(const std::vector<Component*>& changed, const std::vector<Component*>& removed);
+
+    double CriticalDelay() const { return criticalDelay; }
+    int Depth() const { return depth; } // logic-levels on the deepest input-to-output path
+    double Arrival(const Component* component) const;
+    double Slack(const Component* component) const; // +inf for components not on any input-to-output path
+    std::vector<Component*> CriticalPath() const;   // from a global input to the latest global output
+    std::size_t LastUpdateVisits() const { return lastUpdateVisits; }
+    double LastUpdateMicroseconds() const { return lastUpdateMicroseconds; }
+    std::string Report() const;
+
+    explicit TimingGraph(DelayModel model=DelayModel::Default()): model{model} {;}
+
+    private:
+    struct Node
+    {
+        Component* component;
+        double delay{0};
+        double arrival{UNTIMED}; // at this component's output
+        double tail{UNTIMED};    // longest delay from this output to any global output
+        int depth{0};  // logic-levels on the longest timed path to here
+        int level{0};  // topological rank (over every fanin, timed or not); always below the fanout's
+        std::vector<Node*> fanin{}, fanout{};
+        bool isQueued{false};
+        unsigned visit{0}; // for 'Reaches'; compared against 'visitStamp'
+    };
+
+    const DelayModel model;
+    std::unordered_map<const Component*, Node> nodes{};
+    std::vector<Node*> outputNodes{};
+    double criticalDelay{0};
+    int depth{0};
+    std::vector<std::pair<Node*, Node*>> loopConnections{}; // (source, target) ignored because they'd close a loop; retried by every 'Update'
+    std::size_t lastUpdateVisits{0};
+    double lastUpdateMicroseconds{0};
+    bool isBuilt{false};
+    unsigned visitStamp{0};
+
+    Node& Ensure(Component* component, std::vector<Component*>* discovered=nullptr);
+    bool Reaches(Node* from, const Node* target); // through fanout; only nodes ranked below 'target' are searched
+    void Raise(Node& node, int level);            // restores the rank-order after a new connection
+    bool Forward(Node& node);  // recomputes arrival/depth from fanin; returns true if either changed
+    bool Backward(Node& node); // recomputes tail from fanout; returns true if it changed
+    void Propagate(std::vector<Node*>& forward, std::vector<Node*>& backward);
+    void UpdateCritical();
+};
+
+
+#endif
@@ -0,0 +1,229 @@
+#include "TopoOrder.hpp"
+#include "Interactives.hpp"
+#include "ComponentMap.hpp"
+
+#include <algorithm>
+
+
+DynamicTopoOrder::NodeID DynamicTopoOrder::AddNode()
+{
+    NodeID N;
+    if (!freeIDs.empty()) { N = freeIDs.back(); freeIDs.pop_back(); }
+    else {
+        N = NodeID(fanout.size());
+        fanout.emplace_back(); fanin.emplace_back();
+        position.push_back(0); visit.push_back(0); parent.push_back(-1);
+    }
+    position[N] = int(nodeAt.size());
+    nodeAt.push_back(N);
+    return N;
+}
+
+
+void DynamicTopoOrder::RemoveNode(NodeID N)
+{
+    for (NodeID target: fanout[N]) { auto& list {fanin[target]}; list.erase(std::find(list.begin(), list.end(), N)); }
+    for (NodeID source: fanin[N])  { auto& list {fanout[source]}; list.erase(std::find(list.begin(), list.end(), N)); }
+    fanout[N].clear(); fanin[N].clear();
+    nodeAt[position[N]] = -1; ++holes;
+    freeIDs.push_back(N);
+    if (holes > 64 && holes*2 > nodeAt.size()) Compact();
+}
+
+
+void DynamicTopoOrder::Compact()
+{
+    std::vector<NodeID> dense{}; dense.reserve(nodeAt.size() - holes);
+    for (NodeID N: nodeAt) { if (N >= 0) { position[N] = int(dense.size()); dense.push_back(N); } }
+    nodeAt.swap(dense);
+    holes = 0;
+}
+
+
+void DynamicTopoOrder::RemoveEdge(NodeID source, NodeID target)
+{
+    auto& out {fanout[source]};
+    auto found = std::find(out.begin(), out.end(), target);
+    if (found == out.end()) return;
+    out.erase(found);
+    auto& in {fanin[target]};
+    in.erase(std::find(in.begin(), in.end(), source));
+}
+
+
+bool DynamicTopoOrder::AddEdge(NodeID source, NodeID target, std::vector<NodeID>* cycle)
+{
+    lastReordered = 0;
+    if (source == target) {
+        if (cycle) *cycle = {source};
+        return false;
+    }
+    if (position[source] < position[target]) {
+        fanout[source].push_back(target); fanin[target].push_back(source);
+        return true;
+    }
+
+    // the affected region: positions between 'target' (lower bound) and 'source' (upper bound)
+    const int lower {position[target]}, upper {position[source]};
+    ++visitStamp;
+
+    // forward from 'target'; reaching 'source' means the edge closes a cycle
+    std::vector<NodeID> forward{target}, stack{target};
+    visit[target] = visitStamp; parent[target] = -1;
+    while (!stack.empty()) {
+        const NodeID N {stack.back()}; stack.pop_back();
+        for (NodeID next: fanout[N]) {
+            if (next == source) {
+                if (cycle) {
+                    cycle->clear();
+                    for (NodeID P{N}; P >= 0; P = parent[P]) { cycle->push_back(P); }
+                    std::reverse(cycle->begin(), cycle->end());
+                    cycle->push_back(source);
+                }
+                return false;
+            }
+            if (visit[next] == visitStamp || position[next] > upper) continue;
+            visit[next] = visitStamp; parent[next] = N;
+            forward.push_back(next); stack.push_back(next);
+        }
+    }
+
+    // backward from 'source'
+    std::vector<NodeID> backward{source};
+    stack.push_back(source); visit[source] = visitStamp;
+    while (!stack.empty()) {
+        const NodeID N {stack.back()}; stack.pop_back();
+        for (NodeID previous: fanin[N]) {
+            if (visit[previous] == visitStamp || position[previous] < lower) continue;
+            visit[previous] = visitStamp;
+            backward.push_back(previous); stack.push_back(previous);
+        }
+    }
+
+    // everything reaching 'source' moves ahead of everything reachable from 'target', within the same positions
+    auto byPosition = [this](NodeID A, NodeID B) { return position[A] < position[B]; };
+    std::sort(forward.begin(), forward.end(), byPosition);
+    std::sort(backward.begin(), backward.end(), byPosition);
+    std::vector<int> slots{}; slots.reserve(forward.size() + backward.size());
+    for (NodeID N: backward) { slots.push_back(position[N]); }
+    for (NodeID N: forward)  { slots.push_back(position[N]); }
+    std::sort(slots.begin(), slots.end());
+
+    std::size_t S{0};
+    for (NodeID N: backward) { position[N] = slots[S]; nodeAt[slots[S++]] = N; }
+    for (NodeID N: forward)  { position[N] = slots[S]; nodeAt[slots[S++]] = N; }
+    lastReordered = slots.size();
+
+    fanout[source].push_back(target); fanin[target].push_back(source);
+    return true;
+}
+
+
+
+ComponentOrder::NodeID ComponentOrder::Ensure(Component* component)
+{
+    auto [iter, isNew] = ids.try_emplace(component, 0);
+    if (isNew) {
+        iter->second = order.AddNode();
+        if (std::size_t(iter->second) >= componentOf.size()) componentOf.resize(iter->second + 1, nullptr);
+        componentOf[iter->second] = component;
+    }
+    return iter->second;
+}
+
+
+void ComponentOrder::Build(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput)
+{
+    *this = ComponentOrder{};
+
+    // nodes are added in Kahn's order, so that (almost) every edge is already in order when it's added
+    std::vector<Component*> all{};
+    for (Component& component: globalInputs) { all.push_back(&component); }
+    components.ForEach([&all](Component& component) { all.push_back(&component); });
+    for (Component& component: globalOutput) { all.push_back(&component); }
+
+    std::unordered_map<const Component*, int> pending{};
+    std::unordered_map<const Component*, std::vector<Component*>> fanout{};
+    for (Component* component: all) { pending.try_emplace(component, 0); }
+    for (Component* component: all) {
+        for (auto [pinUUID, source]: component->incoming) {
+            if (!pending.contains(source)) continue;
+            ++pending[component]; fanout[source].push_back(component);
+        }
+    }
+    std::vector<Component*> sorted{}; sorted.reserve(all.size());
+    for (Component* component: all) { if (pending[component] == 0) sorted.push_back(component); }
+    for (std::size_t I{0}; I < sorted.size(); ++I) {
+        for (Component* target: fanout[sorted[I]]) { if (--pending[target] == 0) sorted.push_back(target); }
+    }
+    for (Component* component: all) { if (pending[component] > 0) sorted.push_back(component); } // on (or behind) a loop
+
+    for (Component* component: sorted) { Ensure(component); }
+    for (Component* component: sorted) {
+        for (auto [pinUUID, source]: component->incoming) { if (pending.contains(source)) Connect(source, component); }
+    }
+}
+
+
+bool ComponentOrder::Connect(Component* source, Component* target, std::vector<Component*>* cycle)
+{
+    const NodeID S {Ensure(source)}, T {Ensure(target)};
+    std::vector<NodeID> path{};
+    if (order.AddEdge(S, T, cycle? &path : nullptr)) return true;
+    looped.emplace(S, T);
+    if (cycle) {
+        cycle->clear();
+        for (NodeID N: path) { cycle->push_back(componentOf[N]); }
+    }
+    return false;
+}
+
+
+void ComponentOrder::Disconnect(Component* source, Component* target)
+{
+    auto foundSource = ids.find(source), foundTarget = ids.find(target);
+    if (foundSource == ids.end() || foundTarget == ids.end()) return;
+    const std::pair<NodeID, NodeID> edge {foundSource->second, foundTarget->second};
+    if (auto found = looped.find(edge); found != looped.end()) { looped.erase(found); return; }
+    order.RemoveEdge(edge.first, edge.second);
+    RetryLooped();
+}
+
+
+void ComponentOrder::Remove(Component* component)
+{
+    auto found = ids.find(component);
+    if (found == ids.end()) return;
+    const NodeID N {found->second};
+    std::erase_if(looped, [N](const auto& edge) { return (edge.first == N || edge.second == N); });
+    order.RemoveNode(N);
+    componentOf[N] = nullptr;
+    ids.erase(found);
+    RetryLooped();
+}
+
+
+// a removed connection may have opened a loop
+void ComponentOrder::RetryLooped()
+{
+    for (auto iter = looped.begin(); iter != looped.end();) {
+        if (order.AddEdge(iter->first, iter->second)) iter = looped.erase(iter);
+        else ++iter;
+    }
+}
+
+
+int ComponentOrder::Position(const Component* component) const
+{
+    auto found = ids.find(component);
+    return ((found == ids.end())? -1 : order.Position(found->second));
+}
+
+
+void ComponentOrder::Sort(std::vector<Component*>& components) const
+{
+    std::vector<std::pair<int, Component*>> keyed{}; keyed.reserve(components.size());
+    for (Component* component: components) { keyed.emplace_back(Position(component), component); }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const auto& A, const auto& B) { return A.first < B.first; });
+    for (std::size_t I{0}; I < keyed.size(); ++I) { components[I] = keyed[I].second; }
+}
@@ -0,0 +1,83 @@
+#ifndef CIRCUITSIM_TOPOORDER_HPP
+#define CIRCUITSIM_TOPOORDER_HPP
+
+#include <set>
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+
+class Component;
+class ComponentMap;
+
+
+// online topological order (Pearce & Kelly): every edge goes from a lower to a higher position.
+// An edge that's already in order is O(1); otherwise only the nodes positioned between its endpoints that
+// are reachable from its target (or reach its source) get shuffled among their own positions.
+// Edges that would close a cycle are refused; removing edges never invalidates the order
+class DynamicTopoOrder
+{
+    public:
+    using NodeID = int;
+
+    NodeID AddNode(); // positioned after every existing node
+    void RemoveNode(NodeID N); // along with all of its edges; the ID may be reused
+
+    // returns false (adding nothing) if the edge would close a cycle; 'cycle' then receives
+    // the existing path from 'target' to 'source'. Parallel edges are allowed
+    bool AddEdge(NodeID source, NodeID target, std::vector<NodeID>* cycle=nullptr);
+    void RemoveEdge(NodeID source, NodeID target); // one instance of it
+
+    int Position(NodeID N) const { return position[N]; }
+    std::size_t NodeCount() const { return fanout.size() - freeIDs.size(); }
+    std::size_t LastReordered() const { return lastReordered; } // nodes moved by the latest 'AddEdge'
+
+    private:
+    std::vector<std::vector<NodeID>> fanout{}, fanin{};
+    std::vector<int> position{};
+    std::vector<NodeID> nodeAt{}; // inverse of 'position'; -1 where a removed node used to be
+    std::vector<NodeID> freeIDs{};
+    std::size_t holes{0};
+    std::size_t lastReordered{0};
+
+    // scratch-space for the searches
+    std::vector<unsigned> visit{};
+    std::vector<NodeID> parent{};
+    unsigned visitStamp{0};
+
+    void Compact(); // renumbers positions densely, keeping their order
+};
+
+
+// 'DynamicTopoOrder' over the canvas' components, one edge per connected pin.
+// Connections closing a loop are kept aside (and retried whenever a connection goes away), so the
+// order always covers everything else; components are added lazily, as they get connected
+class ComponentOrder
+{
+    public:
+    using NodeID = DynamicTopoOrder::NodeID;
+
+    void Build(std::vector<Component>& globalInputs, ComponentMap& components, std::vector<Component>& globalOutput);
+
+    // false if this connection closes a loop; 'cycle' then receives the loop, starting at 'target'
+    bool Connect(Component* source, Component* target, std::vector<Component*>* cycle=nullptr);
+    void Disconnect(Component* source, Component* target);
+    void Remove(Component* component); // and all of its connections
+
+    bool Contains(const Component* component) const { return ids.contains(component); }
+    int Position(const Component* component) const; // -1 for components without any connection yet
+    void Sort(std::vector<Component*>& components) const; // by position
+    std::size_t LoopConnections() const { return looped.size(); }
+    std::size_t LastReordered() const { return order.LastReordered(); }
+
+    private:
+    DynamicTopoOrder order{};
+    std::unordered_map<const Component*, NodeID> ids{};
+    std::vector<Component*> componentOf{}; // by ID
+    std::multiset<std::pair<NodeID, NodeID>> looped{}; // connections kept out of the order
+
+    NodeID Ensure(Component* component);
+    void RetryLooped();
+};
+
+
+#endif
@@ -0,0 +1,418 @@
+#include "VectorStream.hpp"
+#include "Lut.hpp"
+#include "ResultCache.hpp"
+#include "Distributed.hpp"
+#include "FourValued.hpp"
+#include "Subcircuit.hpp"
+#include "Coverage.hpp"
+#include "Logger.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <thread>
+#include <chrono>
+#include <string_view>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+
+namespace {
+
+using Word = Netlist::Word;
+
+struct VectorBatch
+{
+    std::size_t count{0};
+    std::vector<Word> lanes; // bit-sliced, pin-major: bit 'V%64' of lanes[pin*stride + V/64] is vector 'V'
+    std::vector<Word> packed{}; // when memoizing: one vector after another instead (inputs still come as 'lanes' too)
+};
+
+
+// packed vectors hold 'wordsPerVector' words each, bit 'I' of a vector is pin 'I'
+void PackedToLanes(const std::vector<Word>& packed, std::size_t wordsPerVector, std::size_t width,
+                   std::size_t count, std::vector<Word>& lanes, std::size_t stride)
+{
+    Word rows[64];
+    for (std::size_t W{0}; W*64 < count; ++W) {
+        const std::size_t laneCount {std::min<std::size_t>(64, count - W*64)};
+        for (std::size_t chunk{0}; chunk < wordsPerVector; ++chunk) {
+            for (std::size_t L{0}; L < 64; ++L) { rows[L] = ((L < laneCount)? packed[(W*64 + L)*wordsPerVector + chunk] : 0); }
+            Netlist::Transpose64(rows);
+            for (std::size_t B{0}; (B < 64) && (chunk*64 + B < width); ++B) { lanes[(chunk*64 + B)*stride + W] = rows[B]; }
+        }
+    }
+}
+
+
+void LanesToPacked(const std::vector<Word>& lanes, std::size_t stride, std::size_t width,
+                   std::size_t count, std::vector<Word>& packed, std::size_t wordsPerVector)
+{
+    Word rows[64];
+    for (std::size_t W{0}; W*64 < count; ++W) {
+        const std::size_t laneCount {std::min<std::size_t>(64, count - W*64)};
+        for (std::size_t chunk{0}; chunk < wordsPerVector; ++chunk) {
+            for (std::size_t B{0}; B < 64; ++B) { rows[B] = ((chunk*64 + B < width)? lanes[(chunk*64 + B)*stride + W] : 0); }
+            Netlist::Transpose64(rows);
+            for (std::size_t L{0}; L < laneCount; ++L) { packed[(W*64 + L)*wordsPerVector + chunk] = rows[L]; }
+        }
+    }
+}
+
+
+// returns 1 if a vector was parsed, 0 for blank/comment lines, -1 on invalid characters.
+// digits beyond the vector's width are ignored
+int ParseHexLine(std::string_view line, Word* out, std::size_t wordsPerVector)
+{
+    if (const auto comment = line.find('#'); comment != std::string_view::npos) { line = line.substr(0, comment); }
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))  { line.remove_suffix(1); }
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front()))) { line.remove_prefix(1); }
+    if (line.starts_with("0x") || line.starts_with("0X")) { line.remove_prefix(2); }
+    if (line.empty()) return 0;
+
+    std::fill(out, out + wordsPerVector, 0);
+    std::size_t nibble{0};
+    for (auto iter = line.rbegin(); iter != line.rend(); ++iter)
+    {
+        const char C {*iter};
+        Word digit;
+        if      (C >= '0' && C <= '9') digit = Word(C - '0');
+        else if (C >= 'a' && C <= 'f') digit = Word(C - 'a' + 10);
+        else if (C >= 'A' && C <= 'F') digit = Word(C - 'A' + 10);
+        else if (C == '_') continue;
+        else return -1;
+
+        if (nibble/16 < wordsPerVector) { out[nibble/16] |= (digit << ((nibble%16)*4)); }
+        ++nibble;
+    }
+    return 1;
+}
+
+
+// fixed-width hex, most-significant digit first
+void FormatHex(const Word* vector, std::size_t width, std::string& out)
+{
+    constexpr char digits[] {"0123456789abcdef"};
+    const std::size_t nibbles {std::max<std::size_t>((width+3)/4, 1)};
+    for (std::size_t N{nibbles}; N-- > 0;) { out.push_back(digits[(vector[N/16] >> ((N%16)*4)) & 0xF]); }
+    out.push_back('\n');
+}
+
+// four-valued: one character per pin, highest pin first; value-bits go to bits [0, width), unknown-bits to [width, 2*width).
+// returns 1 if a vector was parsed, 0 for blank/comment lines, -1 on invalid characters or a wrong pin-count
+int ParseLogicLine(std::string_view line, Word* out, std::size_t width, std::size_t wordsPerVector)
+{
+    if (const auto comment = line.find('#'); comment != std::string_view::npos) { line = line.substr(0, comment); }
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))  { line.remove_suffix(1); }
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front()))) { line.remove_prefix(1); }
+    if (line.empty()) return 0;
+
+    std::fill(out, out + wordsPerVector, 0);
+    std::size_t pin{0};
+    for (auto iter = line.rbegin(); iter != line.rend(); ++iter)
+    {
+        if (*iter == '_') continue;
+        Logic4 L;
+        if (!FromChar(*iter, L) || pin >= width) return -1;
+        out[pin/64] |= (Word(std::uint8_t(L) & 0b01) << (pin%64));
+        out[(width+pin)/64] |= (Word(std::uint8_t(L) >> 1) << ((width+pin)%64));
+        ++pin;
+    }
+    return ((pin == width)? 1 : -1);
+}
+
+
+void FormatLogic(const Word* vector, std::size_t width, std::string& out)
+{
+    for (std::size_t pin{width}; pin-- > 0;) {
+        const unsigned value   {unsigned(vector[pin/64] >> (pin%64)) & 1};
+        const unsigned unknown {unsigned(vector[(width+pin)/64] >> ((width+pin)%64)) & 1};
+        out.push_back(ToChar(Logic4((unknown << 1) | value)));
+    }
+    out.push_back('\n');
+}
+
+using BatchQueue = BoundedQueue<VectorBatch>;
+
+
+// the simulation stage, shared by 'Netlist' and 'LutNetlist'; both have the same inputs/outputs/state layout.
+// runs on the calling thread and must drain 'stimulus' even if it fails
+template<class Circuit>
+bool SimulateLocal(const Circuit& netlist, const StreamOptions& options, BatchQueue& stimulus, BatchQueue& response, std::size_t stride,
+                   ToggleCoverage* coverage=nullptr)
+{
+    const std::size_t inWidth  {netlist.inputs.size()};
+    const std::size_t outWidth {netlist.outputs.size()};
+    const std::size_t inWords  {std::max<std::size_t>((inWidth+63)/64, 1)};
+    const std::size_t outWords {std::max<std::size_t>((outWidth+63)/64, 1)};
+    const std::size_t batchSize{stride*64};
+
+    std::vector<Word> state {netlist.MakeState(stride)};
+    std::optional<ResultCache> cache{};
+    std::vector<Word> missPacked{}, missResults(batchSize*outWords);
+    std::vector<std::size_t> missIndex{};
+    if (options.memoBytes) { cache.emplace(options.memoBytes); missPacked.reserve(batchSize*inWords); }
+
+    while (std::optional<VectorBatch> batch = stimulus.Pop())
+    {
+        if (cache) {
+            // only vectors that missed are simulated (still bit-parallel); the batch is answered in packed form
+            VectorBatch result{batch->count, {}, std::vector<Word>(batch->count*outWords, 0)};
+            missPacked.clear(); missIndex.clear();
+            for (std::size_t V{0}; V < batch->count; ++V) {
+                const Word* vector {&batch->packed[V*inWords]};
+                if (const Word* hit = cache->Find(vector, inWords)) { std::copy_n(hit, outWords, &result.packed[V*outWords]); continue; }
+                missIndex.push_back(V);
+                missPacked.insert(missPacked.end(), vector, vector + inWords);
+            }
+            if (!missIndex.empty()) {
+                const std::size_t misses {missIndex.size()};
+                const std::size_t words {(misses+63)/64};
+                batch->lanes.assign(inWidth*stride, 0);
+                PackedToLanes(missPacked, inWords, inWidth, misses, batch->lanes, stride);
+                for (std::size_t pin{0}; pin < inWidth; ++pin) {
+                    std::copy_n(&batch->lanes[pin*stride], words, &state[netlist.inputs[pin]*stride]);
+                }
+                netlist.Evaluate(state.data(), stride, words);
+
+                std::vector<Word> lanes(outWidth*stride, 0);
+                for (std::size_t pin{0}; pin < outWidth; ++pin) {
+                    std::copy_n(&state[netlist.outputs[pin]*stride], words, &lanes[pin*stride]);
+                }
+                LanesToPacked(lanes, stride, outWidth, misses, missResults, outWords);
+                for (std::size_t M{0}; M < misses; ++M) {
+                    std::copy_n(&missResults[M*outWords], outWords, &result.packed[missIndex[M]*outWords]);
+                    cache->Insert(&missPacked[M*inWords], inWords, &missResults[M*outWords], outWords);
+                }
+            }
+            response.Push(std::move(result));
+            continue;
+        }
+        const std::size_t words {(batch->count+63)/64};
+        for (std::size_t pin{0}; pin < inWidth; ++pin) {
+            std::copy_n(&batch->lanes[pin*stride], words, &state[netlist.inputs[pin]*stride]);
+        }
+        netlist.Evaluate(state.data(), stride, words);
+        if (coverage) coverage->Accumulate(state.data(), stride, batch->count);
+
+        VectorBatch result{batch->count, std::vector<Word>(outWidth*stride, 0)};
+        for (std::size_t pin{0}; pin < outWidth; ++pin) {
+            std::copy_n(&state[netlist.outputs[pin]*stride], words, &result.lanes[pin*stride]);
+        }
+        response.Push(std::move(result));
+    }
+    if (cache) std::cerr << cache->GetStats().Report(std::format("vector-stream memo ({} entries, {} KiB)", cache->Size(), cache->Bytes()/1024));
+    return true;
+}
+
+
+// pipelined: batches are submitted as they arrive while a second thread collects results in the same order
+bool SimulateDistributed(Cluster& cluster, const StreamOptions& options, BatchQueue& stimulus, BatchQueue& response, std::size_t stride)
+{
+    BoundedQueue<std::size_t> inFlight{options.queueDepth}; // vector-counts of submitted batches
+    bool isGood{true};
+    std::thread collector{[&]
+    {
+        bool isCollecting{true};
+        while (std::optional<std::size_t> count = inFlight.Pop()) {
+            if (!isCollecting) continue; // draining, so 'Submit' never waits on us
+            VectorBatch result{*count, std::vector<Word>(cluster.OutputCount()*stride, 0)};
+            isCollecting = cluster.Collect(result.lanes.data(), stride, (*count+63)/64);
+            if (isCollecting) response.Push(std::move(result));
+        }
+        if (!isCollecting) isGood = false;
+    }};
+
+    bool isSubmitting{true};
+    while (std::optional<VectorBatch> batch = stimulus.Pop()) {
+        if (!isSubmitting) continue;
+        isSubmitting = cluster.Submit(batch->lanes.data(), stride, (batch->count+63)/64);
+        if (isSubmitting) inFlight.Push(batch->count);
+    }
+    inFlight.Close();
+    collector.join();
+    return (isGood && isSubmitting);
+}
+
+
+// reader-thread -> 'simulate' (on the calling thread) -> writer-thread
+template<class Simulate>
+int RunStream(std::size_t inWidth, std::size_t outWidth, const StreamOptions& options, Simulate&& simulate)
+{
+    const std::size_t inWords  {std::max<std::size_t>((inWidth+63)/64, 1)};
+    const std::size_t outWords {std::max<std::size_t>((outWidth+63)/64, 1)};
+    const std::size_t batchSize{((std::max<std::size_t>(options.batchSize, 1)+63)/64)*64};
+    const std::size_t stride   {batchSize/64};
+
+    // zero-byte records would never reach the end of the input
+    if (options.isBinary && (inWidth == 0)) { std::cerr << "Binary vectors need at least one global input\n"; return 1; }
+
+    std::ifstream inputFile{}; std::ofstream outputFile{};
+    const auto mode {options.isBinary? std::ios::binary : std::ios::openmode{}};
+    if (options.inputPath != "-") {
+        inputFile.open(options.inputPath, std::ios::in | mode);
+        if (!inputFile) { std::cerr << "Failed to open vector file: '" << options.inputPath << "'\n"; return 1; }
+    }
+    if (options.outputPath != "-") {
+        outputFile.open(options.outputPath, std::ios::out | std::ios::trunc | mode);
+        if (!outputFile) { std::cerr << "Failed to open output file: '" << options.outputPath << "'\n"; return 2; }
+    }
+    std::istream& input {inputFile.is_open()? static_cast<std::istream&>(inputFile) : std::cin};
+    // stdout is written through 'fwrite', so 'std::cout' can be redirected for diagnostics in batch-mode
+    bool isOutputGood{true};
+    auto write = [&](const std::string& text) {
+        if (outputFile.is_open()) { outputFile.write(text.data(), text.size()); isOutputGood = outputFile.good(); }
+        else { isOutputGood = (std::fwrite(text.data(), 1, text.size(), stdout) == text.size()); }
+    };
+
+    BatchQueue stimulus{options.queueDepth};
+    BatchQueue response{options.queueDepth};
+    std::size_t badLines{0};
+
+    std::thread reader{[&]
+    {
+        std::vector<Word> packed(batchSize*inWords);
+        const std::size_t recordBytes {(inWidth+7)/8};
+        std::vector<char> record(recordBytes);
+        std::string line{};
+        std::size_t lineNumber{0};
+
+        bool isDone{false};
+        while (!isDone)
+        {
+            std::size_t count{0};
+            while (count < batchSize)
+            {
+                Word* vector {&packed[count*inWords]};
+                if (options.isBinary) {
+                    if (!input.read(record.data(), recordBytes)) { isDone = true; break; }
+                    std::fill(vector, vector + inWords, 0);
+                    for (std::size_t B{0}; B < recordBytes; ++B) {
+                        vector[B/8] |= (Word(static_cast<unsigned char>(record[B])) << ((B%8)*8));
+                    }
+                    ++count;
+                } else {
+                    if (!std::getline(input, line)) { isDone = true; break; }
+                    ++lineNumber;
+                    const int result {options.isFourValued? ParseLogicLine(line, vector, inWidth/2, inWords) : ParseHexLine(line, vector, inWords)};
+                    if (result < 0) {
+                        std::cerr << std::format("vector-stream: skipping invalid line {}: '{}'\n", lineNumber, line);
+                        ++badLines; continue;
+                    }
+                    count += result;
+                }
+            }
+
+            if (count == 0) break;
+            VectorBatch batch{count, std::vector<Word>(inWidth*stride, 0)};
+            if (options.memoBytes) { batch.packed.assign(packed.begin(), packed.begin() + count*inWords); }
+            else { PackedToLanes(packed, inWords, inWidth, count, batch.lanes, stride); }
+            stimulus.Push(std::move(batch));
+        }
+        stimulus.Close();
+    }};
+
+    std::size_t totalVectors{0};
+    std::thread writer{[&]
+    {
+        std::vector<Word> packed(batchSize*outWords);
+        const std::size_t recordBytes {(outWidth+7)/8};
+        std::string text{};
+
+        while (std::optional<VectorBatch> batch = response.Pop())
+        {
+            if (batch->packed.empty()) { LanesToPacked(batch->lanes, stride, outWidth, batch->count, packed, outWords); }
+            else { packed.swap(batch->packed); }
+            text.clear();
+            for (std::size_t V{0}; V < batch->count; ++V) {
+                const Word* vector {&packed[V*outWords]};
+                if (options.isBinary) {
+                    for (std::size_t B{0}; B < recordBytes; ++B) { text.push_back(char((vector[B/8] >> ((B%8)*8)) & 0xFF)); }
+                } else if (options.isFourValued) { FormatLogic(vector, outWidth/2, text); }
+                else { FormatHex(vector, outWidth, text); }
+            }
+            write(text);
+            totalVectors += batch->count;
+        }
+        if (outputFile.is_open()) { outputFile.flush(); } else { std::fflush(stdout); }
+    }};
+
+    const auto startTime {std::chrono::steady_clock::now()};
+    const bool isSimulationGood {simulate(stimulus, response, stride)};
+    response.Close();
+
+    reader.join();
+    writer.join();
+    const std::chrono::duration<double> elapsed {std::chrono::steady_clock::now() - startTime};
+    std::cerr << std::format("vector-stream: {} vectors ({} in, {} out) in {:.3f}s; {:.0f} vectors/s{}\n",
+        totalVectors, inWidth, outWidth, elapsed.count(), totalVectors/std::max(elapsed.count(), 1e-9),
+        (badLines? std::format("; {} invalid lines skipped", badLines) : ""));
+
+    return (!isSimulationGood? 4 : isOutputGood? 0 : 3);
+}
+
+
+template<class Circuit>
+int RunLocal(const Circuit& netlist, const StreamOptions& options, ToggleCoverage* coverage=nullptr)
+{
+    return RunStream(netlist.inputs.size(), netlist.outputs.size(), options, [&](BatchQueue& stimulus, BatchQueue& response, std::size_t stride) {
+        return SimulateLocal(netlist, options, stimulus, response, stride, coverage);
+    });
+}
+
+
+// LUT-mapping doesn't keep 'cellOutputs', so the report names all of a cell's nets after the cell
+const Netlist::CellOutputs& CellOutputsOf(const Netlist& netlist) { return netlist.cellOutputs; }
+const Netlist::CellOutputs& CellOutputsOf(const LutNetlist&) { static const Netlist::CellOutputs none{}; return none; }
+
+// 'RunLocal' with toggle-coverage, when it's asked for; coverage needs every vector simulated, in order
+template<class Circuit>
+int RunCovered(const Circuit& netlist, const StreamOptions& options)
+{
+    if (options.coveragePath.empty()) return RunLocal(netlist, options);
+
+    StreamOptions covered {options};
+    if (covered.memoBytes) { Log::Warning("vector-stream: '--memo' skips repeated vectors, so it's ignored for '--coverage'"); covered.memoBytes = 0; }
+    ToggleCoverage coverage{};
+    coverage.Reset(std::size_t(netlist.NetCount()));
+    const int status {RunLocal(netlist, covered, &coverage)};
+
+    const std::string report {coverage.Report(netlist.origin, CellOutputsOf(netlist))};
+    if (covered.coveragePath == "-") { std::cerr << report; return status; }
+    std::ofstream file{covered.coveragePath, std::ios::out | std::ios::trunc};
+    if (!file || !(file << report)) { std::cerr << "Failed to write coverage report: '" << covered.coveragePath << "'\n"; return (status? status : 3); }
+    return status;
+}
+
+} // namespace
+
+
+int RunVectorStream(const Netlist& netlist, const StreamOptions& options) { return RunCovered(netlist, options); }
+
+// a four-valued circuit streams like a two-valued one with twice the pins (its planes); only the text-format differs
+int RunVectorStream(const FourValuedNetlist& netlist, const StreamOptions& options)
+{
+    StreamOptions fourValued {options};
+    fourValued.isFourValued = true;
+    if (!fourValued.coveragePath.empty()) { Log::Warning("vector-stream: '--coverage' isn't supported for four-valued vectors; ignoring it"); fourValued.coveragePath.clear(); }
+    return RunLocal(netlist, fourValued);
+}
+int RunVectorStream(const LutNetlist& netlist, const StreamOptions& options) { return RunCovered(netlist, options); }
+
+int RunVectorStream(const SubcircuitBank& bank, const StreamOptions& options)
+{
+    StreamOptions instanced {options};
+    if (!instanced.coveragePath.empty()) { Log::Warning("vector-stream: '--coverage' isn't supported with instances; ignoring it"); instanced.coveragePath.clear(); }
+    return RunLocal(bank, instanced);
+}
+
+int RunVectorStream(Cluster& cluster, const StreamOptions& options)
+{
+    StreamOptions pipelined {options};
+    if (pipelined.memoBytes) { Log::Warning("vector-stream: '--memo' isn't supported with workers; ignoring it"); pipelined.memoBytes = 0; }
+    if (!pipelined.coveragePath.empty()) { Log::Warning("vector-stream: '--coverage' isn't supported with workers; ignoring it"); pipelined.coveragePath.clear(); }
+    return RunStream(cluster.InputCount(), cluster.OutputCount(), pipelined, [&](BatchQueue& stimulus, BatchQueue& response, std::size_t stride) {
+        return SimulateDistributed(cluster, pipelined, stimulus, response, stride);
+    });
+}
@@ -0,0 +1,83 @@
+#ifndef CIRCUITSIM_VECTORSTREAM_HPP
+#define CIRCUITSIM_VECTORSTREAM_HPP
+
+#include <string>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <condition_variable>
+
+#include "Netlist.hpp"
+
+class LutNetlist;
+class Cluster;
+class FourValuedNetlist;
+class SubcircuitBank;
+
+
+// blocking FIFO with a fixed capacity; 'Push' waits while full, 'Pop' waits while empty.
+// after 'Close', 'Pop' drains the remaining items and then returns nullopt
+template <typename T>
+class BoundedQueue
+{
+    std::deque<T> items;
+    const std::size_t capacity;
+    bool isClosed{false};
+    std::mutex mutex;
+    std::condition_variable notFull, notEmpty;
+
+    public:
+    void Push(T item) {
+        std::unique_lock lock{mutex};
+        notFull.wait(lock, [this]{ return (items.size() < capacity) || isClosed; });
+        if (isClosed) return;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    std::optional<T> Pop() {
+        std::unique_lock lock{mutex};
+        notEmpty.wait(lock, [this]{ return !items.empty() || isClosed; });
+        if (items.empty()) return std::nullopt;
+        T item{std::move(items.front())}; items.pop_front();
+        notFull.notify_one();
+        return item;
+    }
+
+    void Close() {
+        std::lock_guard lock{mutex};
+        isClosed = true;
+        notFull.notify_all(); notEmpty.notify_all();
+    }
+
+    explicit BoundedQueue(std::size_t C): capacity{C} {;}
+};
+
+
+// batch-mode: streams input-vectors through a netlist without opening any windows.
+// Vector encoding matches 'ReadIO': bit 'I' of a vector is global input/output 'I'.
+//  hex-lines: one vector per line, most-significant digit first ('0x', '_' and '#'-comments are allowed)
+//  binary:    fixed-size little-endian records of ceil(width/8) bytes
+// four-valued circuits read and write one character per pin instead (0, 1, X or Z; highest pin first),
+// or binary records holding every pin's value-bit followed by every pin's unknown-bit (see 'FourValuedNetlist')
+struct StreamOptions
+{
+    std::string inputPath {"-"}; // "-" is stdin/stdout
+    std::string outputPath{"-"};
+    bool isBinary{false};
+    std::size_t batchSize{4096};  // vectors per batch; rounded up to a multiple of 64
+    std::size_t queueDepth{8};    // batches buffered between each pair of stages
+    std::size_t memoBytes{0};     // >0 caches each distinct input-vector's outputs (LRU, within this many bytes)
+    bool isFourValued{false};     // set by the 'FourValuedNetlist' overload
+    std::string coveragePath{};   // non-empty: a toggle-coverage report is written there after the run ("-" is stderr)
+};
+
+// reader-thread -> simulation (calling thread) -> writer-thread; returns non-zero on failure
+int RunVectorStream(const Netlist& netlist, const StreamOptions& options);
+int RunVectorStream(const LutNetlist& netlist, const StreamOptions& options);
+int RunVectorStream(Cluster& cluster, const StreamOptions& options); // pipelined through its workers (see 'Cluster')
+int RunVectorStream(const FourValuedNetlist& netlist, const StreamOptions& options);
+int RunVectorStream(const SubcircuitBank& bank, const StreamOptions& options); // every instance's pins in turn
+
+
+#endif
@@ -0,0 +1,67 @@
+// build-time tool: downscales the sprite-sheet and writes it as a run-length encoded C++ array,
+// so the program never decodes the full-size PNG (or needs it in the working directory) at startup.
+// usage: EmbedAtlas <input.png> <output.inc> <divisor>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <string>
+
+#include <SFML/Graphics/Image.hpp>
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 4) { std::cerr << "usage: " << argv[0] << " <input.png> <output.inc> <divisor>\n"; return 1; }
+    const std::string inputPath{argv[1]}, outputPath{argv[2]};
+    const unsigned divisor = std::stoul(argv[3]);
+    
+    sf::Image source{};
+    if (!source.loadFromFile(inputPath)) { std::cerr << "Failed to load image: '" << inputPath << "'\n"; return 2; }
+    
+    const auto [srcW, srcH] = source.getSize();
+    const unsigned W{srcW/divisor}, H{srcH/divisor};
+    const std::uint8_t* srcPixels = source.getPixelsPtr();
+    
+    // box-filter with premultiplied alpha, so transparent texels don't darken the edges;
+    // fully transparent pixels are normalized to zero, which keeps the runs long
+    std::vector<std::uint32_t> pixels(W*H, 0);
+    for (unsigned Y{0}; Y < H; ++Y) {
+        for (unsigned X{0}; X < W; ++X) {
+            std::uint64_t R{0}, G{0}, B{0}, A{0};
+            for (unsigned dy{0}; dy < divisor; ++dy) {
+                for (unsigned dx{0}; dx < divisor; ++dx) {
+                    const std::uint8_t* p = &srcPixels[4*((Y*divisor + dy)*srcW + (X*divisor + dx))];
+                    R += p[0]*p[3]; G += p[1]*p[3]; B += p[2]*p[3]; A += p[3];
+                }
+            }
+            if (A == 0) continue;
+            const std::uint32_t r(R/A), g(G/A), b(B/A), a(A/(divisor*divisor));
+            pixels[Y*W + X] = (r | (g << 8) | (b << 16) | (a << 24));
+        }
+    }
+    
+    std::ofstream output{outputPath};
+    if (!output) { std::cerr << "Failed to open output: '" << outputPath << "'\n"; return 3; }
+    
+    output << "// generated by tools/EmbedAtlas.cpp from '" << inputPath << "'; do not edit\n";
+    output << "namespace EmbeddedAtlas {\n";
+    output << "constexpr unsigned width{" << W << "}, height{" << H << "};\n";
+    output << "constexpr float scale{1.f/" << divisor << ".f};\n";
+    output << "// pairs of (run-length, RGBA-pixel); pixels are little-endian 0xAABBGGRR\n";
+    output << "constexpr std::uint32_t runs[] {\n";
+    
+    std::size_t runCount{0};
+    for (std::size_t I{0}; I < pixels.size();) {
+        std::size_t length{1};
+        while ((I+length < pixels.size()) && (pixels[I+length] == pixels[I])) { ++length; }
+        output << length << "u,0x" << std::hex << pixels[I] << std::dec << "u,";
+        if (++runCount % 8 == 0) output << '\n';
+        I += length;
+    }
+    output << "\n};\n}\n";
+    
+    std::cout << "EmbedAtlas: " << srcW << 'x' << srcH << " -> " << W << 'x' << H << ", " << runCount << " runs\n";
+    return 0;
+}
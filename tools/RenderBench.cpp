@@ -0,0 +1,213 @@
+// offscreen render benchmark: builds synthetic scenes of N wired components and renders them into an
+// 'sf::RenderTexture' (no window), timing each rendering path and counting the draw-calls/vertices it submits.
+// Results are written as JSON. On headless Linux, run it under a software GL, e.g.:
+//   LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a build/tools/RenderBench --out render.json
+// usage: RenderBench [--sizes 1000,10000,100000,1000000] [--frames 30] [--canvas 2048] [--out <file|->]
+
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/OpenGL.hpp>
+
+#include "Interactives.hpp"
+#include "ComponentMap.hpp"
+#include "TextureStorage.hpp"
+#include "RenderCache.hpp"
+#include "EditTransaction.hpp"
+
+
+extern const sf::Color backgroundColor{0x808088FF}; // (defined in Main.cpp for the program itself)
+constexpr float spriteScale = 0.25f;
+
+
+struct PathResult
+{
+    std::string path;
+    std::vector<double> frameMs{};
+    DrawStats stats{};           // per frame
+    std::size_t tilesRedrawn{0}; // per frame (render-cache paths)
+};
+
+
+// nearest-rank percentile
+double Percentile(std::vector<double> samples, double P)
+{
+    std::sort(samples.begin(), samples.end());
+    return samples[std::min(std::size_t(P*double(samples.size()-1) + 0.5), samples.size()-1)];
+}
+
+
+// JSON string literal (with its quotes); escapes quotes, backslashes and control characters
+std::string JsonString(const std::string& text)
+{
+    std::string quoted{"\""};
+    for (const char C: text) {
+        switch (C) {
+            case '"':  quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\r': quoted += "\\r"; break;
+            case '\t': quoted += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(C) < 0x20) quoted += std::format("\\u{:04x}", static_cast<unsigned char>(C));
+                else quoted += C;
+        }
+    }
+    return quoted + '"';
+}
+
+
+// 'frame' renders one frame; timing includes waiting for the GPU to finish it
+template <typename Lambda>
+std::vector<double> TimeFrames(sf::RenderTexture& target, int frames, Lambda&& frame)
+{
+    std::vector<double> times{};
+    for (int F{0}; F < frames; ++F) {
+        const auto start {std::chrono::steady_clock::now()};
+        frame(F);
+        target.display();
+        target.setActive(true); glFinish();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return times;
+}
+
+
+int main(int argc, char** argv)
+{
+    std::vector<std::size_t> sizes {1'000, 10'000, 100'000, 1'000'000};
+    int frames{30};
+    unsigned canvas{2048};
+    std::string outputPath{"-"};
+    for (int C{1}; C+1 < argc; C += 2) {
+        const std::string arg {argv[C]}, value {argv[C+1]};
+        if (arg == "--sizes") {
+            sizes.clear();
+            for (std::size_t start{0}, end; start < value.size(); start = end+1) {
+                end = std::min(value.find(',', start), value.size());
+                sizes.push_back(std::stoul(value.substr(start, end-start)));
+            }
+        }
+        else if (arg == "--frames") { frames = std::max(std::stoi(value), 1); }
+        else if (arg == "--canvas") { canvas = std::stoul(value); }
+        else if (arg == "--out")    { outputPath = value; }
+        else { std::cerr << "unknown argument: " << arg << '\n'; return 1; }
+    }
+
+    sf::RenderTexture target{};
+    if (!target.create(canvas, canvas)) { std::cerr << "Failed to create render-texture (is there a GL context?)\n"; return 2; }
+    target.setActive(true);
+    const std::string renderer {reinterpret_cast<const char*>(glGetString(GL_RENDERER))};
+    const std::string version  {reinterpret_cast<const char*>(glGetString(GL_VERSION))};
+    if (int status = TextureStorage::Init(spriteScale); status != 0) return status;
+
+    std::string json {std::format("{{\n  \"renderer\": {},\n  \"glVersion\": {},\n  \"canvas\": {},\n  \"frames\": {},\n  \"scenes\": [",
+        JsonString(renderer), JsonString(version), canvas, frames)};
+
+    for (std::size_t sceneIndex{0}; sceneIndex < sizes.size(); ++sceneIndex)
+    {
+        const std::size_t count {sizes[sceneIndex]};
+        std::cerr << std::format("scene: {} components...\n", count);
+
+        // grid-placed (overlapping once the canvas is full); each input wired to one of the previous 64 components
+        std::vector<Component> globalInputs{}, globalOutput{};
+        globalInputs.reserve(8); globalOutput.reserve(8);
+        MakeGlobalIO(globalInputs, true, std::vector<bool>{true, false, true, true, false, true, false, false});
+        MakeGlobalIO(globalOutput, false, {});
+        ComponentMap components{};
+        std::size_t wireCount{0};
+        {
+            std::mt19937 random{1234};
+            std::vector<Component*> placed{};
+            for (Component& component: globalInputs) { placed.push_back(&component); }
+            EditTransaction edit{globalInputs, components, globalOutput};
+
+            const std::size_t columns {std::max<std::size_t>(std::size_t(std::ceil(std::sqrt(double(count)))), 1)};
+            const float spacing {float(canvas) / float(columns)};
+            for (std::size_t I{0}; I < count; ++I) {
+                const auto T {LogicGate::OpType(1 + random()%(LogicGate::FIRST_CELL-1))}; // primitive gates, so runs stay comparable
+                Component& component {edit.Insert(T, TextureStorage::GetSprite(T))};
+                component.SetPosition(float(I%columns)*spacing, float(I/columns)*spacing);
+                for (Pin& pin: component.inputs) {
+                    const std::size_t window {std::min<std::size_t>(placed.size(), 64)};
+                    edit.Connect(*placed[placed.size()-1 - random()%window], component, &pin);
+                    ++wireCount;
+                }
+                placed.push_back(&component);
+            }
+            edit.Commit();
+        }
+
+        std::vector<PathResult> results{};
+        auto drawAll = [&](sf::RenderTarget& into) {
+            for (const Component& component: globalInputs) { into.draw(component); }
+            for (const Component& component: globalOutput) { into.draw(component); }
+            components.ForEach([&into](const Component& component){ into.draw(component); });
+        };
+
+        // the uncached path: every component, every frame
+        {
+            PathResult& result {results.emplace_back(PathResult{"direct"})};
+            for (const Component& component: globalInputs) { component.CountDrawCalls(result.stats); }
+            for (const Component& component: globalOutput) { component.CountDrawCalls(result.stats); }
+            components.ForEach([&result](const Component& component){ component.CountDrawCalls(result.stats); });
+            result.frameMs = TimeFrames(target, frames, [&](int) { target.clear(backgroundColor); drawAll(target); });
+        }
+
+        // tiled render-cache: rebuilt from scratch / unchanged / one component changing state per frame
+        RenderCache cache{};
+        if (!cache.Create({canvas, canvas})) { std::cerr << "Failed to create render-cache; skipping its paths\n"; }
+        else {
+            Component* toggled{nullptr};
+            components.ForEach([&toggled](Component& component){ toggled = &component; ComponentMap::Break(); });
+
+            struct { const char* name; int mode; } variants[] {{"render-cache-cold", 0}, {"render-cache-warm", 1}, {"render-cache-edit", 2}};
+            cache.Update(globalInputs, globalOutput, components);
+            for (auto [name, mode]: variants) {
+                PathResult& result {results.emplace_back(PathResult{name})};
+                result.stats.drawCalls = cache.TileCount(); result.stats.vertices = cache.TileCount()*4; // the composite
+                std::size_t redrawn{0};
+                result.frameMs = TimeFrames(target, frames, [&](int F) {
+                    if (mode == 0) cache.Invalidate();
+                    if (mode == 2 && toggled) toggled->ShowState(F%2);
+                    cache.Update(globalInputs, globalOutput, components);
+                    redrawn += cache.TilesRedrawn();
+                    target.clear(backgroundColor);
+                    cache.Draw(target);
+                });
+                result.tilesRedrawn = redrawn / std::size_t(frames);
+            }
+        }
+
+        json += std::format("{}\n    {{\n      \"components\": {},\n      \"wires\": {},\n      \"paths\": [",
+            (sceneIndex? "," : ""), count, wireCount);
+        for (std::size_t R{0}; R < results.size(); ++R) {
+            const PathResult& result {results[R]};
+            double mean{0.0};
+            for (double ms: result.frameMs) { mean += ms; }
+            mean /= double(result.frameMs.size());
+            json += std::format(
+                "{}\n        {{\"path\": {}, \"frameMsMean\": {:.4f}, \"frameMsP50\": {:.4f}, \"frameMsMax\": {:.4f}, "
+                "\"usPerComponent\": {:.5f}, \"drawCalls\": {}, \"vertices\": {}, \"tilesRedrawn\": {}}}",
+                (R? "," : ""), JsonString(result.path), mean, Percentile(result.frameMs, 0.5), Percentile(result.frameMs, 1.0),
+                mean*1000.0/double(count), result.stats.drawCalls, result.stats.vertices, result.tilesRedrawn);
+        }
+        json += "\n      ]\n    }";
+    }
+    json += "\n  ]\n}\n";
+
+    if (outputPath == "-") { std::cout << json; }
+    else {
+        std::ofstream file{outputPath};
+        if (!(file << json)) { std::cerr << "Failed to write: '" << outputPath << "'\n"; return 3; }
+    }
+    return 0;
+}